@@ -0,0 +1,490 @@
+/**
+ * @file oasis_bench.c
+ * @brief Throughput benchmark of the scan engine.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Runs scaled-down, deterministic versions of the workloads of the commands
+ * through the engine (see oasis_engine.h), without terminal I/O, at several
+ * thread counts and reports candidates/s, hits/s, ns per screened candidate
+ * and the time split between sieve, PRP and output.
+ *
+ * @note v1.22.0 (2026-10-16): Add --perf-counters
+ *       1. perf_event counts of the sieve, PRP and output phases per
+ *          million candidates, printed and written to the JSON file
+ *
+ * @note v1.19.0 (2026-10-16): Add oasis_bench command
+ *       1. Workloads layer1, layer2, layer3 and oases683 (prime_oases d683 x484391)
+ *       2. -o <file>: write the results as JSON
+ *       3. --compare <file>: flag regressions against a saved JSON file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#define XPT_ON
+#include "xpt.h"
+int xpt_flg = 0;
+
+#include "oasis_engine.h"
+#include "oasis_lcm.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_FILE	(-2)	// File cannot be read or written
+#define ERR_INVL	(-5)	// Invalid value
+#define ERR_SLOW	(-6)	// Regression against the baseline
+#define ERR_MEM		(-7)	// Out of memory
+
+#define BENCH_DESERTS	(20000)		// default deserts of a workload
+#define BENCH_TOL	(5.0)		// default tolerance of --compare [%]
+#define BENCH_JMAX	(16)		// thread counts of -j
+#define BENCH_RMAX	(256)		// results of a run or a baseline file
+
+/* A canonical workload */
+typedef struct {
+	const char *name;
+	int         n_start;	// start = d<n_start> * no
+	int         no;
+	int         n_step;	// step = d<n_step>
+	int         range;	// 1: start..start*2 (oasis_layer), 0: no..no+num-1 (prime_oases)
+	uint64_t    num;	// deserts of the full prime_oases workload
+	const char *cmd;	// the command it is scaled from
+} BENCH_LOAD;
+
+static const BENCH_LOAD loads[] = {
+	{"layer1",   701,      1, 691, 1,      0, "oasis_layer1"},
+	{"layer2",   701,      1, 683, 1,      0, "oasis_layer2"},
+	{"layer3",   701,      1, 677, 1,      0, "oasis_layer3"},
+	{"oases683", 683, 484391, 683, 0, 484391, "prime_oases d683 x484391 484391"},
+	{NULL,         0,      0,   0, 0,      0, NULL}
+};
+
+/* A result, one line of the JSON file */
+typedef struct {
+	char     name[32];
+	int      threads;
+	uint64_t deserts;
+	uint64_t tries;
+	uint64_t hits;
+	double   sec;
+	double   cand_per_s;
+	double   hits_per_s;
+	double   ns_per_test;	// ns of screen and test per screened candidate
+	double   sieve;		// share of the thread time
+	double   prp;
+	double   out;
+	OASIS_PERF_CNT pf[1];	// perf_event counts (--perf-counters)
+} BENCH_RES;
+
+static int bench_perf = 0;	// --perf-counters
+
+/**
+ * @brief Elapsed time in seconds
+ */
+static double now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Format a hit as prime_oasis prints it (hit callback of the engine)
+ *
+ * @details The line is made but not written, the output share of the
+ *          time is the decimal conversion without the terminal.
+ */
+static int bench_hit(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags)
+{
+	char *buf = (char *)arg;
+
+	(void)n;
+	(void)k;
+	(void)sign;
+	gmp_snprintf(buf, 1024, "oasis prime%c = %Zd\n", (flags & OASIS_HIT_TWIN)? 's': ' ', x);
+	return 0;
+}
+
+/**
+ * @brief Run one workload
+ *
+ * @param[out] res     Result
+ * @param[in]  ld      Workload
+ * @param[in]  deserts Deserts to scan at most (0: all of them)
+ * @param[in]  threads Threads of the engine
+ *
+ * @return ERR_OK, or ERR_MEM
+ */
+static int bench_run(BENCH_RES *res, const BENCH_LOAD *ld, uint64_t deserts, int threads)
+{
+	OASIS_ENGINE eng[1];
+	mpz_t        start, end, step;
+	char         buf[1024];
+	double       t0, ns;
+	int          ret = ERR_OK;
+
+	mpz_init(start);
+	mpz_init(end);
+	mpz_init(step);
+	oasis_lcm_get(start, ld->n_start);
+	mpz_mul_ui(start, start, ld->no);
+	oasis_lcm_get(step, ld->n_step);
+
+	oasis_engine_init(eng);
+	if (ld->range) {
+		mpz_mul_ui(end, start, 2);
+		oasis_engine_range(eng, start, end, step);
+	}
+	else {
+		mpz_set(eng->start, start);
+		mpz_set(eng->step, step);
+		eng->num = ld->num;
+	}
+	if (deserts && eng->num > deserts) {
+		eng->num    = deserts;			// the scaled end is inside the range
+		eng->flags &= ~OASIS_ENG_SKIP_LAST;
+	}
+	eng->n       = ld->n_step;
+	eng->threads = threads;
+	eng->hit     = bench_hit;
+	eng->arg     = buf;
+	eng->perf    = bench_perf;
+
+	t0 = now_sec();
+	if (oasis_engine_run(eng) != 0) ret = ERR_MEM;
+	res->sec = now_sec() - t0;
+
+	snprintf(res->name, sizeof(res->name), "%s", ld->name);
+	res->threads     = threads;
+	res->deserts     = eng->k_end;
+	res->tries       = eng->st->try_cnt;
+	res->hits        = eng->st->hit_cnt;
+	res->cand_per_s  = (res->sec > 0)? res->tries / res->sec: 0.0;
+	res->hits_per_s  = (res->sec > 0)? res->hits / res->sec: 0.0;
+	res->ns_per_test = (eng->scr_cnt)? (double)eng->ns_prp / eng->scr_cnt: 0.0;
+	ns = (double)eng->ns_sieve + eng->ns_prp + eng->ns_out;
+	res->sieve = (ns > 0)? eng->ns_sieve / ns: 0.0;
+	res->prp   = (ns > 0)? eng->ns_prp / ns: 0.0;
+	res->out   = (ns > 0)? eng->ns_out / ns: 0.0;
+	*res->pf   = *eng->pf;
+
+	oasis_engine_clear(eng);
+	mpz_clear(start);
+	mpz_clear(end);
+	mpz_clear(step);
+
+	return ret;
+}
+
+/**
+ * @brief Write the perf_event counts per million candidates as a JSON member
+ *
+ * @note Added in v1.22.0 (2026-10-16)
+ */
+static void bench_write_perf(FILE *fp, const BENCH_RES *res)
+{
+	static const char *phase[OASIS_PERF_PHASES] = { "sieve", "prp", "out" };
+	const OASIS_PERF_CNT *pc = res->pf;
+	double per = (res->tries)? 1e6 / res->tries: 0.0;
+	int    p, i, n;
+
+	if (pc->avail == 0) {
+		fprintf(fp, ", \"perf\": null");
+		return;
+	}
+	fprintf(fp, ", \"perf\": {");
+	for (p = 0; p < OASIS_PERF_PHASES; p++) {
+		fprintf(fp, "%s\"%s\": {", (p)? ", ": "", phase[p]);
+		for (i = n = 0; i < OASIS_PERF_NUM; i++) {
+			if (!(pc->avail & (1u << i))) continue;
+			fprintf(fp, "%s\"%s\": %.0f", (n++)? ", ": "", oasis_perf_name(i), pc->v[p][i] * per);
+		}
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "}");
+}
+
+/**
+ * @brief Write the results as JSON, one result per line
+ *
+ * @return ERR_OK, or ERR_FILE
+ */
+static int bench_write(const char *path, const BENCH_RES *res, int nres, uint64_t deserts)
+{
+	FILE *fp;
+	int   i;
+
+	fp = fopen(path, "w");
+	if (fp == NULL) return ERR_FILE;
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"bench\": \"oasis_bench\",\n");
+	fprintf(fp, "  \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(fp, "  \"deserts\": %lu,\n", deserts);
+	fprintf(fp, "  \"results\": [\n");
+	for (i = 0; i < nres; i++) {
+		fprintf(fp, "    {\"workload\": \"%s\", \"threads\": %d, \"deserts\": %lu, \"tries\": %lu, "
+			"\"hits\": %lu, \"sec\": %.6f, \"cand_per_s\": %.1f, \"hits_per_s\": %.1f, "
+			"\"ns_per_test\": %.1f, \"sieve\": %.4f, \"prp\": %.4f, \"out\": %.4f",
+			res[i].name, res[i].threads, res[i].deserts, res[i].tries,
+			res[i].hits, res[i].sec, res[i].cand_per_s, res[i].hits_per_s,
+			res[i].ns_per_test, res[i].sieve, res[i].prp, res[i].out);
+		if (bench_perf) bench_write_perf(fp, &res[i]);
+		fprintf(fp, "}%s\n", (i + 1 < nres)? ",": "");
+	}
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+
+	return (fclose(fp) == 0)? ERR_OK: ERR_FILE;
+}
+
+/**
+ * @brief Read the results of a JSON file written by bench_write()
+ *
+ * @return Number of results, or -1 if the file cannot be read
+ */
+static int bench_read(const char *path, BENCH_RES *res, int max)
+{
+	FILE *fp;
+	char  line[1024];
+	int   n = 0;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) return -1;
+
+	while (n < max && fgets(line, sizeof(line), fp)) {
+		memset(&res[n], 0, sizeof(BENCH_RES));
+		if (sscanf(line, " {\"workload\": \"%31[^\"]\", \"threads\": %d, \"deserts\": %lu, \"tries\": %lu, "
+			"\"hits\": %lu, \"sec\": %lf, \"cand_per_s\": %lf, \"hits_per_s\": %lf, "
+			"\"ns_per_test\": %lf",
+			res[n].name, &res[n].threads, &res[n].deserts, &res[n].tries,
+			&res[n].hits, &res[n].sec, &res[n].cand_per_s, &res[n].hits_per_s,
+			&res[n].ns_per_test) == 9) {
+			n++;
+		}
+	}
+	fclose(fp);
+
+	return n;
+}
+
+/**
+ * @brief Compare the results with a baseline
+ *
+ * @param[in] res  Results of this run
+ * @param[in] base Baseline
+ * @param[in] tol  Tolerance [%] of candidates/s
+ *
+ * @return ERR_OK, or ERR_SLOW if a workload is slower or finds other hits
+ */
+static int bench_compare(const BENCH_RES *res, int nres, const BENCH_RES *base, int nbase, double tol)
+{
+	const BENCH_RES *b;
+	double           d;
+	int              i, j, ret = ERR_OK;
+
+	printf("\n%-9s %3s %14s %14s %8s\n", "workload", "-j", "base cand/s", "cand/s", "delta");
+	for (i = 0; i < nres; i++) {
+		b = NULL;
+		for (j = 0; j < nbase; j++) {
+			if (strcmp(base[j].name, res[i].name) == 0 && base[j].threads == res[i].threads) {
+				b = &base[j];
+				break;
+			}
+		}
+		if (b == NULL) {
+			printf("%-9s %3d %14s %14.1f %8s\n", res[i].name, res[i].threads, "-", res[i].cand_per_s, "new");
+			continue;
+		}
+		d = (b->cand_per_s > 0)? (res[i].cand_per_s / b->cand_per_s - 1.0) * 100.0: 0.0;
+		printf("%-9s %3d %14.1f %14.1f %+7.1f%%", res[i].name, res[i].threads, b->cand_per_s, res[i].cand_per_s, d);
+		if (b->deserts == res[i].deserts && (b->tries != res[i].tries || b->hits != res[i].hits)) {
+			printf("  MISMATCH (hit=%lu, base %lu)", res[i].hits, b->hits);
+			ret = ERR_SLOW;
+		}
+		else if (d < -tol) {
+			printf("  REGRESSION");
+			ret = ERR_SLOW;
+		}
+		printf("\n");
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Parse the thread counts of -j, e.g. "1,2,4"
+ *
+ * @return Number of thread counts, or 0 if invalid
+ */
+static int parse_threads(const char *s, int *jobs)
+{
+	char *e;
+	long  v;
+	int   n = 0;
+
+	while (*s && n < BENCH_JMAX) {
+		if (!isdigit((unsigned char)*s)) return 0;
+		v = strtol(s, &e, 10);
+		if (v < 1 || v > OASIS_ENG_THREADS_MAX) return 0;
+		jobs[n++] = (int)v;
+		s = e;
+		if (*s == ',') s++;
+		else if (*s)   return 0;
+	}
+
+	return n;
+}
+
+/**
+ * @brief Display usage information for the oasis_bench command
+ */
+static void disp_usage()
+{
+	int i;
+
+	printf("---< USAGE:\n");
+	printf("       oasis_bench [-j <threads>,...] [-n <deserts>] [-o <file>] [--compare <file>] [--tolerance <pct>]\n");
+	printf("                   [--perf-counters] [<workload>...]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <workload>  Workload to run (defaults to all of them):\n");
+	for (i = 0; loads[i].name; i++) {
+		printf("                     %-9s %s\n", loads[i].name, loads[i].cmd);
+	}
+	printf("---< OPTIONS:\n");
+	printf("       -j <threads>,...   Thread counts to run (defaults to 1,2,4)\n");
+	printf("       -n <deserts>       Deserts of a workload, 0 for all (defaults to %d)\n", BENCH_DESERTS);
+	printf("       -o <file>          Write the results as JSON\n");
+	printf("       --compare <file>   Compare with the JSON of an earlier run, fail on a regression\n");
+	printf("       --tolerance <pct>  Slowdown of candidates/s that is a regression (defaults to %.0f)\n", BENCH_TOL);
+	printf("       --perf-counters    Count cycles, instructions, cache and branch misses of the phases\n");
+	printf("                          (perf_event), per million candidates\n");
+	printf("---< CAUTION:\n");
+	printf("       1) The hits are formatted but not written, terminal I/O is not measured.\n");
+	printf("       2) Compare only results of the same machine and the same -n.\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char *argv[])
+{
+	static BENCH_RES res[BENCH_RMAX];
+	static BENCH_RES base[BENCH_RMAX];
+	const BENCH_LOAD *sel[sizeof(loads) / sizeof(loads[0])];
+	const char *out_file = NULL;
+	const char *cmp_file = NULL;
+	uint64_t    deserts  = BENCH_DESERTS;
+	double      tol      = BENCH_TOL;
+	int         jobs[BENCH_JMAX] = {1, 2, 4};
+	int         njob = 3;
+	int         nsel = 0;
+	int         nres = 0;
+	int         nbase = 0;
+	int         ret = ERR_OK;
+	int         i, j, w;
+
+	XPT_INIT();
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			njob = parse_threads(argv[++i], jobs);
+			if (njob == 0) {
+				printf("ERR: -j <threads> must be 1..%d, separated by ','\n", OASIS_ENG_THREADS_MAX);
+				ret = ERR_INVL;
+			}
+		}
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			if (!isdigit((unsigned char)argv[++i][0])) {
+				printf("ERR: -n <deserts> must be a number\n");
+				ret = ERR_INVL;
+			}
+			deserts = strtoull(argv[i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			out_file = argv[++i];
+		}
+		else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+			cmp_file = argv[++i];
+		}
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+			tol = atof(argv[++i]);
+			if (tol < 0) {
+				printf("ERR: --tolerance <pct> must be >= 0\n");
+				ret = ERR_INVL;
+			}
+		}
+		else if (strcmp(argv[i], "--perf-counters") == 0) {
+			bench_perf = 1;
+		}
+		else if (argv[i][0] != '-') {
+			for (w = 0; loads[w].name && strcmp(loads[w].name, argv[i]) != 0; w++);
+			if (loads[w].name == NULL) {
+				printf("ERR: Unknown workload '%s'\n", argv[i]);
+				ret = ERR_INVL;
+			}
+			else {
+				sel[nsel++] = &loads[w];
+			}
+		}
+		else {
+			ret = ERR_PNUM;
+		}
+	}
+	if (ret == ERR_OK && cmp_file) {
+		nbase = bench_read(cmp_file, base, BENCH_RMAX);
+		if (nbase < 0) {
+			printf("ERR: Cannot read '%s'\n", cmp_file);
+			ret = ERR_FILE;
+		}
+	}
+	if (ret == ERR_PNUM || ret == ERR_INVL) {
+		disp_usage();
+	}
+	if (ret != ERR_OK) {
+		return ret;
+	}
+	if (nsel == 0) {
+		for (w = 0; loads[w].name; w++) sel[nsel++] = &loads[w];
+	}
+
+	printf("%-9s %3s %9s %9s %7s %9s %12s %10s %9s %6s %6s %6s\n", "workload", "-j", "deserts", "tries",
+	       "hits", "sec", "cand/s", "hits/s", "ns/test", "sieve", "prp", "out");
+	for (w = 0; w < nsel && ret == ERR_OK; w++) {
+		for (j = 0; j < njob && nres < BENCH_RMAX; j++) {
+			ret = bench_run(&res[nres], sel[w], deserts, jobs[j]);
+			if (ret != ERR_OK) {
+				printf("ERR: Out of memory\n");
+				break;
+			}
+			printf("%-9s %3d %9lu %9lu %7lu %9.3f %12.1f %10.1f %9.0f %5.1f%% %5.1f%% %5.1f%%\n",
+			       res[nres].name, res[nres].threads, res[nres].deserts, res[nres].tries,
+			       res[nres].hits, res[nres].sec, res[nres].cand_per_s, res[nres].hits_per_s,
+			       res[nres].ns_per_test, res[nres].sieve * 100.0, res[nres].prp * 100.0,
+			       res[nres].out * 100.0);
+			if (bench_perf) {
+				oasis_perf_print(stdout, res[nres].pf, res[nres].tries);
+			}
+			fflush(stdout);
+			nres++;
+		}
+	}
+
+	if (ret == ERR_OK && out_file && bench_write(out_file, res, nres, deserts) != ERR_OK) {
+		printf("ERR: Cannot write '%s'\n", out_file);
+		ret = ERR_FILE;
+	}
+	if (ret == ERR_OK && cmp_file) {
+		ret = bench_compare(res, nres, base, nbase, tol);
+	}
+
+	return ret;
+}
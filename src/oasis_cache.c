@@ -0,0 +1,334 @@
+/**
+ * @file oasis_cache.c
+ * @brief Result cache of prime_oases: the deserts tested and their hits, per d<n>.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_cache.h.
+ *
+ * @note v1.32.0 (2026-10-16): Add result cache (oasis_cache)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gmp.h>
+
+#include "oasis_cache.h"
+#include "oasis_lcm.h"
+
+#define CACHE_NONE	(UINT64_MAX)		// OASIS_CACHE_MAP.last: no lookup yet
+
+/**
+ * @brief Compare the pages of the index by number (qsort)
+ */
+static int ix_cmp(const void *a, const void *b)
+{
+	uint64_t x = ((const OASIS_CACHE_IX *)a)->no;
+	uint64_t y = ((const OASIS_CACHE_IX *)b)->no;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Page i of a mapped file
+ */
+static OASIS_CACHE_PG *map_pg(const OASIS_CACHE_MAP *m, uint32_t i)
+{
+	return (OASIS_CACHE_PG *)(m->map + sizeof(OASIS_CACHE_HDR) + (size_t)i * sizeof(OASIS_CACHE_PG));
+}
+
+/**
+ * @brief Close a mapped file
+ */
+static void map_close(OASIS_CACHE_MAP *m)
+{
+	if (m->map) munmap(m->map, m->size);
+	if (m->fd >= 0) close(m->fd);			// the flock goes with it
+	free(m->ix);
+	memset(m, 0, sizeof(*m));
+	m->fd = -1;
+}
+
+/**
+ * @brief Map a cache file and index its pages
+ *
+ * @param[out] m      Mapped file
+ * @param[in]  path   d<n>.cache
+ * @param[in]  desert n of d<n>
+ * @param[in]  rw     1: create it, and write it if no other process does
+ *
+ * @return 0 on success, -1 if there is no valid file
+ */
+static int map_open(OASIS_CACHE_MAP *m, const char *path, int desert, int rw)
+{
+	OASIS_CACHE_HDR hdr[1];
+	struct stat     st;
+	uint32_t        i, n;
+
+	memset(m, 0, sizeof(*m));
+	m->desert = desert;
+	m->ratio  = 1;
+	m->last   = CACHE_NONE;
+	m->fd     = open(path, (rw)? O_RDWR | O_CREAT: O_RDONLY, 0666);
+	if (m->fd < 0) return -1;
+	m->rw = rw && (flock(m->fd, LOCK_EX | LOCK_NB) == 0);	// else another scan writes it
+
+	if (fstat(m->fd, &st) != 0) goto err;
+	if (m->rw && st.st_size == 0) {			// new file
+		memset(hdr, 0, sizeof(hdr));
+		memcpy(hdr->magic, OASIS_CACHE_MAGIC, sizeof(hdr->magic));
+		hdr->version = OASIS_CACHE_VERSION;
+		hdr->desert  = (uint32_t)desert;
+		hdr->page    = OASIS_CACHE_PAGE;
+		if (pwrite(m->fd, hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) goto err;
+		st.st_size = sizeof(hdr);
+	}
+	if ((size_t)st.st_size < sizeof(hdr)
+	||  pread(m->fd, hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)
+	||  memcmp(hdr->magic, OASIS_CACHE_MAGIC, sizeof(hdr->magic)) != 0
+	||  hdr->version != OASIS_CACHE_VERSION || hdr->desert != (uint32_t)desert
+	||  hdr->page != OASIS_CACHE_PAGE) {
+		goto err;
+	}
+	n = (uint32_t)((st.st_size - sizeof(hdr)) / sizeof(OASIS_CACHE_PG));
+	m->npg  = (hdr->pages < n)? hdr->pages: n;	// a page cut off by a crash is dropped
+	m->size = sizeof(hdr) + (size_t)m->npg * sizeof(OASIS_CACHE_PG);
+	m->map  = mmap(NULL, m->size, PROT_READ | ((m->rw)? PROT_WRITE: 0), MAP_SHARED, m->fd, 0);
+	if (m->map == MAP_FAILED) {
+		m->map = NULL;
+		goto err;
+	}
+	m->ix = malloc(((m->npg)? m->npg: 1) * sizeof(OASIS_CACHE_IX));
+	if (m->ix == NULL) goto err;
+	for (i = 0; i < m->npg; i++) {
+		m->ix[i].no = map_pg(m, i)->no;
+		m->ix[i].i  = i;
+	}
+	qsort(m->ix, m->npg, sizeof(OASIS_CACHE_IX), ix_cmp);
+
+	return 0;
+
+err:
+	map_close(m);
+	return -1;
+}
+
+/**
+ * @brief States of the page of desert k
+ *
+ * @return The states of the page, NULL if the page is not in the file
+ */
+static uint8_t *map_find(OASIS_CACHE_MAP *m, uint64_t k)
+{
+	uint64_t no = k / OASIS_CACHE_PAGE;
+	uint32_t lo = 0, hi = m->npg, mid;
+
+	if (no == m->last) return m->last_st;
+	m->last    = no;
+	m->last_st = NULL;
+	while (lo < hi) {				// binary search of the index
+		mid = (lo + hi) / 2;
+		if      (m->ix[mid].no < no) lo = mid + 1;
+		else if (m->ix[mid].no > no) hi = mid;
+		else {
+			m->last_st = map_pg(m, m->ix[mid].i)->st;
+			break;
+		}
+	}
+
+	return m->last_st;
+}
+
+/**
+ * @brief Add the page of desert k to the file (rw)
+ *
+ * @return The states of the page (all 0), NULL on failure
+ */
+static uint8_t *map_add(OASIS_CACHE_MAP *m, uint64_t k)
+{
+	OASIS_CACHE_IX *ix;
+	size_t          size = m->size + sizeof(OASIS_CACHE_PG);
+	uint8_t        *map;
+	uint32_t        i;
+
+	ix = realloc(m->ix, (m->npg + 1) * sizeof(OASIS_CACHE_IX));
+	if (ix == NULL) return NULL;
+	m->ix = ix;
+	if (ftruncate(m->fd, size) != 0) return NULL;	// the new page is zero
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+	if (map == MAP_FAILED) return NULL;
+	munmap(m->map, m->size);
+	m->map  = map;
+	m->size = size;
+
+	map_pg(m, m->npg)->no = k / OASIS_CACHE_PAGE;
+	for (i = m->npg; i > 0 && ix[i - 1].no > k / OASIS_CACHE_PAGE; i--) {
+		ix[i] = ix[i - 1];			// keep the index sorted
+	}
+	ix[i].no = k / OASIS_CACHE_PAGE;
+	ix[i].i  = m->npg;
+	m->npg++;
+	((OASIS_CACHE_HDR *)m->map)->pages = m->npg;	// after the page: a crash drops it
+	m->last = CACHE_NONE;
+
+	return map_find(m, k);
+}
+
+/**
+ * @brief Open the cache of d<n> in a directory
+ *
+ * @param[out] c      Cache
+ * @param[in]  dir    Cache directory (created if needed)
+ * @param[in]  desert n of d<n>
+ *
+ * @return 0 on success, -1 if <dir>/d<n>.cache cannot be opened
+ *
+ * @details The caches of the smaller d<m> with d<n> / d<m> < 2^64 are
+ *          opened read-only (at most OASIS_CACHE_SRC_MAX).  own->rw is 0
+ *          if another process writes d<n>.cache: the cache is read only.
+ *
+ * @note Modified in v1.32.1 (2026-10-16): d2.cache is not a source.  A d2
+ *       scan (step 2) finds pit(k) - 1 as pit(k - 1) + 1, so its pit - 1
+ *       bits are not set after k = 0.
+ */
+int oasis_cache_open(OASIS_CACHE *c, const char *dir, int desert)
+{
+	char  path[4096];
+	mpz_t dn, dm, r;
+	int   m;
+
+	memset(c, 0, sizeof(*c));
+	mkdir(dir, 0777);				// EEXIST is fine
+	snprintf(path, sizeof(path), "%s/d%d.cache", dir, desert);
+	if (map_open(c->own, path, desert, 1) != 0) return -1;
+
+	mpz_init(dn);
+	mpz_init(dm);
+	mpz_init(r);
+	oasis_lcm_get(dn, desert);			// dn = lcm(1,2,3,...,n)
+	for (m = desert - 1; m >= 3 && c->nsrc < OASIS_CACHE_SRC_MAX; m--) {
+		oasis_lcm_get(dm, m);
+		mpz_divexact(r, dn, dm);		// d<n> = d<m> * r
+		if (!mpz_fits_ulong_p(r)) break;	// r grows as m goes down
+		snprintf(path, sizeof(path), "%s/d%d.cache", dir, m);
+		if (map_open(&c->src[c->nsrc], path, m, 0) == 0) {
+			c->src[c->nsrc++].ratio = mpz_get_ui(r);
+		}
+	}
+	mpz_clear(dn);
+	mpz_clear(dm);
+	mpz_clear(r);
+
+	return 0;
+}
+
+/**
+ * @brief Close the cache (the states are in the files already)
+ *
+ * @note Nothing is done for a cache that is not open (zeroed).
+ */
+void oasis_cache_close(OASIS_CACHE *c)
+{
+	int i;
+
+	if (c->own->map == NULL) return;		// not open
+	map_close(c->own);
+	for (i = 0; i < c->nsrc; i++) {
+		map_close(&c->src[i]);
+	}
+	c->nsrc = 0;
+}
+
+/**
+ * @brief Is a state a covered desert?
+ */
+static int covered_p(int st, int prove)
+{
+	return (st & OASIS_CACHE_TESTED) && (!prove || (st & OASIS_CACHE_PROVED));
+}
+
+/**
+ * @brief State of desert k of d<n>
+ *
+ * @param[in,out] c     Cache
+ * @param[in]     k     Desert (pit = d<n> * k)
+ * @param[in]     prove A --prove scan (PROVED needed, served from r = 1 only)
+ *
+ * @return OASIS_CACHE_* of the desert if it is covered, 0 otherwise
+ */
+int oasis_cache_get(OASIS_CACHE *c, uint64_t k, int prove)
+{
+	OASIS_CACHE_MAP *m;
+	uint8_t         *st;
+	int              i;
+
+	st = map_find(c->own, k);
+	if (st && covered_p(st[k % OASIS_CACHE_PAGE], prove)) return st[k % OASIS_CACHE_PAGE];
+	for (i = 0; i < c->nsrc; i++) {
+		m = &c->src[i];
+		if ((prove && m->ratio != 1) || k > UINT64_MAX / m->ratio) continue;
+		st = map_find(m, k * m->ratio);		// d<n>*k = d<m>*(r*k)
+		if (st && covered_p(st[(k * m->ratio) % OASIS_CACHE_PAGE], prove)) {
+			return st[(k * m->ratio) % OASIS_CACHE_PAGE];
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Set bits of the state of desert k of d<n>
+ *
+ * @return 0 on success, -1 if the cache is read only or on failure
+ */
+int oasis_cache_set(OASIS_CACHE *c, uint64_t k, int bits)
+{
+	uint8_t *st;
+
+	if (!c->own->rw) return -1;
+	st = map_find(c->own, k);
+	if (st == NULL) st = map_add(c->own, k);
+	if (st == NULL) return -1;
+	st[k % OASIS_CACHE_PAGE] |= (uint8_t)bits;
+
+	return 0;
+}
+
+/**
+ * @brief End of a run of covered (or not covered) deserts
+ *
+ * @param[in,out] c       Cache
+ * @param[in]     k       First desert of the run
+ * @param[in]     k_end   End of the deserts to look at
+ * @param[in]     prove   A --prove scan
+ * @param[in]     covered 1: a run of covered deserts, 0: a gap
+ *
+ * @return The first desert in k..k_end-1 that does not belong to the run,
+ *         k_end if there is none
+ *
+ * @details A gap skips the pages that are in none of the files.
+ */
+uint64_t oasis_cache_span(OASIS_CACHE *c, uint64_t k, uint64_t k_end, int prove, int covered)
+{
+	uint64_t next;
+
+	while (k < k_end) {
+		if (!covered && c->nsrc == 0 && map_find(c->own, k) == NULL) {
+			next = (k / OASIS_CACHE_PAGE + 1) * OASIS_CACHE_PAGE;
+			if (next < k) break;			// the last page of 2^64
+			k = next;
+			continue;
+		}
+		if ((oasis_cache_get(c, k, prove) != 0) != covered) return k;
+		k++;
+	}
+
+	return k_end;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file oasis_cache.h
+ * @brief Result cache of prime_oases: the deserts tested and their hits, per d<n>.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * A scan of the same deserts gives the same hits, so the hits of every
+ * scanned desert are kept in a file of the cache directory, d<n>.cache:
+ * one state byte per desert k (k = x<no> + desert index, pit = d<n>*k),
+ * in pages of OASIS_CACHE_PAGE deserts that are added as they are
+ * needed.  The file is mapped (MAP_SHARED): the bytes are set in place.
+ *
+ *   header  OASIS_CACHE_HDR: magic, version, n of d<n>, page size, pages
+ *   pages   OASIS_CACHE_PG: page number (k / OASIS_CACHE_PAGE), states
+ *
+ * A desert is covered once OASIS_CACHE_TESTED is set; the hit bits are set
+ * before it by the hit callback, so a scan killed at any moment leaves at
+ * most deserts to scan again.  Before scanning, prime_oases serves the
+ * covered deserts from the cache and runs the engine on the gaps only.
+ *
+ * d<n> = d<m> * r for m < n (LCM(1,...,n) = LCM(1,...,m) * r), so the desert
+ * k of d<n> is the desert r*k of d<m>: the caches of the smaller d<m> in
+ * the directory (r < 2^64) are read too, e.g. d701 = d691 * 701.  A
+ * --prove scan is served only from r = 1 (a proof of d<m> does not know
+ * the factors of r).  d2.cache is not read for a larger d<n>: the d2 scan
+ * steps by 2 and records pit - 1 as the pit + 1 of the desert before.
+ *
+ * The file is written by one process at a time (flock); another process
+ * reads it and does not record its own hits.
+ *
+ * @note v1.32.0 (2026-10-16): Add result cache (oasis_cache)
+ */
+
+#ifndef _OASIS_CACHE_H
+#define _OASIS_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define OASIS_CACHE_MAGIC	"OASISCAC"
+#define OASIS_CACHE_VERSION	(1)
+#define OASIS_CACHE_PAGE	(1 << 16)	// deserts of a page
+#define OASIS_CACHE_SRC_MAX	(16)		// caches of smaller d<m> read
+
+/* State of a desert */
+#define OASIS_CACHE_TESTED	(0x01)		// pit - 1 and pit + 1 are tested
+#define OASIS_CACHE_M1		(0x02)		// pit - 1 is a prime
+#define OASIS_CACHE_P1		(0x04)		// pit + 1 is a prime
+#define OASIS_CACHE_PROVED	(0x08)		// the hits are tried by --prove
+#define OASIS_CACHE_PRV_M1	(0x10)		// pit - 1 is proven
+#define OASIS_CACHE_PRV_P1	(0x20)		// pit + 1 is proven
+
+typedef struct {
+	char		magic[8];		// OASIS_CACHE_MAGIC (not terminated)
+	uint32_t	version;		// OASIS_CACHE_VERSION
+	uint32_t	desert;			// n of d<n>
+	uint32_t	page;			// OASIS_CACHE_PAGE
+	uint32_t	pages;			// pages in the file
+} OASIS_CACHE_HDR;
+
+typedef struct {
+	uint64_t	no;			// page number: deserts no * OASIS_CACHE_PAGE ...
+	uint64_t	reserved;
+	uint8_t		st[OASIS_CACHE_PAGE];	// OASIS_CACHE_* of the deserts
+} OASIS_CACHE_PG;
+
+/* Page of a mapped file, by page number */
+typedef struct {
+	uint64_t	no;			// page number
+	uint32_t	i;			// index of the page in the file
+} OASIS_CACHE_IX;
+
+/* A mapped cache file */
+typedef struct {
+	int		 fd;			// -1: not open
+	int		 desert;		// n of d<n>
+	int		 rw;			// written by this process (flock held)
+	uint64_t	 ratio;			// d<owner> / d<desert>: desert k is r*k here
+	uint8_t		*map;
+	size_t		 size;
+	uint32_t	 npg;			// pages
+	OASIS_CACHE_IX	*ix;			// pages, sorted by number
+	uint64_t	 last;			// page number of the last lookup
+	uint8_t		*last_st;		// its states (NULL: not in the file)
+} OASIS_CACHE_MAP;
+
+typedef struct {
+	OASIS_CACHE_MAP	 own[1];		// d<n>.cache
+	OASIS_CACHE_MAP	 src[OASIS_CACHE_SRC_MAX];	// d<m>.cache, m < n
+	int		 nsrc;
+	uint64_t	 served;		// deserts served from the cache
+	uint64_t	 scanned;		// deserts recorded
+} OASIS_CACHE;
+
+int  oasis_cache_open(OASIS_CACHE *c, const char *dir, int desert);
+void oasis_cache_close(OASIS_CACHE *c);
+int  oasis_cache_get(OASIS_CACHE *c, uint64_t k, int prove);
+int  oasis_cache_set(OASIS_CACHE *c, uint64_t k, int bits);
+uint64_t oasis_cache_span(OASIS_CACHE *c, uint64_t k, uint64_t k_end, int prove, int covered);
+
+#endif  // _OASIS_CACHE_H
@@ -0,0 +1,202 @@
+/**
+ * @file oasis_ckpt.c
+ * @brief Checkpoint file of a long desert scan.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * @note v1.32.1 (2026-10-16): Add the size and identity of the output file (bytes=, file=, gzip=)
+ *       Remove the hash of the output lines (hash=), never read on --resume
+ * @note v1.14.0 (2026-10-16): Add the output format and file (format=, output=)
+ * @note v1.13.0 (2026-10-16): Add checkpoint / resume
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "oasis_ckpt.h"
+
+/**
+ * @brief Write the checkpoint atomically
+ *
+ * @note Modified in v1.32.1 (2026-10-16): bytes= and file= when the output
+ *       is a regular file (oasis_ckpt_mark()), gzip= for an open member.
+ *       No hash= (it was never read).
+ *
+ * @param[in] path Checkpoint file
+ * @param[in] ck   State
+ *
+ * @return 0 on success, -1 on failure (the previous checkpoint is kept)
+ */
+int oasis_ckpt_save(const char *path, const OASIS_CKPT *ck)
+{
+	char  tmp[4096];
+	FILE *fp;
+	int   ret = 0;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return -1;
+
+	fp = fopen(tmp, "w");
+	if (fp == NULL) return -1;
+
+	fprintf(fp, "# %s checkpoint\n", ck->prog);
+	fprintf(fp, "version=%d\n", OASIS_CKPT_VERSION);
+	fprintf(fp, "prog=%s\n", ck->prog);
+	fprintf(fp, "args=%s\n", ck->args);
+	fprintf(fp, "prove=%d\n", ck->prove);
+	fprintf(fp, "next=%" PRIu64 "\n", ck->next);
+	fprintf(fp, "try=%" PRIu64 "\n", ck->try_cnt);
+	fprintf(fp, "hit=%" PRIu64 "\n", ck->hit_cnt);
+	fprintf(fp, "proven=%" PRIu64 "\n", ck->prv_cnt);
+	fprintf(fp, "twin=%" PRIu64 "\n", ck->twin_cnt);
+	fprintf(fp, "lines=%" PRIu64 "\n", ck->lines);
+	fprintf(fp, "format=%d\n", ck->format);
+	fprintf(fp, "output=%s\n", ck->out);
+	if (ck->ino) {
+		fprintf(fp, "bytes=%" PRIu64 "\n", ck->bytes);
+		fprintf(fp, "file=%" PRIu64 ":%" PRIu64 "\n", ck->dev, ck->ino);
+	}
+	if (ck->gz_open) {
+		fprintf(fp, "gzip=%08" PRIx32 ":%" PRIu32 "\n", ck->gz_crc, ck->gz_len);
+	}
+
+	if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) ret = -1;
+	if (fclose(fp) != 0) ret = -1;
+	if (ret == 0 && rename(tmp, path) != 0) ret = -1;
+	if (ret != 0) remove(tmp);
+
+	return ret;
+}
+
+/**
+ * @brief Read a checkpoint
+ *
+ * @note Modified in v1.32.1 (2026-10-16): bytes=, file= and gzip= are
+ *       optional (a checkpoint of an older version has none).  The hash= of
+ *       an older version is skipped.
+ *
+ * @param[in]  path Checkpoint file
+ * @param[out] ck   State
+ *
+ * @return 0 on success, -1 if the file cannot be read or is not a checkpoint
+ */
+int oasis_ckpt_load(const char *path, OASIS_CKPT *ck)
+{
+	char  line[OASIS_CKPT_ARGS + 64];
+	char *val;
+	FILE *fp;
+	int   version = 0;
+	int   next = 0;
+
+	memset(ck, 0, sizeof(*ck));
+	fp = fopen(path, "r");
+	if (fp == NULL) return -1;
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '#' || (val = strchr(line, '=')) == NULL) continue;
+		*val++ = '\0';
+
+		if      (strcmp(line, "version") == 0) version = atoi(val);
+		else if (strcmp(line, "prog")    == 0) snprintf(ck->prog, sizeof(ck->prog), "%s", val);
+		else if (strcmp(line, "args")    == 0) snprintf(ck->args, sizeof(ck->args), "%s", val);
+		else if (strcmp(line, "prove")   == 0) ck->prove    = atoi(val);
+		else if (strcmp(line, "next")    == 0) ck->next     = strtoull(val, NULL, 10), next = 1;
+		else if (strcmp(line, "try")     == 0) ck->try_cnt  = strtoull(val, NULL, 10);
+		else if (strcmp(line, "hit")     == 0) ck->hit_cnt  = strtoull(val, NULL, 10);
+		else if (strcmp(line, "proven")  == 0) ck->prv_cnt  = strtoull(val, NULL, 10);
+		else if (strcmp(line, "twin")    == 0) ck->twin_cnt = strtoull(val, NULL, 10);
+		else if (strcmp(line, "lines")   == 0) ck->lines    = strtoull(val, NULL, 10);
+		else if (strcmp(line, "format")  == 0) ck->format   = atoi(val);
+		else if (strcmp(line, "output")  == 0) snprintf(ck->out, sizeof(ck->out), "%s", val);
+		else if (strcmp(line, "bytes")   == 0) ck->bytes    = strtoull(val, NULL, 10);
+		else if (strcmp(line, "file")    == 0) sscanf(val, "%" SCNu64 ":%" SCNu64, &ck->dev, &ck->ino);
+		else if (strcmp(line, "gzip")    == 0) {
+			ck->gz_open = (sscanf(val, "%" SCNx32 ":%" SCNu32, &ck->gz_crc, &ck->gz_len) == 2);
+		}
+	}
+	fclose(fp);
+
+	return (version == OASIS_CKPT_VERSION && next && ck->prog[0] && ck->args[0])? 0: -1;
+}
+
+/**
+ * @brief Split the parameters of the checkpoint into argv[1..]
+ *
+ * @param[in,out] ck   State (args is split in place)
+ * @param[out]    argv Argument vector, argv[0] is prog
+ * @param[in]     max  Size of argv
+ *
+ * @return Argument count (including argv[0])
+ */
+int oasis_ckpt_argv(OASIS_CKPT *ck, char *argv[], int max)
+{
+	char *tok, *save = NULL;
+	int   argc = 0;
+
+	argv[argc++] = ck->prog;
+	for (tok = strtok_r(ck->args, " ", &save); tok != NULL && argc < max - 1;
+	     tok = strtok_r(NULL, " ", &save)) {
+		argv[argc++] = tok;
+	}
+	argv[argc] = NULL;
+
+	return argc;
+}
+
+/**
+ * @brief Keep the size and identity of the output file in the checkpoint
+ *
+ * @param[in,out] ck Checkpoint (bytes, dev, ino)
+ * @param[in]     fd Output, everything written to it already (flushed)
+ *
+ * @details dev and ino are 0 if fd is not a regular file.
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+void oasis_ckpt_mark(OASIS_CKPT *ck, int fd)
+{
+	struct stat st;
+	off_t       pos = lseek(fd, 0, SEEK_CUR);
+
+	ck->bytes = 0;
+	ck->dev   = 0;
+	ck->ino   = 0;
+	if (pos < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return;
+	ck->bytes = (uint64_t)pos;
+	ck->dev   = (uint64_t)st.st_dev;
+	ck->ino   = (uint64_t)st.st_ino;
+}
+
+/**
+ * @brief Cut the output file back to the checkpoint (--resume)
+ *
+ * @param[in] ck Checkpoint
+ * @param[in] fd Output of the resumed scan, nothing written to it yet
+ *
+ * @return 1 if the file is cut back to ck->bytes (and positioned there),
+ *         0 if fd is not the file of the checkpoint (appended to),
+ *         -1 if it is, but shorter than the checkpoint or cannot be cut
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+int oasis_ckpt_cut(const OASIS_CKPT *ck, int fd)
+{
+	struct stat st;
+
+	if (ck->ino == 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+	||  (uint64_t)st.st_dev != ck->dev || (uint64_t)st.st_ino != ck->ino) {
+		return 0;
+	}
+	if ((uint64_t)st.st_size < ck->bytes
+	||  ftruncate(fd, (off_t)ck->bytes) != 0
+	||  lseek(fd, (off_t)ck->bytes, SEEK_SET) < 0) {
+		return -1;
+	}
+
+	return 1;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file oasis_ckpt.h
+ * @brief Checkpoint file of a long desert scan.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * A checkpoint is a small text file of "key=value" lines, replaced
+ * atomically (write to <file>.tmp, fsync, rename), so a scan that is killed
+ * at any moment leaves either the previous or the new checkpoint.
+ * It holds the command arguments, the next desert to scan, the counters and
+ * the number of output lines written so far.
+ * The sieve needs no state of its own: it is positioned from the desert
+ * index (see oasis_sieve_seek()).
+ *
+ * When the output is a regular file, its size and identity are kept too
+ * (bytes=, file=): --resume cuts the same file back to the checkpoint, so
+ * the lines written after it by a killed scan are not written twice.  A
+ * gzip member cut after a sync flush is closed first (gzip=, see
+ * oasis_out_gz_end()).  Any other output (a terminal, a pipe, another
+ * file) is appended to as before.
+ *
+ * @note v1.32.1 (2026-10-16): Add the size and identity of the output file (bytes=, file=, gzip=)
+ *       Remove the hash of the output lines (hash=), never read on --resume
+ * @note v1.14.0 (2026-10-16): Add the output format and file (format=, output=)
+ * @note v1.13.0 (2026-10-16): Add checkpoint / resume
+ */
+
+#ifndef _OASIS_CKPT_H
+#define _OASIS_CKPT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define OASIS_CKPT_VERSION	(1)
+#define OASIS_CKPT_SEC		(60)			// seconds between checkpoints
+#define OASIS_CKPT_ARGS		(256)
+
+typedef struct {
+	char		prog[32];		// prime_oases / prime_oasis
+	char		args[OASIS_CKPT_ARGS];	// parameters, separated by ' '
+	int		prove;			// --prove
+	uint64_t	next;			// next desert to scan (relative to the first)
+	uint64_t	try_cnt;
+	uint64_t	hit_cnt;
+	uint64_t	prv_cnt;
+	uint64_t	twin_cnt;
+	uint64_t	lines;			// output lines written
+	int		format;			// output format (0: text, 1: binary records, 2: --no-decimal)
+	char		out[OASIS_CKPT_ARGS];	// output file ("": stdout)
+	uint64_t	bytes;			// size of the output file at the checkpoint
+	uint64_t	dev;			// the output file (0, 0: not a regular file)
+	uint64_t	ino;
+	int		gz_open;		// a gzip member is open at bytes (sync flush)
+	uint32_t	gz_crc;			// its CRC-32 so far
+	uint32_t	gz_len;			// its uncompressed bytes so far (mod 2^32)
+} OASIS_CKPT;
+
+int      oasis_ckpt_save(const char *path, const OASIS_CKPT *ck);
+int      oasis_ckpt_load(const char *path, OASIS_CKPT *ck);
+int      oasis_ckpt_argv(OASIS_CKPT *ck, char *argv[], int max);
+void     oasis_ckpt_mark(OASIS_CKPT *ck, int fd);
+int      oasis_ckpt_cut(const OASIS_CKPT *ck, int fd);
+
+#endif  // _OASIS_CKPT_H
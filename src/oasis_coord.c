@@ -0,0 +1,605 @@
+/**
+ * @file oasis_coord.c
+ * @brief Work-unit coordinator of a prime_oases scan over many processes.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Splits "prime_oases d<n> x<no> <num>" into units of <deserts> deserts and
+ * hands them out to the workers ("prime_oases --worker <addr>") with a
+ * lease of <sec> seconds.  A worker renews the lease while it scans and
+ * sends the hits of the unit back; a unit whose worker dies (the socket
+ * is closed) or whose lease runs out is handed out again.  The hits are
+ * written in the order of the units, so the output is the same as the one
+ * of a single "prime_oases -o <file>", and the statistics are summed.
+ *
+ * Protocol ('\n' terminated lines, see oasis_net.h):
+ *
+ *   worker                                  coordinator
+ *   HELLO <pid>                         ->
+ *                                       <-  UNIT <id> d<n> x<no> <num> <format> <prove> <lease>
+ *   BEAT <id>                           ->  (every <lease>/3 seconds)
+ *   RESULT <id> <try> <hit> <prv> <bytes>
+ *   <bytes> of hits (text lines or OASIS_REC) ->
+ *                                       <-  UNIT ... | WAIT <sec> | DONE
+ *   NEXT                                ->  (after WAIT)
+ *
+ * The first result of a unit is kept, a late one of an expired lease is
+ * dropped.  A RESULT of a unit that the worker does not hold, and did not
+ * hold until its lease ran out, closes the connection.  The deserts are
+ * independent (pit = d<n>*k, no boundary), so the units need no overlap.
+ *
+ * @note v1.26.0 (2026-10-16): Add oasis_coord command
+ *       1. Specify d<n> x<no> <num> as arguments to the command
+ *       2. -l <addr>: "unix:<path>" or "<host>:<port>"
+ *       3. -u <deserts>, --lease <sec>, --format=text/bin, --prove, -o <file>
+ *
+ * @note Around 1024-bit version for educational purposes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <gmp.h>
+
+#define XPT_ON
+#include "xpt.h"
+int xpt_flg = 0;
+
+#include "oasis_net.h"
+#include "oasis_rec.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_INVL	(-5)	// Invalid value
+#define ERR_OPT		(-6)	// Invalid option
+#define ERR_OUT		(-8)	// Output file cannot be written
+#define ERR_NET		(-9)	// Address cannot be listened on
+#define ERR_UNIT	(-10)	// A unit failed CO_TRIES_MAX times
+#define ERR_MEM		(-11)	// Out of memory
+
+#define CO_ADDR		"unix:oasis_coord.sock"	// default -l <addr>
+#define CO_DESERTS	(10000)		// default deserts of a unit (-u)
+#define CO_LEASE_SEC	(60)		// default lease (--lease)
+#define CO_WAIT_SEC	(1)		// WAIT of an idle worker
+#define CO_TRIES_MAX	(5)		// leases a unit may lose
+#define CO_UNITS_MAX	(UINT64_C(1) << 24)
+#define CO_CONN_MAX	(1024)
+
+/* CO_UNIT.state */
+#define CO_PEND		(0)		// to be handed out
+#define CO_LEASED	(1)		// a worker scans it
+#define CO_DONE		(2)		// the hits are here, not written yet
+#define CO_OUT		(3)		// written
+
+typedef struct {
+	uint64_t	k_lo;			// deserts k_lo..k_hi-1 (relative to x<no>)
+	uint64_t	k_hi;
+	int		state;			// CO_*
+	int		lost;			// leases lost (crash, expiry)
+	char	       *out;			// hits (CO_DONE)
+	size_t		len;
+} CO_UNIT;
+
+typedef struct {
+	int		fd;			// -1: free
+	long		pid;			// of HELLO
+	int64_t		unit;			// leased unit (-1: none)
+	int64_t		expired;		// unit whose lease ran out (-1: none)
+	time_t		due;			// end of the lease
+	char		in[OASIS_NET_LINE];	// line being read
+	size_t		nin;
+	int64_t		r_unit;			// unit of the RESULT being read (-1: none)
+	uint64_t	r_cnt[3];		// try, hit, prv of the RESULT
+	char	       *r_out;			// hits of the RESULT
+	size_t		r_len;
+	size_t		r_need;			// bytes of the RESULT still to read
+} CO_CONN;
+
+/* The job */
+typedef struct {
+	int		desert;			// n of d<n>
+	mpz_t		no;			// x<no>
+	uint64_t	num;			// <num>
+	uint64_t	deserts;		// -u <deserts>
+	int		lease;			// --lease <sec>
+	int		format;			// 0: text, 1: bin (--format)
+	int		prove;			// --prove
+	const char     *addr;			// -l <addr>
+	const char     *out;			// -o <file> (NULL: stdout)
+} CO_JOB;
+
+static CO_JOB job[1];
+
+/* The coordinator */
+typedef struct {
+	CO_UNIT	       *unit;
+	uint64_t	nunit;
+	uint64_t	scan;			// units before scan are not CO_PEND
+	uint64_t	next;			// next unit to write
+	uint64_t	cnt[3];			// try, hit, prv of the written units
+	uint64_t	reissued;
+	CO_CONN		conn[CO_CONN_MAX];
+	int		nconn;			// conn[0..nconn-1] may be used
+	FILE	       *fp;			// output
+	int		err;			// ERR_UNIT, ERR_OUT
+} CO;
+
+static CO co[1];
+
+/**
+ * @brief Send a line to a worker
+ */
+static int co_send(CO_CONN *cn, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static int co_send(CO_CONN *cn, const char *fmt, ...)
+{
+	char    line[OASIS_NET_LINE];
+	va_list ap;
+	int     len;
+
+	va_start(ap, fmt);
+	len = vsnprintf(line, sizeof(line), fmt, ap);
+	va_end(ap);
+
+	return oasis_net_write(cn->fd, line, (len < (int)sizeof(line))? len: (int)sizeof(line) - 1);
+}
+
+/**
+ * @brief Put a lost unit back to the units to hand out
+ *
+ * @param[in] u   Unit
+ * @param[in] why Reason for the log
+ * @param[in] pid Worker that lost it
+ */
+static void co_lost(uint64_t u, const char *why, long pid)
+{
+	CO_UNIT *ut = &co->unit[u];
+
+	if (ut->state != CO_LEASED) return;		// the result came from another worker
+	ut->state = CO_PEND;
+	co->reissued++;
+	if (u < co->scan) co->scan = u;
+	fprintf(stderr, "oasis_coord: unit %lu lost (%s, worker %ld), handed out again\n", u, why, pid);
+	if (++ut->lost >= CO_TRIES_MAX) {
+		fprintf(stderr, "oasis_coord: ERR: unit %lu lost %d times\n", u, ut->lost);
+		co->err = ERR_UNIT;
+	}
+}
+
+/**
+ * @brief Close a worker connection; its unit is handed out again
+ */
+static void co_close(CO_CONN *cn)
+{
+	if (cn->unit >= 0) co_lost(cn->unit, "connection closed", cn->pid);
+	close(cn->fd);
+	free(cn->r_out);
+	memset(cn, 0, sizeof(*cn));
+	cn->fd      = -1;
+	cn->unit    = -1;
+	cn->expired = -1;
+	cn->r_unit  = -1;
+}
+
+/**
+ * @brief Answer a worker that is ready: a unit, WAIT or DONE
+ *
+ * @return 0, or -1 if the worker is gone
+ */
+static int co_assign(CO_CONN *cn)
+{
+	CO_UNIT *ut;
+	uint64_t u;
+	mpz_t    no;
+	char     x[OASIS_NET_LINE / 2];
+
+	while (co->scan < co->nunit && co->unit[co->scan].state != CO_PEND) {
+		co->scan++;
+	}
+	if (co->scan == co->nunit) {			// nothing to hand out
+		return (co->next == co->nunit)? co_send(cn, "DONE\n"): co_send(cn, "WAIT %d\n", CO_WAIT_SEC);
+	}
+
+	u  = co->scan++;
+	ut = &co->unit[u];
+	ut->state = CO_LEASED;
+	cn->unit  = (int64_t)u;
+	cn->due   = time(NULL) + job->lease;
+
+	mpz_init(no);
+	mpz_add_ui(no, job->no, ut->k_lo);		// x<no + k_lo>
+	gmp_snprintf(x, sizeof(x), "%Zd", no);
+	mpz_clear(no);
+
+	return co_send(cn, "UNIT %lu d%d x%s %lu %s %d %d\n", u, job->desert, x,
+		       ut->k_hi - ut->k_lo, (job->format)? "bin": "text", job->prove, job->lease);
+}
+
+/**
+ * @brief Write the units that are done, in order
+ */
+static void co_flush(void)
+{
+	CO_UNIT *ut;
+
+	while (co->next < co->nunit && co->unit[co->next].state == CO_DONE) {
+		ut = &co->unit[co->next];
+		if (ut->len && fwrite(ut->out, 1, ut->len, co->fp) != ut->len) {
+			co->err = ERR_OUT;
+		}
+		free(ut->out);
+		ut->out   = NULL;
+		ut->state = CO_OUT;
+		co->next++;
+	}
+	fflush(co->fp);
+}
+
+/**
+ * @brief A result is read: keep it (first one) and answer the worker
+ *
+ * @return 0, or -1 if the worker is gone
+ */
+static int co_result(CO_CONN *cn)
+{
+	CO_UNIT *ut = &co->unit[cn->r_unit];
+	int      i;
+
+	if (ut->state == CO_PEND || ut->state == CO_LEASED) {	// the first result
+		ut->state = CO_DONE;
+		ut->out   = cn->r_out;
+		ut->len   = cn->r_len;
+		cn->r_out = NULL;
+		for (i = 0; i < 3; i++) {
+			co->cnt[i] += cn->r_cnt[i];
+		}
+		co_flush();
+	}
+	free(cn->r_out);					// a late result of an expired lease
+	cn->r_out = NULL;
+	if (cn->unit == cn->r_unit) cn->unit = -1;
+	if (cn->expired == cn->r_unit) cn->expired = -1;
+	cn->r_unit = -1;
+
+	return co_assign(cn);
+}
+
+/**
+ * @brief A line of a worker
+ *
+ * @return 0, or -1 to close the connection
+ */
+static int co_line(CO_CONN *cn, char *line)
+{
+	unsigned long id;
+	unsigned long cnt[3];
+	unsigned long len;
+
+	if (sscanf(line, "HELLO %ld", &cn->pid) == 1 || strcmp(line, "NEXT") == 0) {
+		return (cn->unit < 0)? co_assign(cn): -1;
+	}
+	if (sscanf(line, "BEAT %lu", &id) == 1) {
+		if (cn->unit == (int64_t)id) cn->due = time(NULL) + job->lease;
+		return 0;
+	}
+	if (sscanf(line, "RESULT %lu %lu %lu %lu %lu", &id, &cnt[0], &cnt[1], &cnt[2], &len) == 5
+	&&  (cn->unit == (int64_t)id || cn->expired == (int64_t)id)) {	// held by this worker
+		cn->r_unit   = (int64_t)id;
+		cn->r_cnt[0] = cnt[0];
+		cn->r_cnt[1] = cnt[1];
+		cn->r_cnt[2] = cnt[2];
+		cn->r_len    = len;
+		cn->r_need   = len;
+		cn->r_out    = (len)? malloc(len): NULL;
+		if (len && cn->r_out == NULL) return -1;
+		return (len)? 0: co_result(cn);
+	}
+	XPT(XPT_WRN, "WRN: worker %ld: '%s'\n", cn->pid, line);
+
+	return -1;
+}
+
+/**
+ * @brief Read what a worker sent
+ *
+ * @return 0, or -1 to close the connection
+ */
+static int co_input(CO_CONN *cn)
+{
+	static char buf[1 << 16];
+	ssize_t     n;
+	size_t      i = 0, m;
+
+	n = read(cn->fd, buf, sizeof(buf));
+	if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 0;
+	if (n <= 0) return -1;
+
+	while (i < (size_t)n) {
+		if (cn->r_need) {				// hits of a RESULT
+			m = ((size_t)n - i < cn->r_need)? (size_t)n - i: cn->r_need;
+			memcpy(cn->r_out + (cn->r_len - cn->r_need), &buf[i], m);
+			cn->r_need -= m;
+			i += m;
+			if (cn->r_need == 0 && co_result(cn) != 0) return -1;
+			continue;
+		}
+		if (buf[i] == '\n') {
+			cn->in[cn->nin] = '\0';
+			cn->nin = 0;
+			i++;
+			if (co_line(cn, cn->in) != 0) return -1;
+			continue;
+		}
+		if (cn->nin + 1 >= sizeof(cn->in)) return -1;	// too long
+		cn->in[cn->nin++] = buf[i++];
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Run the job: serve the workers until all the units are written
+ *
+ * @return ERR_OK, ERR_NET, ERR_UNIT or ERR_OUT
+ */
+static int co_run(void)
+{
+	struct pollfd pfd[CO_CONN_MAX + 1];
+	CO_CONN      *cn;
+	time_t        now;
+	int           lfd, fd, n, i;
+
+	lfd = oasis_net_listen(job->addr);
+	if (lfd < 0) {
+		printf("ERR: Cannot listen on '%s' (%s)\n", job->addr, strerror(errno));
+		return ERR_NET;
+	}
+	for (i = 0; i < CO_CONN_MAX; i++) {
+		co->conn[i].fd      = -1;
+		co->conn[i].unit    = -1;
+		co->conn[i].expired = -1;
+		co->conn[i].r_unit  = -1;
+	}
+	fprintf(stderr, "oasis_coord: %lu units of %lu deserts on %s\n", co->nunit, job->deserts, job->addr);
+
+	while (co->next < co->nunit && co->err == ERR_OK) {
+		pfd[0].fd     = lfd;
+		pfd[0].events = POLLIN;
+		for (i = 0; i < co->nconn; i++) {
+			pfd[i + 1].fd     = co->conn[i].fd;
+			pfd[i + 1].events = POLLIN;
+		}
+		n = poll(pfd, co->nconn + 1, 1000);
+		if (n < 0 && errno != EINTR) break;
+
+		for (i = 0; n > 0 && i < co->nconn; i++) {	// workers
+			if (co->conn[i].fd >= 0 && (pfd[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+				if (co_input(&co->conn[i]) != 0) co_close(&co->conn[i]);
+			}
+		}
+		if (n > 0 && (pfd[0].revents & POLLIN)) {	// a new worker
+			fd = accept(lfd, NULL, NULL);
+			for (i = 0; fd >= 0 && i < CO_CONN_MAX && co->conn[i].fd >= 0; i++) ;
+			if (fd >= 0 && i == CO_CONN_MAX) {
+				close(fd);			// full
+			}
+			else if (fd >= 0) {
+				co->conn[i].fd = fd;
+				if (i >= co->nconn) co->nconn = i + 1;
+			}
+		}
+
+		now = time(NULL);				// leases that ran out
+		for (i = 0; i < co->nconn; i++) {
+			cn = &co->conn[i];
+			if (cn->fd >= 0 && cn->unit >= 0 && now > cn->due) {
+				co_lost(cn->unit, "lease expired", cn->pid);
+				cn->expired = cn->unit;		// a late RESULT is still taken
+				cn->unit    = -1;
+			}
+		}
+	}
+
+	for (i = 0; i < co->nconn; i++) {		// the workers stop
+		cn = &co->conn[i];
+		if (cn->fd >= 0) {
+			if (cn->unit < 0 && cn->r_need == 0) co_send(cn, "DONE\n");
+			cn->unit = -1;
+			co_close(cn);
+		}
+	}
+	close(lfd);
+	if (strncmp(job->addr, "unix:", 5) == 0) unlink(job->addr + 5);
+
+	return co->err;
+}
+
+/**
+ * @brief Check that a string is a decimal number
+ */
+static int is_number(const char *s)
+{
+	if (s == NULL || *s == '\0') return 0;
+	for (; *s; s++) {
+		if (!isdigit((unsigned char)*s)) return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Parse the options and the parameters
+ *
+ * @return ERR_OK, ERR_PNUM, ERR_OPT or ERR_INVL
+ */
+static int check_param(int argc, char *argv[])
+{
+	char *arg[3];
+	int   i, n = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') {
+			if (n == 3) return ERR_PNUM;
+			arg[n++] = argv[i];
+		}
+		else if (strcmp(argv[i], "--prove") == 0) {
+			job->prove = 1;
+		}
+		else if (strcmp(argv[i], "--format=text") == 0) {
+			job->format = 0;
+		}
+		else if (strcmp(argv[i], "--format=bin") == 0) {
+			job->format = 1;
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-l") == 0) {
+			job->addr = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+			job->out = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-u") == 0 && is_number(argv[i + 1])) {
+			job->deserts = strtoull(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "--lease") == 0 && is_number(argv[i + 1])) {
+			job->lease = atoi(argv[++i]);
+		}
+		else {
+			printf("ERR: Invalid option '%s'\n", argv[i]);
+			return ERR_OPT;
+		}
+	}
+	if (n != 3) return ERR_PNUM;
+
+	if (arg[0][0] != 'd' || !is_number(&arg[0][1]) || atoi(&arg[0][1]) < 2) {
+		printf("ERR: Invalid d<n> '%s'\n", arg[0]);
+		return ERR_INVL;
+	}
+	if (arg[1][0] != 'x' || !is_number(&arg[1][1])
+	||  mpz_set_str(job->no, &arg[1][1], 10) != 0 || mpz_cmp_ui(job->no, 1) < 0) {
+		printf("ERR: Invalid x<no> '%s'\n", arg[1]);
+		return ERR_INVL;
+	}
+	errno = 0;
+	if (!is_number(arg[2]) || (job->num = strtoull(arg[2], NULL, 10)) < 1 || errno) {
+		printf("ERR: Invalid <num> '%s'\n", arg[2]);
+		return ERR_INVL;
+	}
+	job->desert = atoi(&arg[0][1]);
+	if (job->deserts < 1 || job->lease < 3) {
+		printf("ERR: -u <deserts> must be >= 1, --lease <sec> >= 3\n");
+		return ERR_INVL;
+	}
+	if (job->format && (job->out == NULL || !mpz_fits_ulong_p(job->no)
+	||  mpz_get_ui(job->no) > UINT64_MAX - job->num)) {
+		printf("ERR: --format=bin needs -o <file> and x<no> + <num> < 2^64\n");
+		return ERR_INVL;
+	}
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Display usage information for the oasis_coord command
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_coord [-l <addr>] [-u <deserts>] [--lease <sec>] [--format=text|bin] [--prove]\n");
+	printf("                   [-o <file>] d<n> x<no> <num>\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       Hand out the scan 'prime_oases d<n> x<no> <num>' in units to the workers\n");
+	printf("       'prime_oases --worker <addr>' and write their hits in order.\n");
+	printf("---< OPTIONS:\n");
+	printf("       -l <addr>        unix:<path> or <host>:<port> (default %s)\n", CO_ADDR);
+	printf("       -u <deserts>     Deserts of a unit (default %d)\n", CO_DESERTS);
+	printf("       --lease <sec>    A unit whose worker sends nothing for <sec> seconds is handed out\n");
+	printf("                        again (default %d)\n", CO_LEASE_SEC);
+	printf("       --format=bin     Write the records of oasis_rec.h (needs -o <file>)\n");
+	printf("       --prove          The workers prove the primes\n");
+	printf("       -o <file>        Write the hits to <file> (default stdout)\n");
+	printf("---< CAUTION:\n");
+	printf("       1) The output is the same as 'prime_oases -o <file> d<n> x<no> <num>'; the statistics\n");
+	printf("          line is printed to stdout at the end.\n");
+	printf("       2) A unit lost %d times (crashing workers) stops the coordinator.\n", CO_TRIES_MAX);
+	printf("---< EXAMPLES:\n");
+	printf("       oasis_coord -l :7010 -o l2.txt d683 x484391 484391 &\n");
+	printf("       prime_oases -j 4 --worker node0:7010   # on each node\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char *argv[])
+{
+	OASIS_REC_HDR hdr[1];
+	uint64_t      u;
+	int           ret;
+
+	XPT_INIT();
+
+	mpz_init(job->no);
+	job->deserts = CO_DESERTS;
+	job->lease   = CO_LEASE_SEC;
+	job->addr    = CO_ADDR;
+
+	ret = check_param(argc, argv);
+	if (ret == ERR_OK) {
+		co->nunit = (job->num - 1) / job->deserts + 1;
+		co->unit  = (co->nunit <= CO_UNITS_MAX)? calloc(co->nunit, sizeof(CO_UNIT)): NULL;
+		if (co->unit == NULL) {
+			printf("ERR: Too many units, use a larger -u <deserts>\n");
+			ret = ERR_MEM;
+		}
+	}
+	if (ret == ERR_OK) {
+		for (u = 0; u < co->nunit; u++) {
+			co->unit[u].k_lo = u * job->deserts;
+			co->unit[u].k_hi = (u + 1 < co->nunit)? (u + 1) * job->deserts: job->num;
+		}
+		co->fp = (job->out)? fopen(job->out, (job->format)? "wb": "w"): stdout;
+		if (co->fp == NULL) {
+			printf("ERR: Cannot open '%s'\n", job->out);
+			ret = ERR_OUT;
+		}
+		else if (job->format) {
+			oasis_rec_hdr_init(hdr, job->desert, mpz_get_ui(job->no), job->num,
+					   (job->prove)? OASIS_REC_HDR_PROVE: 0);
+			fwrite(hdr, sizeof(hdr), 1, co->fp);
+		}
+	}
+	if (ret == ERR_OK) {
+		ret = co_run();
+		if (co->fp != stdout && fclose(co->fp) != 0 && ret == ERR_OK) {
+			ret = ERR_OUT;
+		}
+	}
+
+	if (ret == ERR_OK) {
+		gmp_printf("{ prime_oases d%d x%Zd %lu: try=%lu, hit=%lu(%2.1f%%)",
+			   job->desert, job->no, job->num, co->cnt[0], co->cnt[1],
+			   (double)co->cnt[1] / (double)co->cnt[0] * 100.0);
+		if (job->prove) {
+			printf(", proven=%lu", co->cnt[2]);
+		}
+		printf(" }\n");
+		fprintf(stderr, "oasis_coord: %lu units, %lu handed out again\n", co->nunit, co->reissued);
+	}
+	else if (ret == ERR_PNUM || ret == ERR_OPT || ret == ERR_INVL) {
+		disp_usage();
+	}
+	else if (ret == ERR_OUT) {
+		printf("ERR: Cannot write '%s'\n", (job->out)? job->out: "stdout");
+	}
+
+	free(co->unit);
+	mpz_clear(job->no);
+
+	return (ret == ERR_OK)? 0: 1;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file oasis_ctl.c
+ * @brief Control thread of a scan: signals and the keyboard.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_ctl.h.  The signals are blocked in the calling thread before
+ * the engine starts its threads, so every thread inherits the mask and
+ * only the control thread takes them (sigtimedwait()).  No handler runs
+ * inside the scan, and no thread of the scan ever calls read() on stdin.
+ *
+ * @note v1.32.1 (2026-10-16): SIGTERM is always taken (a batch scheduler
+ *       preempts with it), so every command stops with all its hits written
+ *       The XPT_PRF snapshot on SIGUSR1 is XPT_PRF_DUMP() (nothing without XPT_ON)
+ * @note v1.24.0 (2026-10-16): Add control thread (oasis_ctl)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "oasis_ctl.h"
+
+#define XPT_ON
+#include "xpt.h"
+
+#define CTL_TICK_MS	(100)		// longest reaction time to a key or a stop
+
+static struct termios ctl_tty;		// terminal settings before the raw mode
+static int            ctl_raw = 0;	// stdin is in raw mode
+
+/**
+ * @brief Restore the terminal (also at exit)
+ */
+static void ctl_restore(void)
+{
+	if (ctl_raw) {
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &ctl_tty);
+		ctl_raw = 0;
+	}
+}
+
+/**
+ * @brief Put the terminal of stdin in raw mode (keys without Enter, no echo)
+ *
+ * @return 1 if stdin is a terminal in raw mode, 0 otherwise
+ */
+static int ctl_raw_mode(void)
+{
+	static int registered = 0;
+	struct termios raw;
+
+	if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &ctl_tty) != 0) return 0;
+
+	raw = ctl_tty;
+	raw.c_lflag &= ~(ICANON | ECHO);		// Ctrl+C still raises SIGINT
+	raw.c_cc[VMIN]  = 0;				// non-blocking
+	raw.c_cc[VTIME] = 0;
+	if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return 0;
+	ctl_raw = 1;
+	if (!registered) {
+		atexit(ctl_restore);
+		registered = 1;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Stop the scan
+ */
+static void ctl_stop(OASIS_CTL *ctl, int sig)
+{
+	if (atomic_exchange(&ctl->stop, 1) == 0) {
+		ctl->sig = sig;
+	}
+	oasis_engine_stop(ctl->eng);
+}
+
+/**
+ * @brief Control thread: wait for a signal or a key
+ *
+ * @details The stop is asked again every tick, so a stop that came
+ *          before oasis_engine_run() cleared the engine's flag is not lost.
+ *          A second SIGINT/SIGTERM while stopping ends the process at once.
+ */
+static void *ctl_main(void *arg)
+{
+	OASIS_CTL      *ctl = (OASIS_CTL *)arg;
+	struct timespec ts = { 0, CTL_TICK_MS * 1000 * 1000 };
+	siginfo_t       si;
+	char            c;
+	int             sig;
+
+	while (!atomic_load(&ctl->quit)) {
+		sig = sigtimedwait(&ctl->set, &si, &ts);
+		if (sig == SIGUSR1) {
+			oasis_engine_stat_now(ctl->eng);
+			XPT_PRF_DUMP();				// XPT_PRF snapshot
+		}
+		else if (sig == SIGINT || sig == SIGTERM) {
+			if (atomic_load(&ctl->stop)) {		// asked twice
+				ctl_restore();
+				signal(sig, SIG_DFL);
+				pthread_sigmask(SIG_UNBLOCK, &ctl->set, NULL);
+				raise(sig);
+			}
+			ctl_stop(ctl, sig);
+		}
+		while (ctl_raw && read(STDIN_FILENO, &c, 1) == 1) {
+			if (c == 'q' || c == 'Q' || c == 27) {	// 27 = ESC
+				ctl_stop(ctl, 0);
+			}
+		}
+		if (atomic_load(&ctl->stop)) {
+			oasis_engine_stop(ctl->eng);
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Start the control thread of a scan
+ *
+ * @param[out] ctl   Control
+ * @param[in]  eng   Scan (initialized, not running yet)
+ * @param[in]  flags OASIS_CTL_*
+ *
+ * @return 0, or -1 if the thread could not be started (nothing changed)
+ *
+ * @note Call it before oasis_engine_run() and before any other thread is
+ *       started: the threads started later inherit the blocked signals.
+ *
+ * @note Modified in v1.32.1 (2026-10-16): SIGTERM is taken without a flag.
+ */
+int oasis_ctl_start(OASIS_CTL *ctl, OASIS_ENGINE *eng, int flags)
+{
+	memset(ctl, 0, sizeof(*ctl));
+	ctl->eng   = eng;
+	ctl->flags = flags;
+
+	sigemptyset(&ctl->set);
+	sigaddset(&ctl->set, SIGINT);
+	sigaddset(&ctl->set, SIGTERM);
+	sigaddset(&ctl->set, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &ctl->set, &ctl->old);
+
+	if (flags & OASIS_CTL_KEYS) ctl_raw_mode();
+	if (pthread_create(&ctl->tid, NULL, ctl_main, ctl) != 0) {
+		ctl_restore();
+		pthread_sigmask(SIG_SETMASK, &ctl->old, NULL);
+		return -1;
+	}
+	ctl->running = 1;
+
+	return 0;
+}
+
+/**
+ * @brief End the control thread and restore the terminal and the signals
+ *
+ * @note A signal that comes after this is handled as before oasis_ctl_start().
+ */
+void oasis_ctl_end(OASIS_CTL *ctl)
+{
+	if (!ctl->running) return;
+
+	atomic_store(&ctl->quit, 1);
+	pthread_join(ctl->tid, NULL);
+	ctl->running = 0;
+	ctl_restore();
+	pthread_sigmask(SIG_SETMASK, &ctl->old, NULL);
+}
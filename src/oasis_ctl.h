@@ -0,0 +1,49 @@
+/**
+ * @file oasis_ctl.h
+ * @brief Control thread of a scan: signals and the keyboard.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The commands used to poll the keyboard with read() from the scan loop
+ * and to catch SIGINT with a handler.  A control thread now owns them:
+ *
+ *   SIGINT, SIGTERM, 'q', 'Q', ESC   stop the scan
+ *   SIGUSR1                          print the progress
+ *
+ * The keys are read only when stdin is a terminal (raw mode); a pipe or a
+ * file on stdin is left alone.  The scan itself only sees OASIS_ENGINE.req,
+ * one flag word (stop, request of the progress) it reads every ENG_POLL
+ * deserts.
+ *
+ * @note v1.32.1 (2026-10-16): SIGTERM always stops the scan like SIGINT (OASIS_CTL_TERM removed)
+ * @note v1.24.0 (2026-10-16): Add control thread (oasis_ctl)
+ */
+
+#ifndef _OASIS_CTL_H
+#define _OASIS_CTL_H
+
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "oasis_engine.h"
+
+/* oasis_ctl_start() flags */
+#define OASIS_CTL_KEYS		(0x01)		// 'q', 'Q' and ESC stop the scan (terminal only)
+
+typedef struct {
+	OASIS_ENGINE	*eng;			// scan to stop / to ask for the progress
+	int		 flags;			// OASIS_CTL_*
+	_Atomic int	 stop;			// a stop was asked
+	_Atomic int	 quit;			// end of the control thread
+	int		 sig;			// signal of the stop (0: a key)
+	sigset_t	 set;			// signals taken by the control thread
+	sigset_t	 old;			// signal mask before oasis_ctl_start()
+	pthread_t	 tid;
+	int		 running;
+} OASIS_CTL;
+
+int  oasis_ctl_start(OASIS_CTL *ctl, OASIS_ENGINE *eng, int flags);
+void oasis_ctl_end(OASIS_CTL *ctl);
+
+#endif  // _OASIS_CTL_H
@@ -0,0 +1,236 @@
+/**
+ * @file oasis_decode.c
+ * @brief Expand the binary result stream of prime_oases into text.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Prints the hits of "prime_oases --format=bin -o <file>" in the text format
+ * of prime_oases, so the lines are the same as those of the text output.
+ * The k-form lines of "prime_oases --no-decimal" ("d<n>*<k>+-1") are
+ * rendered the same way, the other lines are copied as they are.
+ *
+ * @note v1.31.0 (2026-10-16): Render the k-form lines of --no-decimal
+ *       1. A file that is not a binary result stream is read as text, and
+ *          its "d<n>*<k>+-1" lines get their " = <decimal>"
+ *       2. <file> "-" is stdin: "prime_oases --no-decimal ... | nice
+ *          oasis_decode -" converts to base 10 in a process of its own
+ *
+ * @note v1.15.0 (2026-10-16): Take d<n> from the LCM table (see oasis_lcm.h)
+ *
+ * @note v1.14.0 (2026-10-16): Add oasis_decode command
+ *       1. Specify the binary result files as arguments to the command
+ *       2. --header: display the header of each file before its hits
+ *
+ * @note Around 1024-bit version for educational purposes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <gmp.h>
+
+#include "oasis_rec.h"
+#include "oasis_lcm.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_FILE	(-2)	// File cannot be read
+#define ERR_FMT		(-3)	// Not a binary result stream
+
+/**
+ * @brief Display usage information for the oasis_decode command
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_decode [--header] <file> [<file> ...]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <file>    Binary result file of 'prime_oases --format=bin -o <file>', or\n");
+	printf("                 output of 'prime_oases --no-decimal' ('-': stdin)\n");
+	printf("---< OPTIONS:\n");
+	printf("       --header  Display the parameters of each file before its hits\n");
+	printf("---< EXAMPLES:\n");
+	printf("       prime_oases --format=bin -o l2.bin d683 x484391 484391\n");
+	printf("       oasis_decode l2.bin         # Same lines as the text output\n");
+	printf("       prime_oases --no-decimal -o l2.k d683 x484391 484391\n");
+	printf("       oasis_decode l2.k           # Same lines as the text output\n");
+	printf("       prime_oases --no-decimal d683 x484391 484391 | nice oasis_decode -\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Print the lines of a --no-decimal output, k-form lines rendered
+ *
+ * @param[in] fp     Text of prime_oases --no-decimal
+ * @param[in] header 1: display the number of rendered lines at the end
+ *
+ * @return ERR_OK
+ *
+ * @details A line "d<n>*<k>+-1[ (probable)]" is printed as
+ *          "d<n>*<k>+-1 = <d<n>*k+-1>[ (probable)]", the line of the text
+ *          output; d<n> is kept while n does not change.
+ *
+ * @note Added in v1.31.0 (2026-10-16)
+ */
+static int render_text(FILE *fp, int header)
+{
+	char    *line = NULL;
+	size_t   size = 0;
+	char    *p, *e;
+	long     n, n0 = 0;
+	int      sign;
+	uint64_t cnt = 0;
+	mpz_t    desert;
+	mpz_t    k;
+	mpz_t    t;
+
+	mpz_init(desert);
+	mpz_init(k);
+	mpz_init(t);
+	while (getline(&line, &size, fp) >= 0) {
+		p = line;
+		n = (p[0] == 'd')? strtol(&p[1], &e, 10): 0;
+		if (n < 2 || *e != '*') {			// banner, statistics, ...
+			fputs(line, stdout);
+			continue;
+		}
+		p = e + 1;
+		e = p + strspn(p, "0123456789");
+		if (e == p || (*e != '+' && *e != '-') || e[1] != '1'
+		||  (e[2] != '\n' && e[2] != '\0' && e[2] != ' ') || strncmp(&e[2], " = ", 3) == 0) {
+			fputs(line, stdout);			// not a k-form line (or rendered already)
+			continue;
+		}
+		sign = *e;
+		*e   = '\0';					// p = <k>
+		mpz_set_str(k, p, 10);
+		if (n != n0) {
+			oasis_lcm_get(desert, (int)n);	// desert = lcm(1,2,3,...,n)
+			n0 = n;
+		}
+		mpz_mul(t, desert, k);				// t = d<n> * k +- 1
+		if (sign == '-') mpz_sub_ui(t, t, 1);
+		else             mpz_add_ui(t, t, 1);
+		gmp_printf("d%ld*%Zd%c1 = %Zd%s", n, k, sign, t, &e[2]);
+		if (e[2] != '\n') putchar('\n');		// last line without '\n'
+		cnt++;
+	}
+	if (header) {
+		printf("# %lu hits\n", cnt);
+	}
+	free(line);
+	mpz_clear(desert);
+	mpz_clear(k);
+	mpz_clear(t);
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Print the hits of a binary result file, or render a text file
+ *
+ * @param[in] path   Binary result file, or --no-decimal output ("-": stdin)
+ * @param[in] header 1: display the header first
+ *
+ * @return ERR_OK on success, ERR_FILE or ERR_FMT on failure
+ *
+ * @note A record cut off at the end of the file (an interrupted writer)
+ *       is ignored.
+ *
+ * @note Modified in v1.31.0 (2026-10-16): a file that does not start with
+ *       OASIS_REC_MAGIC is rendered by render_text().
+ */
+static int decode_file(const char *path, int header)
+{
+	OASIS_REC_HDR hdr[1];
+	OASIS_REC     rec[1];
+	FILE         *fp;
+	mpz_t         desert;
+	mpz_t         t;
+	uint64_t      cnt = 0;
+	int           ret = ERR_OK;
+	int           c;
+
+	fp = (strcmp(path, "-") == 0)? stdin: fopen(path, "rb");
+	if (fp == NULL) {
+		printf("ERR: Cannot open '%s'\n", path);
+		return ERR_FILE;
+	}
+	c = getc(fp);					// binary: "OASISRES", text: "Prime Oases", "d<n>*"
+	if (c != EOF) ungetc(c, fp);
+	if (c != OASIS_REC_MAGIC[0]) {
+		ret = render_text(fp, header);
+		if (fp != stdin) fclose(fp);
+		return ret;
+	}
+	if ((fread(hdr, sizeof(hdr), 1, fp) != 1) || (oasis_rec_hdr_check(hdr) != 0)) {
+		printf("ERR: '%s' is not a binary result file\n", path);
+		if (fp != stdin) fclose(fp);
+		return ERR_FMT;
+	}
+
+	mpz_init(desert);
+	mpz_init(t);
+	oasis_lcm_get(desert, (int)hdr->desert);		// desert = lcm(1,2,3,...,n)
+	if (header) {
+		printf("# prime_oases d%u x%lu %lu%s\n", hdr->desert, hdr->no, hdr->num,
+		       (hdr->flags & OASIS_REC_HDR_PROVE)? " --prove": "");
+	}
+
+	while (fread(rec, sizeof(rec), 1, fp) == 1) {
+		if (oasis_rec_print(stdout, hdr, desert, rec, t) < 0) {
+			printf("ERR: Invalid record %lu in '%s'\n", cnt, path);
+			ret = ERR_FMT;
+			break;
+		}
+		cnt++;
+	}
+	if (header) {
+		printf("# %lu hits\n", cnt);
+	}
+
+	mpz_clear(desert);
+	mpz_clear(t);
+	if (fp != stdin) fclose(fp);
+
+	return ret;
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char *argv[])
+{
+	int ret = ERR_OK;
+	int header = 0;
+	int i, n = 0;
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (strcmp(argv[i], "--header") == 0) {
+			header = 1;
+		}
+		else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+			printf("ERR: Unknown option '%s'\n", argv[i]);
+			ret = ERR_PNUM;
+		}
+		else {
+			n++;
+		}
+	}
+	if (ret == ERR_OK && n == 0) {
+		ret = ERR_PNUM;
+	}
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (argv[i][0] != '-' || argv[i][1] == '\0') {
+			ret = decode_file(argv[i], header);
+		}
+	}
+
+	if (ret == ERR_PNUM) {
+		disp_usage();
+	}
+
+	return ret;
+}
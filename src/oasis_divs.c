@@ -7,84 +7,247 @@
  * This program provides supplementary information when calculating the least common multiple. 
  * It is specialized for the LCM (1,2,3,...n) format.
  *
+ * @note v1.17.0 (2026-10-16): Incremental LCM list over a range
+ *       1. Specify the range [<from>, <to>] as arguments (defaults to 2..1429,
+ *          the list of results/resultd.txt)
+ *       2. The LCM is kept and multiplied by p only when n is a prime power
+ *          p^e; the primes come from the bitset sieve of oasis_prime_table()
+ *       3. An LCM is converted to decimal once for all n with the same
+ *          value, by -j <threads> threads, and the lines go through a large
+ *          stdout buffer
+ *
+ * @note v1.15.0 (2026-10-16): Take the LCM and its prime powers from the LCM table
+ *       1. The divisor-count sieve and the re-multiplication of all prime
+ *          powers per n are replaced by oasis_lcm_factor()/oasis_lcm_get()
+ *
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <gmp.h>
 
 #define XPT_ON
 #include "xpt.h"
 int xpt_flg = 0;
 
-#define N_MAX (2000)
-#define M_MAX (2000)
+#include "oasis_lcm.h"
+#include "oasis_sieve.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_MEM		(-2)	// Out of memory
+#define ERR_INVL	(-5)	// Invalid value
+
 #define S_MIN (2)	// LCM(1, 2)=2
 #define S_MAX (1429)	// LCM(1,2,3,...1429)=<2^2048
-#define P_MAX (64)	// n^64
+#define S_LIMIT		(1 << 24)	// largest <to>
+#define DIVS_BLOCK	(64)		// LCM values converted together
+#define DIVS_THREADS_MAX (64)
+#define DIVS_OUT_BUF	(1 << 20)	// stdout buffer
+
+/* LCM values of a block and their decimal strings */
+typedef struct {
+	int		 cnt;			// number of values
+	int		 nthr;			// threads converting the block
+	mpz_t		 val[DIVS_BLOCK];
+	char		*str[DIVS_BLOCK];
+} DIVS_BLOCK_T;
 
-static int divs[N_MAX+1] = { 0 };
+/* A thread converting every nthr-th value of a block */
+typedef struct {
+	DIVS_BLOCK_T	*blk;
+	int		 t;
+} DIVS_CONV;
+
+/* Text of the prime power lines "p^e=x" of the current n */
+typedef struct {
+	char		*buf;
+	size_t		 len;
+	size_t		 cap;
+} DIVS_TEXT;
 
 /**
- * @brief Execute Sieve of Eratostheness for prime generation
+ * @brief Append a prime power line to the text
+ *
+ * @return 0 on success, -1 on memory allocation failure
  */
-#define do_sieve() {					\
-	for (int m = 1; m <= M_MAX; m++) {		\
-		for (int n = m; n <= N_MAX; n+= m) {	\
-			divs[n]++; 			\
-		}					\
-	}						\
+static int text_add(DIVS_TEXT *tx, uint32_t p, int e, unsigned long x)
+{
+	char *nb;
+	int   len;
+
+	if (tx->len + 64 > tx->cap) {
+		nb = realloc(tx->buf, tx->cap * 2 + 4096);
+		if (nb == NULL) return -1;
+		tx->buf = nb;
+		tx->cap = tx->cap * 2 + 4096;
+	}
+	len = sprintf(tx->buf + tx->len, "%u^%d=%lu\n", p, e, x);
+	tx->len += len;
+
+	return 0;
 }
 
+/**
+ * @brief Thread of the decimal conversion
+ */
+static void *conv_thread(void *arg)
+{
+	DIVS_CONV    *cv  = (DIVS_CONV *)arg;
+	DIVS_BLOCK_T *blk = cv->blk;
+	int           j;
+
+	for (j = cv->t; j < blk->cnt; j += blk->nthr) {
+		blk->str[j] = mpz_get_str(NULL, 10, blk->val[j]);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Convert the values of a block to decimal
+ *
+ * @param[in,out] blk Block (str[] are set)
+ */
+static void conv_block(DIVS_BLOCK_T *blk)
+{
+	pthread_t tid[DIVS_THREADS_MAX];
+	DIVS_CONV cv[DIVS_THREADS_MAX];
+	int       ok[DIVS_THREADS_MAX];
+	int       t;
+
+	for (t = 0; t < blk->nthr; t++) {
+		cv[t].blk = blk;
+		cv[t].t   = t;
+		ok[t] = (t > 0) && (pthread_create(&tid[t], NULL, conv_thread, &cv[t]) == 0);
+		if (t > 0 && !ok[t]) conv_thread(&cv[t]);	// no thread: here
+	}
+	conv_thread(&cv[0]);
+	for (t = 1; t < blk->nthr; t++) {
+		if (ok[t]) pthread_join(tid[t], NULL);
+	}
+}
 
 /**
  * @brief Calculate and display LCM(1,2,3,...n)
  *
  * Display the value and prime factors of the LCM (1,2,3,...n). 
- * Let n be a value from 2 to 1429.
+ * Let n be a value from <from> to <to>.
+ *
+ * @param[in] from    First n
+ * @param[in] to      Last n
+ * @param[in] threads Threads of the decimal conversion
  *
  * @return Result status
  * @retval 0 Success
- * @retval -1 Failure
+ * @retval ERR_MEM Failure
+ *
+ * @note Modified in v1.17.0 (2026-10-16): incremental over [from, to].
+ *       LCM(1,2,3,...from-1) is taken from oasis_lcm_get(), then the value
+ *       changes only at the prime powers p^e <= to, where it is multiplied
+ *       by p and the line of p is changed (e >= 2) or added (e = 1).
+ *       The values are converted block by block (DIVS_BLOCK values) by
+ *       the threads, and each string is printed for all n of its value.
+ *
+ * @note Modified in v1.15.0 (2026-10-16): the prime powers come from
+ *       oasis_lcm_factor() and the value from the LCM table.
  */
-int make_lcm_list()
+int make_lcm_list(int from, int to, int threads)
 {
-	int s_cnt;	// LCM(1,2,3,...s_cnt)
-	int ret = 0;
-	int n;		// LCM(1,2,3,...n)
-	int x;		// prime x ^ pwr
-	int pwr;	//           ^
-	int i;		// not display "..."(< 7)
-
-	mpz_t lcm;
+	DIVS_BLOCK_T  *blk;
+	DIVS_TEXT      tx[1] = { { NULL, 0, 0 } };
+	uint32_t      *prm;		// primes <= to
+	uint32_t       nprm;
+	uint32_t      *ppw;		// ppw[n] = index + 1 of p if n = p^e, else 0
+	unsigned long *pw;		// current power of each prime
+	int           *ex;		// current exponent of each prime
+	uint32_t       np = 0;		// primes <= n
+	uint32_t       j, k;
+	unsigned long  q;
+	mpz_t          lcm;
+	int            s_cnt;		// LCM(1,2,3,...s_cnt)
+	int            s_blk;		// first n of the block
+	int            ret = ERR_OK;
+	int            i;		// not display "..."(< 7)
+	int            b;
+
+	prm = oasis_prime_table((uint32_t)to, &nprm);
+	ppw = calloc((size_t)to + 1, sizeof(uint32_t));
+	pw  = calloc((size_t)nprm + 1, sizeof(unsigned long));
+	ex  = calloc((size_t)nprm + 1, sizeof(int));
+	blk = calloc(1, sizeof(DIVS_BLOCK_T));
+	if ((prm == NULL) || (ppw == NULL) || (pw == NULL) || (ex == NULL) || (blk == NULL)) {
+		fprintf(stderr, "ERR: out of memory.\n");
+		free(prm);
+		free(ppw);
+		free(pw);
+		free(ex);
+		free(blk);
+		return ERR_MEM;
+	}
+	for (j = 0; j < nprm; j++) {			// mark the prime powers
+		for (q = prm[j]; q <= (unsigned long)to; q *= prm[j]) {
+			ppw[q] = j + 1;
+		}
+	}
+	blk->nthr = threads;
+	for (b = 0; b < DIVS_BLOCK; b++) {
+		mpz_init(blk->val[b]);
+	}
+
+	/*--- state of n = from - 1 ---*/
 	mpz_init(lcm);
+	oasis_lcm_get(lcm, from - 1);			// lcm = LCM(1,2,3,...from-1)
+	for (np = 0; np < nprm && prm[np] < (uint32_t)from; np++) {
+		for (pw[np] = prm[np], ex[np] = 1; pw[np] <= (unsigned long)(from - 1) / prm[np];
+		     pw[np] *= prm[np], ex[np]++);
+		if (text_add(tx, prm[np], ex[np], pw[np]) != 0) ret = ERR_MEM;
+	}
 
-	for (s_cnt = S_MIN; s_cnt <= S_MAX; s_cnt++) {
-		/*--- calc part ---*/
-		mpz_set_ui(lcm, 1);			//    lcm = 1;
-		for (n = 1; n <= s_cnt; n++) {		//    find prime	
-			if (divs[n] == 2) {		//      in 1,2,3,...s_cnt
-				x = n;
-				for (pwr = 1; pwr < P_MAX; pwr++) {
-					x *= n;					// x * x *...
-					if (x > s_cnt) {			//    over ?
-						x /= n;				// previos value
-						printf("%d^%d=%d\n", n, pwr, x);
-						mpz_mul_ui(lcm, lcm, x);	// lcm = lcm * x
-						break;
-					}
-				}
-				if (pwr == P_MAX) {
-					fprintf(stderr, "ERR: p overflow.\n");	// Impossible
-					ret = -1;
+	for (s_blk = from; s_blk <= to && ret == ERR_OK; s_blk = s_cnt) {
+		/*--- calc part: the values of the block ---*/
+		blk->cnt = 0;
+		for (s_cnt = s_blk; s_cnt <= to; s_cnt++) {
+			if (ppw[s_cnt] || s_cnt == s_blk) {	// new value?
+				if (blk->cnt == DIVS_BLOCK) break;
+				if (ppw[s_cnt]) {
+					mpz_mul_ui(lcm, lcm, prm[ppw[s_cnt] - 1]);	// lcm = lcm * p
 				}
+				mpz_set(blk->val[blk->cnt++], lcm);
 			}
 		}
+		conv_block(blk);
 
 		/*--- disp part ---*/
-		if (ret == 0) {			// ok?
+		for (s_cnt = s_blk, b = -1; s_cnt <= to && ret == ERR_OK; s_cnt++) {
+			if (ppw[s_cnt] || s_cnt == s_blk) {
+				if (b + 1 == blk->cnt) break;	// next block
+				b++;
+			}
+			if ((k = ppw[s_cnt]) != 0) {		// s_cnt = p^e
+				k--;
+				if (k == np) {			//    new prime
+					pw[np] = prm[np];
+					ex[np] = 1;
+					np++;
+					ret = text_add(tx, prm[k], 1, prm[k]);
+				}
+				else {				//    higher power: rebuild
+					pw[k] *= prm[k];
+					ex[k]++;
+					for (tx->len = 0, j = 0; j < np && ret == ERR_OK; j++) {
+						ret = text_add(tx, prm[j], ex[j], pw[j]);
+					}
+				}
+			}
+			fwrite(tx->buf, 1, tx->len, stdout);
 			if (s_cnt > 6) {
-				gmp_printf("lcm(1,2,3,...%d)=%Zd\n\n", s_cnt, lcm);
+				printf("lcm(1,2,3,...%d)=%s\n\n", s_cnt, blk->str[b]);
 			}
 			else {
 				printf("lcm(");
@@ -92,27 +255,127 @@ int make_lcm_list()
 					printf("%d", i);
 					if (i < s_cnt) printf(",");
 				}
-				gmp_printf(")=%Zd\n\n", lcm);
+				printf(")=%s\n\n", blk->str[b]);
 			}
 		}
+		for (b = 0; b < blk->cnt; b++) {
+			free(blk->str[b]);
+			blk->str[b] = NULL;
+		}
+	}
+	if (ret != ERR_OK) {
+		fprintf(stderr, "ERR: out of memory.\n");
 	}
 
 	mpz_clear(lcm);
+	for (b = 0; b < DIVS_BLOCK; b++) {
+		mpz_clear(blk->val[b]);
+	}
+	free(blk);
+	free(tx->buf);
+	free(prm);
+	free(ppw);
+	free(pw);
+	free(ex);
 
 	return ret;
 }
 
+/**
+ * @brief Display usage information for the oasis_divs command
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_divs [-j <threads>] [<from> <to>]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <from>   First n of LCM(1,2,3,...,n) (optional, defaults to %d)\n", S_MIN);
+	printf("       <to>     Last n of LCM(1,2,3,...,n) (optional, defaults to %d)\n", S_MAX);
+	printf("---< OPTIONS:\n");
+	printf("       -j <threads>  Threads of the decimal conversion (1..%d, defaults to the number of CPUs)\n",
+	       DIVS_THREADS_MAX);
+	printf("---< EXAMPLES:\n");
+	printf("       oasis_divs                  # results/resultd.txt\n");
+	printf("       oasis_divs 2 20000          # up to LCM(1,2,3,...,20000)\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Validate a number argument
+ *
+ * @return Value, or -1 if str is not a number of 1..S_LIMIT
+ */
+static int get_number(const char *str)
+{
+	const char *p;
+
+	for (p = str; *p; p++) {
+		if (!isdigit((unsigned char)*p)) return -1;
+	}
+	if ((p == str) || (p - str > 9) || (atoi(str) < 1) || (atoi(str) > S_LIMIT)) return -1;
+
+	return atoi(str);
+}
+
 /**
  * @brief Main entry point
+ *
+ * @note Modified in v1.17.0 (2026-10-16): [<from> <to>] and -j <threads>
  */
-int main()
+int main(int argc, char *argv[])
 {
-	int ret;
+	static char out_buf[DIVS_OUT_BUF];
+	int ret = ERR_OK;
+	int from = S_MIN;
+	int to   = S_MAX;
+	int threads = 0;
+	int n = 0;
+	int val[2];
+	int i;
 
 	XPT_INIT();
 
-	do_sieve();
-	ret = make_lcm_list();
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threads = get_number(argv[++i]);
+			if (threads < 1 || threads > DIVS_THREADS_MAX) {
+				printf("ERR: -j <threads> must be 1..%d\n", DIVS_THREADS_MAX);
+				ret = ERR_INVL;
+			}
+		}
+		else if (n < 2 && (val[n] = get_number(argv[i])) >= 0) {
+			n++;
+		}
+		else {
+			printf("ERR: Invalid parameter '%s'\n", argv[i]);
+			ret = ERR_PNUM;
+		}
+	}
+	if (ret == ERR_OK && n == 1) {
+		printf("ERR: <from> needs <to>\n");
+		ret = ERR_PNUM;
+	}
+	if (ret == ERR_OK && n == 2) {
+		from = val[0];
+		to   = val[1];
+		if (from < S_MIN || from > to) {
+			printf("ERR: %d <= <from> <= <to> <= %d\n", S_MIN, S_LIMIT);
+			ret = ERR_INVL;
+		}
+	}
+	if (threads == 0) {
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		if (threads < 1) threads = 1;
+		if (threads > DIVS_THREADS_MAX) threads = DIVS_THREADS_MAX;
+	}
+
+	if (ret) {
+		disp_usage();
+	}
+	else {
+		setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+		ret = make_lcm_list(from, to, threads);
+	}
 
 	return ret;
 }
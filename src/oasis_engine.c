@@ -0,0 +1,1605 @@
+/**
+ * @file oasis_engine.c
+ * @brief Scan engine of liboasis: the oasis candidates pit +- 1 of a run of deserts.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The scan loops of the commands (sieve, batched screen, primality test,
+ * reorder ring of the threads) moved here; see oasis_engine.h.
+ *
+ * @note v1.32.1 (2026-10-16): The stop and the progress request are bits of one
+ *       flag word (OASIS_ENGINE.req), so a poll of the scan loop is one
+ *       relaxed load, decoded only when it is not zero
+ *
+ * @note v1.29.0 (2026-10-16): Pipelined scan (OASIS_ENGINE.pipeline)
+ *       1. A sieve thread cuts the survivors into batches, a pool of PRP
+ *          workers screens and tests them, the calling thread writes the
+ *          hits in order: a slow hit callback no longer stalls the sieve
+ *       2. The stages pass the batches through lock-free queues
+ *          (oasis_queue.h); their depths and the waits of each stage are
+ *          reported by stat() (OASIS_ENG_PIPE)
+ *
+ * @note v1.28.0 (2026-10-16): Work-stealing parallel scan
+ *       1. Each thread carves a batch of chunks into its own deque and
+ *          scans it from the front; an idle thread steals the back half
+ *          of the fullest deque
+ *       2. The size of a chunk follows the measured ns per desert (the
+ *          hits cost far more than the rejects) and shrinks at the end of
+ *          the scan, so no thread is left with a long last chunk
+ *
+ * @note v1.27.0 (2026-10-16): Add oasis_engine_shard() (the i-th of n slices of the deserts)
+ *
+ * @note v1.25.0 (2026-10-16): pit is made only for the deserts with a sieve survivor
+ *
+ * @note v1.24.0 (2026-10-16): The scan loop reads stop with a relaxed load, stat() on request
+ *
+ * @note v1.22.0 (2026-10-16): Count the phases with perf_event (OASIS_ENGINE.perf)
+ *
+ * @note v1.21.0 (2026-10-16): Add XPT_PRF trace points (chunk, screen, test, output)
+ *
+ * @note v1.20.0 (2026-10-16): Add the progress of a running scan
+ *       1. Lock-free counters per thread (ENG_CTR), summed by the reporting thread
+ *       2. stat() every stat_sec seconds: rates, fraction done and ETA
+ *
+ * @note v1.19.0 (2026-10-16): Add the time split of a scan (ns_sieve, ns_prp, ns_out)
+ *
+ * @note v1.18.0 (2026-10-16): Add scan engine (liboasis)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "oasis_engine.h"
+#include "oasis_sieve.h"
+#include "oasis_prove.h"
+#include "oasis_prp.h"
+#include "oasis_queue.h"
+
+#define XPT_ON
+#include "xpt.h"
+
+#define ENG_POLL		(100)			// deserts between polls
+#define ENG_REQ_STOP		(0x01)			// req: oasis_engine_stop()
+#define ENG_REQ_STAT		(0x02)			// req: oasis_engine_stat_now()
+#define ENG_REQ(eng)		atomic_load_explicit(&(eng)->req, memory_order_relaxed)
+#define ENG_CHUNK_PER_THREAD	(16)			// chunks per thread before the cost is measured
+#define ENG_CHUNK_MIN		(256)			// deserts per chunk
+#define ENG_CHUNK_MAX		(OASIS_SIEVE_SEG_BITS)
+#define ENG_CHUNK_NS		(20 * 1000 * 1000)	// ns of scan per chunk (adapted to the measured cost)
+#define ENG_CHUNK_TAIL		(2)			// the rest is cut into >= TAIL chunks per thread
+#define ENG_DEQ			(4)			// chunks carved into a deque at a time
+#define ENG_RING(T)		((T) * 4)		// chunks buffered for reordering
+#define ENG_BATCH		(2 * OASIS_PRP_LANES)	// candidates per batched screen
+#define ENG_PIPE_CAND		(4 * ENG_BATCH)		// survivors per batch of the pipeline
+#define ENG_PIPE_K		(4096)			// deserts per batch at most
+#define ENG_PIPE_RING(T)	((T) * 8 + 8)		// batches in flight (sieved, not written)
+#define ENG_PIPE_SPIN		(16)			// sched_yield() before sleeping in a wait
+#define ENG_PIPE_NAP		(50 * 1000)		// ns of a sleep in a wait
+#define ENG_EULER_GAMMA		(0.5772156649015329)
+
+/* A hit of a chunk, x is rebuilt by the writer */
+typedef struct {
+	uint64_t	k;
+	int		sign;		// OASIS_SIEVE_M1/P1
+	int		res;		// OASIS_PROBABLE/PRIME
+} ENG_HIT;
+
+/*
+ * Counters of a scanning thread.  Each thread only writes its own slot (one
+ * cache line) with relaxed stores, the reporting thread reads all of them:
+ * no lock and no shared cache line in the scan loop.
+ */
+typedef struct {
+	_Atomic uint64_t desert;		// deserts scanned
+	_Atomic uint64_t cand;			// candidates (struck out by the sieve included)
+	_Atomic uint64_t pass;			// sieve survivors
+	_Atomic uint64_t hit;			// primes (before the reordering)
+	_Atomic uint64_t ns_scan;		// ns in scan_deserts()
+	_Atomic uint64_t ns_scr;		// ns in the screen
+	_Atomic uint64_t ns_test;		// ns in the primality tests (serial: hit callbacks included)
+	_Atomic uint64_t ns_idle;		// ns waiting for the next stage (pipeline)
+} __attribute__((aligned(64))) ENG_CTR;
+
+/**
+ * @brief Add to a counter of the calling thread's own slot
+ */
+static inline void ctr_add(_Atomic uint64_t *c, uint64_t v)
+{
+	atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + v, memory_order_relaxed);
+}
+
+/**
+ * @brief Read a counter of any slot
+ */
+static inline uint64_t ctr_get(_Atomic uint64_t *c)
+{
+	return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+/* mpz scratch of a scanning thread */
+typedef struct {
+	mpz_t		pit;			// pit of desert k_pit (made only for survivors)
+	uint64_t	k_pit;
+	int		ncand;			// candidates in the batch
+	mpz_t		cand[ENG_BATCH];	// sieve survivors pit+-1
+	uint64_t	k[ENG_BATCH];		// desert of cand[]
+	int		sign[ENG_BATCH];	// OASIS_SIEVE_M1/P1
+	int		res[ENG_BATCH];		// result of the screen
+	OASIS_PRP	pp[1];			// batched screen scratch
+	ENG_CTR	       *ctr;			// counters of the thread
+	uint64_t	k_pub;			// deserts before k_pub are in ctr
+	uint64_t	t_pub;			// ns_scan is in ctr up to t_pub
+	OASIS_PERF	pf[1];			// perf_event counters of the thread (perf)
+} ENG_WORK;
+
+#define ENG_CHUNK_FREE	(0)
+#define ENG_CHUNK_QUEUED (1)		// in the deque of a thread
+#define ENG_CHUNK_BUSY	(2)
+#define ENG_CHUNK_DONE	(3)
+
+/* A chunk of deserts scanned by one thread, a slot of the reorder ring */
+typedef struct {
+	int		state;		// ENG_CHUNK_FREE/QUEUED/BUSY/DONE
+	uint64_t	no;		// chunk number
+	uint64_t	k_lo;		// first desert
+	uint64_t	k_hi;		// end of the deserts (exclusive)
+	uint64_t	k_end;		// first desert not scanned (k_hi if complete)
+	ENG_HIT	       *hit;		// hits of the chunk, in order
+	size_t		cnt;
+	size_t		cap;
+	int		err;		// out of memory
+	ENG_HIT	       *surv;		// sieve survivors of a batch (pipeline, res unused)
+	int		nsurv;
+} ENG_CHUNK;
+
+/*
+ * Deque of a scanning thread: numbers of carved chunks, in order of k.
+ * The owner takes the front, a thief the back half (guarded by ENG_RUN.mtx,
+ * taken once per chunk of ENG_CHUNK_NS).
+ */
+typedef struct {
+	uint64_t	c[ENG_DEQ];
+	int		head;		// c[head % ENG_DEQ] is the front
+	int		cnt;
+} ENG_DEQUE;
+
+/* State of oasis_engine_run() shared by the writer and the workers */
+typedef struct {
+	OASIS_ENGINE   *eng;
+	OASIS_PROVE	prv[1];		// factorization of d<prove_n>
+	OASIS_SIEVE    *sv;		// sieve primes (NULL: no sieve)
+	time_t		due;		// time of the next sync()
+	mpz_t		x;		// hit rebuilt by the writer
+	OASIS_PERF     *pf;		// counters of the thread of the callbacks
+	/* parallel scan */
+	uint64_t	chunk;		// deserts per chunk until the cost is measured
+	uint64_t	next;		// number of the next chunk to carve
+	uint64_t	k_next;		// first desert not carved
+	double		ns_k;		// measured ns per desert (0: not yet)
+	uint64_t	steals;		// chunks taken from another deque
+	ENG_DEQUE      *deq;		// deques, one per thread
+	uint64_t	nring;		// slots of the reorder ring
+	ENG_CHUNK      *ring;
+	pthread_mutex_t	mtx;
+	pthread_cond_t	done;		// a chunk is done
+	pthread_cond_t	freed;		// a slot is free
+	/* pipelined scan (the ring above holds the batches) */
+	OASIS_QUEUE	q_prp;		// sieved batches, to the PRP workers
+	OASIS_QUEUE	q_out;		// tested batches, to the writer
+	_Atomic uint64_t out;		// batches written: batch s may be sieved if s < out + nring
+	_Atomic uint64_t nbatch;	// batches sieved
+	_Atomic int	sieved;		// the sieve thread is done (nbatch is final)
+	_Atomic uint32_t q_prp_max;	// deepest queues seen
+	_Atomic uint32_t q_out_max;
+	uint64_t	ns_out_idle;	// ns the writer waited
+	int		nprp;		// PRP workers running
+	/* progress */
+	ENG_CTR	       *ctr;		// counters, one slot per thread
+	int		nctr;
+	int		nwk;		// slots taken (pipeline: slot 0 is the sieve thread)
+	double		dens;		// expected primes per sieve survivor (0: no sieve)
+	uint64_t	t0;		// ns at the start of the run
+	uint64_t	stat_due;	// ns of the next stat()
+	uint64_t	last_t;		// ns, candidates and hits of the last stat()
+	uint64_t	last_cand;
+	uint64_t	last_hit;
+} ENG_RUN;
+
+/**
+ * @brief Initialize the scratch of a scanning thread
+ */
+static void work_init(ENG_WORK *wk)
+{
+	int i;
+
+	mpz_init(wk->pit);
+	for (i = 0; i < ENG_BATCH; i++) {
+		mpz_init(wk->cand[i]);
+	}
+	wk->ncand = 0;
+	wk->ctr   = NULL;
+	oasis_prp_init(wk->pp, OASIS_PRP_AUTO);
+	memset(wk->pf, 0, sizeof(wk->pf));		// not counted until oasis_perf_open()
+	wk->pf->phase = OASIS_PERF_NONE;
+}
+
+/**
+ * @brief Count the phases of the calling thread (OASIS_ENGINE.perf)
+ */
+static void work_perf_open(ENG_WORK *wk, OASIS_ENGINE *eng)
+{
+	if (eng->perf) oasis_perf_open(wk->pf);
+}
+
+/**
+ * @brief Add the counts of the calling thread to the engine
+ *
+ * @note The caller holds the lock of a parallel scan.
+ */
+static void work_perf_close(ENG_WORK *wk, OASIS_ENGINE *eng)
+{
+	if (!eng->perf) return;
+	oasis_perf_close(wk->pf);
+	oasis_perf_add(eng->pf, wk->pf->cnt);
+}
+
+/**
+ * @brief Release the scratch of a scanning thread
+ */
+static void work_clear(ENG_WORK *wk)
+{
+	int i;
+
+	mpz_clear(wk->pit);
+	for (i = 0; i < ENG_BATCH; i++) {
+		mpz_clear(wk->cand[i]);
+	}
+	oasis_prp_clear(wk->pp);
+}
+
+/**
+ * @brief Monotonic time in ns
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Number of candidates of the deserts [a, b)
+ *
+ * @details The try counters follow from the position of the scan, so the
+ *          count of a stopped scan is exact whatever was screened ahead.
+ *          eng->dup must be set (oasis_engine_run() sets it).
+ *
+ * @note Modified in v1.32.1 (2026-10-16): public, for the deserts served
+ *       from the cache by prime_oases.
+ */
+uint64_t oasis_engine_tries(const OASIS_ENGINE *eng, uint64_t a, uint64_t b)
+{
+	uint64_t t;
+
+	if (b <= a) return 0;
+	t = (eng->dup)? (a == 0): b - a;			// pit - 1
+	if (a == 0 && (eng->flags & OASIS_ENG_SKIP_FIRST)) t--;
+	t += b - a;						// pit + 1
+	if (b == eng->num && (eng->flags & OASIS_ENG_SKIP_LAST)) t--;
+
+	return t;
+}
+
+/**
+ * @brief Primality test of a candidate that passed the screen
+ *
+ * @return OASIS_COMPOSITE, OASIS_PROBABLE or OASIS_PRIME
+ */
+static int test_prime(ENG_RUN *run, mpz_t x, int sign)
+{
+	if (!run->eng->prove) return mpz_probab_prime_p(x, 25);
+
+	return (sign == OASIS_SIEVE_M1)? oasis_prove_m1(run->prv, x): oasis_prove_p1(run->prv, x);
+}
+
+/**
+ * @brief Count a hit and hand it to the callback
+ *
+ * @return 1 if the callback stopped the scan, 0 otherwise
+ */
+static int deliver(ENG_RUN *run, uint64_t k, int sign, mpz_srcptr x, int res)
+{
+	OASIS_ENGINE *eng = run->eng;
+	uint64_t      t0;
+	int           flags, ret, ph;
+
+	flags = (eng->prove)? ((res == OASIS_PRIME)? OASIS_HIT_PROVEN: OASIS_HIT_PROBABLE): 0;
+	if (sign == OASIS_SIEVE_M1) {
+		eng->m1_hit = k + 1;
+	}
+	else if (eng->m1_hit == k + 1) {
+		flags |= OASIS_HIT_TWIN;
+		eng->st->twin_cnt++;
+	}
+	eng->st->hit_cnt++;
+	eng->st->prv_cnt += (res == OASIS_PRIME);
+
+	if (eng->hit == NULL) return 0;
+	XPT_PRF_B(XPT_EV_OUT, (uint32_t)k);
+	ph  = oasis_perf_phase(run->pf, OASIS_PERF_OUT);
+	t0  = now_ns();
+	ret = eng->hit(eng->arg, eng->n, k, (sign == OASIS_SIEVE_M1)? -1: 1, x, flags);
+	eng->ns_out += now_ns() - t0;
+	oasis_perf_phase(run->pf, ph);
+	XPT_PRF_E(XPT_EV_OUT, (uint32_t)ret);
+	if (ret) {
+		eng->halted = 1;
+		eng->part   = (sign == OASIS_SIEVE_M1);
+		eng->k_end  = (eng->part)? k: k + 1;
+		oasis_engine_stop(eng);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Screen the batch of candidates and pass on the primes
+ *
+ * @param[in,out] run Scan
+ * @param[in,out] wk  Scratch of the calling thread (the batch is emptied)
+ * @param[out]    ck  Chunk of the hits (NULL: deliver the hits now)
+ *
+ * @return 1 if a hit stopped the scan, 0 otherwise
+ *
+ * @details The candidates are kept in scan order, so the hits are the
+ *          same as testing them one by one.
+ */
+static int flush_batch(ENG_RUN *run, ENG_WORK *wk, ENG_CHUNK *ck)
+{
+	ENG_HIT *nh;
+	uint64_t t0 = now_ns();
+	uint64_t t1, hit = 0;
+	int      i, ret, ph;
+
+	ph = oasis_perf_phase(wk->pf, OASIS_PERF_PRP);
+	XPT_PRF_B(XPT_EV_SCREEN, (uint32_t)wk->ncand);
+	oasis_prp_screen(wk->pp, wk->cand, wk->ncand, wk->res);
+	XPT_PRF_E(XPT_EV_SCREEN, (uint32_t)wk->ncand);
+	t1 = now_ns();
+	for (i = 0; i < wk->ncand; i++) {
+		if (!wk->res[i]) continue;			// composite
+		XPT_PRF_B(XPT_EV_TEST, (uint32_t)wk->k[i]);
+		ret = test_prime(run, wk->cand[i], wk->sign[i]);
+		XPT_PRF_E(XPT_EV_TEST, (uint32_t)ret);
+		if (!ret) continue;
+		hit++;
+		if (ck == NULL) {
+			if (deliver(run, wk->k[i], wk->sign[i], wk->cand[i], ret)) break;
+			continue;
+		}
+		if (ck->cnt == ck->cap) {
+			nh = realloc(ck->hit, (ck->cap * 2 + 64) * sizeof(ENG_HIT));
+			if (nh == NULL) {
+				ck->err = 1;
+				oasis_engine_stop(run->eng);
+				break;
+			}
+			ck->hit = nh;
+			ck->cap = ck->cap * 2 + 64;
+		}
+		ck->hit[ck->cnt].k    = wk->k[i];
+		ck->hit[ck->cnt].sign = wk->sign[i];
+		ck->hit[ck->cnt].res  = ret;
+		ck->cnt++;
+	}
+	ctr_add(&wk->ctr->pass, wk->ncand);
+	ctr_add(&wk->ctr->hit, hit);
+	ctr_add(&wk->ctr->ns_scr, t1 - t0);
+	ctr_add(&wk->ctr->ns_test, now_ns() - t1);
+	wk->ncand = 0;
+	oasis_perf_phase(wk->pf, ph);
+
+	return run->eng->halted;
+}
+
+/**
+ * @brief Call sync() with the counters of the deserts before k_next
+ */
+static void sync_at(ENG_RUN *run, uint64_t k_next)
+{
+	OASIS_ENGINE *eng = run->eng;
+
+	eng->st->try_cnt = eng->try0 + oasis_engine_tries(eng, eng->k_start, k_next);
+	eng->sync(eng->arg, k_next);
+	run->due = time(NULL) + eng->sync_sec;
+}
+
+/**
+ * @brief Publish the deserts before k and the scan time to the thread's counters
+ */
+static void publish(ENG_RUN *run, ENG_WORK *wk, uint64_t k)
+{
+	uint64_t now = now_ns();
+
+	ctr_add(&wk->ctr->desert, k - wk->k_pub);
+	ctr_add(&wk->ctr->cand, oasis_engine_tries(run->eng, wk->k_pub, k));
+	ctr_add(&wk->ctr->ns_scan, now - wk->t_pub);
+	wk->k_pub = k;
+	wk->t_pub = now;
+}
+
+/**
+ * @brief Depths of the queues and waits of the stages of a pipelined scan
+ *
+ * @param[in]  run Scan
+ * @param[out] pi  Stages (all 0 if the scan is not pipelined)
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static void pipe_stat(ENG_RUN *run, OASIS_ENG_PIPE *pi)
+{
+	uint64_t idle = 0;
+	int      i;
+
+	memset(pi, 0, sizeof(*pi));
+	if (run->nprp == 0) return;
+	for (i = 1; i < run->nctr; i++) {
+		idle += ctr_get(&run->ctr[i].ns_idle);
+	}
+	pi->prp         = run->nprp;
+	pi->batches     = atomic_load_explicit(&run->nbatch, memory_order_relaxed);
+	pi->q_prp       = oasis_queue_depth(&run->q_prp);
+	pi->q_out       = oasis_queue_depth(&run->q_out);
+	pi->q_prp_max   = atomic_load_explicit(&run->q_prp_max, memory_order_relaxed);
+	pi->q_out_max   = atomic_load_explicit(&run->q_out_max, memory_order_relaxed);
+	pi->sieve_stall = ctr_get(&run->ctr[0].ns_idle) * 1e-9;
+	pi->prp_idle    = idle * 1e-9;
+	pi->out_idle    = run->ns_out_idle * 1e-9;
+}
+
+/**
+ * @brief Sum the counters of the threads and call stat()
+ *
+ * @param[in,out] run  Scan
+ * @param[in]     done 1: the last report of the run
+ *
+ * @details The ETA is the thread time of the candidates left divided by the
+ *          number of busy threads.  The thread time of a candidate is the
+ *          scan loop, plus the screen times the measured sieve survival,
+ *          plus the test of a hit times the expected density of primes,
+ *          e^gamma * ln(L) / ln(x) per survivor of a sieve up to L (Mertens).
+ */
+static void report(ENG_RUN *run, int done)
+{
+	OASIS_ENGINE  *eng = run->eng;
+	OASIS_ENG_PROG pg[1];
+	uint64_t       desert = 0, pass = 0, ns_scan = 0, ns_scr = 0, ns_test = 0;
+	uint64_t       now = now_ns();
+	uint64_t       total, rest;
+	double         dt, per, par;
+	int            i;
+
+	memset(pg, 0, sizeof(pg));
+	for (i = 0; i < run->nctr; i++) {
+		desert   += ctr_get(&run->ctr[i].desert);
+		pg->cand += ctr_get(&run->ctr[i].cand);
+		pass     += ctr_get(&run->ctr[i].pass);
+		pg->hit  += ctr_get(&run->ctr[i].hit);
+		ns_scan  += ctr_get(&run->ctr[i].ns_scan);
+		ns_scr   += ctr_get(&run->ctr[i].ns_scr);
+		ns_test  += ctr_get(&run->ctr[i].ns_test);
+	}
+	pg->sec    = (now - run->t0) * 1e-9;
+	pg->k_done = eng->k_start + desert;
+	pg->num    = eng->num;
+	dt = (now - run->last_t) * 1e-9;
+	if (dt > 0) {
+		pg->cand_rate = (pg->cand - run->last_cand) / dt;
+		pg->hit_rate  = (pg->hit  - run->last_hit)  / dt;
+	}
+	pg->surv    = (pg->cand)? (double)pass / pg->cand: 0.0;
+	pg->density = (run->dens > 0)? pg->surv * run->dens:
+		      (pg->cand)?      (double)pg->hit / pg->cand: 0.0;
+	total = oasis_engine_tries(eng, eng->k_start, eng->num);
+	rest  = (total > pg->cand)? total - pg->cand: 0;
+	pg->hits_left = rest * pg->density;
+	pg->eta  = (done)? 0.0: -1.0;
+	pg->done = done;
+	pg->req  = (done == 0 && (atomic_fetch_and(&eng->req, ~ENG_REQ_STAT) & ENG_REQ_STAT));
+	pipe_stat(run, pg->pipe);
+	if (!done && pg->cand && pass && ns_scan) {
+		per  = (ns_scan > ns_scr + ns_test)?			// scan loop, sieve
+		       (double)(ns_scan - ns_scr - ns_test) / pg->cand: 0.0;	//   (published apart)
+		per += pg->surv * ((double)ns_scr / pass);		// screen
+		per += (pg->hit)? pg->density * ((double)ns_test / pg->hit):	// test of a hit
+				  (double)ns_test / pg->cand;
+		par  = (double)ns_scan / (now - run->t0);		// busy threads
+		pg->eta = rest * per / ((par > 0.01)? par: 0.01) * 1e-9;
+	}
+
+	run->last_t    = now;
+	run->last_cand = pg->cand;
+	run->last_hit  = pg->hit;
+	run->stat_due  = now + (uint64_t)eng->stat_sec * 1000000000;
+	eng->stat(eng->arg, pg);
+}
+
+/**
+ * @brief Call stat() if it is due or asked for (oasis_engine_stat_now())
+ *
+ * @param[in,out] run Scan
+ * @param[in]     req eng->req as read by the caller (ENG_REQ())
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the request is passed in, so a
+ *       poll reads the flag word once.
+ */
+static void report_due(ENG_RUN *run, int req)
+{
+	OASIS_ENGINE *eng = run->eng;
+
+	if (eng->stat
+	&&  ((req & ENG_REQ_STAT)
+	||   (eng->stat_sec && now_ns() >= run->stat_due))) {
+		report(run, 0);
+	}
+}
+
+/**
+ * @brief Add a candidate to the batch
+ *
+ * @return 1 if a hit stopped the scan, 0 otherwise
+ *
+ * @note Modified in v1.25.0 (2026-10-16): pit is moved to desert k here,
+ *       so the deserts the sieve strikes out cost no mpz arithmetic.
+ */
+static int add_cand(ENG_RUN *run, ENG_WORK *wk, ENG_CHUNK *ck, uint64_t k, int sign)
+{
+	if (wk->k_pit != k) {				// pit += (k - k_pit) * step;
+		mpz_addmul_ui(wk->pit, run->eng->step, k - wk->k_pit);
+		wk->k_pit = k;
+	}
+	if (sign == OASIS_SIEVE_M1) mpz_sub_ui(wk->cand[wk->ncand], wk->pit, 1);
+	else                        mpz_add_ui(wk->cand[wk->ncand], wk->pit, 1);
+	wk->k[wk->ncand]    = k;
+	wk->sign[wk->ncand] = sign;
+	if (++wk->ncand == ENG_BATCH) return flush_batch(run, wk, ck);
+
+	return 0;
+}
+
+/**
+ * @brief Scan a part of the deserts
+ *
+ * @param[in,out] run  Scan
+ * @param[in]     k_lo First desert to scan
+ * @param[in]     k_hi End of the deserts to scan (exclusive)
+ * @param[in,out] sv   Sieve (NULL: no sieve)
+ * @param[in,out] wk   Scratch of the calling thread
+ * @param[out]    ck   Chunk of the hits (NULL: serial scan, deliver the hits)
+ *
+ * @return First desert that has not been scanned; k_hi unless stopped.
+ *
+ * @details The serial scan polls and syncs every ENG_POLL deserts, a
+ *          worker only watches the stop flag.  The deserts are counted
+ *          with k alone; pit is made by add_cand() for the survivors.
+ *
+ * @note Modified in v1.25.0 (2026-10-16): pit += step is no longer done
+ *       for every desert.
+ */
+static uint64_t scan_loop(ENG_RUN *run, uint64_t k_lo, uint64_t k_hi,
+		OASIS_SIEVE *sv, ENG_WORK *wk, ENG_CHUNK *ck)
+{
+	OASIS_ENGINE *eng = run->eng;
+	uint64_t      k;
+	uint64_t      k_poll = k_lo;			// next desert to poll at
+	int           req;
+	uint64_t      last = (eng->flags & OASIS_ENG_SKIP_LAST)? eng->num - 1: UINT64_MAX;
+	int           first = (eng->flags & OASIS_ENG_SKIP_FIRST) != 0;
+
+	mpz_mul_ui(wk->pit, eng->step, k_lo);		// pit = start + k_lo * step;
+	mpz_add(wk->pit, wk->pit, eng->start);
+	wk->k_pit = k_lo;
+
+	for (k = k_lo; k < k_hi; k++) {
+
+	   if (k == k_poll) {
+	      k_poll += ENG_POLL;
+	      publish(run, wk, k);
+	      req = ENG_REQ(eng);			// the one load of the poll
+	      if (req & ENG_REQ_STOP) break;
+	      if (ck == NULL) report_due(run, req);
+	      if (ck == NULL && eng->poll && eng->poll(eng->arg)) {
+		 oasis_engine_stop(eng);
+		 break;
+	      }
+	      if (ck == NULL && eng->sync && eng->sync_sec && time(NULL) >= run->due) {
+		 if (flush_batch(run, wk, ck)) return k;
+		 sync_at(run, k);
+	      }
+	   }
+
+	   /*--- m1 ---*/
+	   if (!(k == 0 && first) && !(eng->dup && k > 0)) {	// m1 != previous p1
+	      if ((sv == NULL || oasis_sieve_pass(sv, k, OASIS_SIEVE_M1))
+	      &&  add_cand(run, wk, ck, k, OASIS_SIEVE_M1)) return k;
+	   }
+
+	   /*--- p1 ---*/
+	   if (k != last) {
+	      if ((sv == NULL || oasis_sieve_pass(sv, k, OASIS_SIEVE_P1))
+	      &&  add_cand(run, wk, ck, k, OASIS_SIEVE_P1)) return k;
+	   }
+	}
+	flush_batch(run, wk, ck);			// the rest (k excluded)
+
+	return k;
+}
+
+/**
+ * @brief Scan a part of the deserts and count them (see scan_loop())
+ */
+static uint64_t scan_deserts(ENG_RUN *run, uint64_t k_lo, uint64_t k_hi,
+		OASIS_SIEVE *sv, ENG_WORK *wk, ENG_CHUNK *ck)
+{
+	uint64_t k;
+
+	wk->k_pub = k_lo;
+	wk->t_pub = now_ns();
+	oasis_perf_phase(wk->pf, OASIS_PERF_SIEVE);
+	k = scan_loop(run, k_lo, k_hi, sv, wk, ck);
+	oasis_perf_phase(wk->pf, OASIS_PERF_NONE);
+	publish(run, wk, k);
+
+	return k;
+}
+
+/**
+ * @brief Size of the next chunk
+ *
+ * @details ENG_CHUNK_NS of scan at the measured cost per desert, and at
+ *          most 1/(ENG_CHUNK_TAIL * threads) of the deserts left, so the
+ *          last chunks get short and the threads end together.
+ *
+ * @note Added in v1.28.0 (2026-10-16)
+ */
+static uint64_t chunk_size(ENG_RUN *run)
+{
+	OASIS_ENGINE *eng = run->eng;
+	uint64_t      left = eng->num - run->k_next;
+	uint64_t      n;
+
+	n = (run->ns_k > 0)? (uint64_t)(ENG_CHUNK_NS / run->ns_k): run->chunk;
+	if (n > left / ((uint64_t)eng->threads * ENG_CHUNK_TAIL)) {
+		n = left / ((uint64_t)eng->threads * ENG_CHUNK_TAIL);
+	}
+	if (n < ENG_CHUNK_MIN) n = ENG_CHUNK_MIN;
+	if (n > ENG_CHUNK_MAX) n = ENG_CHUNK_MAX;
+	if (n > left) n = left;
+
+	return n;
+}
+
+/**
+ * @brief Carve the next chunks of the deserts into a deque
+ *
+ * @details The chunks of a deque are contiguous, so the owner scans them
+ *          with one position of its sieve.  A chunk is only carved while
+ *          its slot in the reorder ring is free.
+ *
+ * @note Added in v1.28.0 (2026-10-16): the caller holds run->mtx.
+ */
+static void deq_carve(ENG_RUN *run, ENG_DEQUE *dq)
+{
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck;
+
+	while (dq->cnt < ENG_DEQ && run->k_next < eng->num) {
+		ck = &run->ring[run->next % run->nring];
+		if (ck->state != ENG_CHUNK_FREE) break;	// ring full
+		ck->state = ENG_CHUNK_QUEUED;
+		ck->no    = run->next;
+		ck->k_lo  = run->k_next;
+		ck->k_hi  = run->k_next + chunk_size(run);
+		run->k_next = ck->k_hi;
+		dq->c[(dq->head + dq->cnt++) % ENG_DEQ] = run->next++;
+	}
+}
+
+/**
+ * @brief Steal the back half of the fullest deque
+ *
+ * @note Added in v1.28.0 (2026-10-16): the caller holds run->mtx.
+ */
+static void deq_steal(ENG_RUN *run, ENG_DEQUE *dq)
+{
+	ENG_DEQUE *v = NULL;
+	int        t, n;
+
+	for (t = 0; t < run->eng->threads; t++) {
+		if (run->deq[t].cnt > 0 && (v == NULL || run->deq[t].cnt > v->cnt)) v = &run->deq[t];
+	}
+	if (v == NULL) return;
+
+	n = (v->cnt + 1) / 2;				// the chunks of the highest k
+	for (t = v->cnt - n; t < v->cnt; t++) {
+		dq->c[(dq->head + dq->cnt++) % ENG_DEQ] = v->c[(v->head + t) % ENG_DEQ];
+	}
+	v->cnt -= n;
+	run->steals += n;
+}
+
+/**
+ * @brief Worker thread of the parallel scan
+ *
+ * @param[in] arg Scan (ENG_RUN)
+ *
+ * @details Takes the front chunk of its deque, scans it into the chunk's
+ *          own hit list and hands it over to the writer (scan_parallel()).
+ *          An empty deque is refilled from the deserts left, or by stealing
+ *          from another thread when all of them are carved.  At most
+ *          ENG_RING(threads) chunks are carved and not yet written.
+ *
+ * @note Modified in v1.28.0 (2026-10-16): work stealing (deq_carve(),
+ *       deq_steal()), the cost of a chunk is measured for chunk_size().
+ */
+static void *scan_worker(void *arg)
+{
+	ENG_RUN      *run = (ENG_RUN *)arg;
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck;
+	ENG_DEQUE    *dq;
+	ENG_WORK      wk[1];				// the mpz of the thread, reused by every chunk
+	OASIS_SIEVE   sv[1];
+	OASIS_SIEVE  *svp = NULL;
+	uint64_t      c, t0;
+	double        ns_k;
+
+	work_init(wk);
+	work_perf_open(wk, eng);
+	if (run->sv && oasis_sieve_share(sv, run->sv) == 0) svp = sv;
+
+	pthread_mutex_lock(&run->mtx);
+	dq = &run->deq[run->nwk];
+	wk->ctr = &run->ctr[run->nwk++];
+	while (!(ENG_REQ(eng) & ENG_REQ_STOP)) {
+		if (dq->cnt == 0) deq_carve(run, dq);
+		if (dq->cnt == 0) deq_steal(run, dq);
+		if (dq->cnt == 0) {
+			if (run->k_next >= eng->num) break;	// nothing left to take
+			pthread_cond_wait(&run->freed, &run->mtx);	// ring full
+			continue;
+		}
+		c  = dq->c[dq->head % ENG_DEQ];
+		dq->head++;
+		dq->cnt--;
+		ck = &run->ring[c % run->nring];
+		ck->state = ENG_CHUNK_BUSY;
+		pthread_mutex_unlock(&run->mtx);
+
+		ck->cnt   = 0;
+		ck->err   = 0;
+		t0 = now_ns();
+		XPT_PRF_B(XPT_EV_CHUNK, (uint32_t)c);
+		ck->k_end = scan_deserts(run, ck->k_lo, ck->k_hi, svp, wk, ck);
+		XPT_PRF_E(XPT_EV_CHUNK, (uint32_t)c);
+		if (ck->err) {
+			ck->k_end = ck->k_lo;		// nothing done
+			ck->cnt   = 0;
+		}
+		ns_k = (ck->k_end > ck->k_lo)? (double)(now_ns() - t0) / (ck->k_end - ck->k_lo): 0;
+
+		pthread_mutex_lock(&run->mtx);
+		if (ns_k > 0) {
+			run->ns_k = (run->ns_k > 0)? 0.75 * run->ns_k + 0.25 * ns_k: ns_k;
+		}
+		ck->state = ENG_CHUNK_DONE;
+		pthread_cond_broadcast(&run->done);
+	}
+	eng->scr_cnt  += wk->pp->cnt;
+	eng->scr_pass += wk->pp->pass;
+	eng->kernel    = oasis_prp_name(wk->pp);
+	work_perf_close(wk, eng);
+	pthread_cond_broadcast(&run->done);		// wake up the writer
+	pthread_mutex_unlock(&run->mtx);
+
+	if (svp) oasis_sieve_clear(svp);
+	work_clear(wk);
+
+	return NULL;
+}
+
+/**
+ * @brief Scan the deserts with a pool of threads
+ *
+ * @return First desert that has not been scanned (num unless stopped),
+ *         or -1 on memory allocation failure
+ *
+ * @details The calling thread is the writer: it delivers the hits of the
+ *          chunks in order of k, so the callbacks see the same hits as in
+ *          the serial scan.  While waiting it polls every 100ms.
+ *          On stop the scan ends at the first chunk that is not complete,
+ *          the part of that chunk that was scanned included.
+ *
+ * @note Modified in v1.28.0 (2026-10-16): the chunks are carved by the
+ *       workers with the size of chunk_size(), a chunk that is queued when
+ *       the scan stops is never scanned.
+ */
+static int scan_parallel(ENG_RUN *run)
+{
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck;
+	pthread_t    *tid;
+	uint64_t      k_end = eng->k_start;
+	uint64_t      c;
+	size_t        h;
+	int           nthr = eng->threads;
+	int           t;
+	struct timespec ts;
+
+	run->chunk  = (eng->num - eng->k_start) / ((uint64_t)nthr * ENG_CHUNK_PER_THREAD);
+	run->k_next = eng->k_start;
+	run->nring  = ENG_RING(nthr);
+	run->ring   = calloc(run->nring, sizeof(ENG_CHUNK));
+	run->deq    = calloc(nthr, sizeof(ENG_DEQUE));
+	tid = calloc(nthr, sizeof(pthread_t));
+	if ((run->ring == NULL) || (run->deq == NULL) || (tid == NULL)) {
+		free(run->ring);
+		free(run->deq);
+		free(tid);
+		return -1;
+	}
+	pthread_mutex_init(&run->mtx, NULL);
+	pthread_cond_init(&run->done, NULL);
+	pthread_cond_init(&run->freed, NULL);
+
+	for (t = 0; t < nthr; t++) {
+		if (pthread_create(&tid[t], NULL, scan_worker, run) != 0) {
+			break;
+		}
+	}
+	nthr = t;
+
+	/*--- writer: chunk 0,1,2,... in order ---*/
+	pthread_mutex_lock(&run->mtx);
+	for (c = 0; c < run->next || run->k_next < eng->num; c++) {
+		ck = &run->ring[c % run->nring];
+		while (ck->state != ENG_CHUNK_DONE || ck->no != c) {
+			if (((ENG_REQ(eng) & ENG_REQ_STOP) || nthr == 0)
+			&&  (c >= run->next || ck->state == ENG_CHUNK_QUEUED)) {
+				break;			// never be scanned
+			}
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += 100 * 1000 * 1000;	// poll every 100ms
+			if (ts.tv_nsec >= 1000 * 1000 * 1000) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000 * 1000 * 1000;
+			}
+			pthread_cond_timedwait(&run->done, &run->mtx, &ts);
+			if (!(ENG_REQ(eng) & ENG_REQ_STOP) && eng->poll && eng->poll(eng->arg)) {
+				oasis_engine_stop(eng);
+			}
+			pthread_mutex_unlock(&run->mtx);
+			report_due(run, ENG_REQ(eng));
+			pthread_mutex_lock(&run->mtx);
+		}
+		if (ck->state != ENG_CHUNK_DONE || ck->no != c) {
+			k_end = (c < run->next)? ck->k_lo: run->k_next;
+			break;
+		}
+		pthread_mutex_unlock(&run->mtx);
+
+		oasis_perf_phase(run->pf, OASIS_PERF_OUT);
+		for (h = 0; h < ck->cnt; h++) {		// x = start + k * step +- 1
+			mpz_mul_ui(run->x, eng->step, ck->hit[h].k);
+			mpz_add(run->x, run->x, eng->start);
+			if (ck->hit[h].sign == OASIS_SIEVE_M1) mpz_sub_ui(run->x, run->x, 1);
+			else                                   mpz_add_ui(run->x, run->x, 1);
+			if (deliver(run, ck->hit[h].k, ck->hit[h].sign, run->x, ck->hit[h].res)) break;
+		}
+		oasis_perf_phase(run->pf, OASIS_PERF_NONE);
+		k_end = (eng->halted)? eng->k_end: ck->k_end;
+		if (!eng->halted && eng->sync && eng->sync_sec
+		&&  k_end == ck->k_hi && time(NULL) >= run->due) {
+			sync_at(run, k_end);
+		}
+		report_due(run, ENG_REQ(eng));
+
+		pthread_mutex_lock(&run->mtx);
+		ck->state = ENG_CHUNK_FREE;
+		pthread_cond_broadcast(&run->freed);
+		if (eng->halted || k_end < ck->k_hi) break;	// stopped in this chunk
+	}
+	if (k_end < eng->num) oasis_engine_stop(eng);	// stop the rest
+	pthread_cond_broadcast(&run->freed);
+	pthread_mutex_unlock(&run->mtx);
+
+	for (t = 0; t < nthr; t++) {
+		pthread_join(tid[t], NULL);
+	}
+	for (c = 0; c < run->nring; c++) {
+		free(run->ring[c].hit);
+	}
+	pthread_mutex_destroy(&run->mtx);
+	pthread_cond_destroy(&run->done);
+	pthread_cond_destroy(&run->freed);
+	free(run->ring);
+	free(run->deq);
+	free(tid);
+
+	eng->k_end  = k_end;
+	eng->chunks = run->next;
+	eng->steals = run->steals;
+
+	return 0;
+}
+
+/**
+ * @brief Wait a little for another stage of the pipeline
+ *
+ * @param[in,out] spin Waits so far (0 after progress): sched_yield() for
+ *                     the first ENG_PIPE_SPIN, then sleeps of ENG_PIPE_NAP
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static void pipe_wait(int *spin)
+{
+	struct timespec ts = { 0, ENG_PIPE_NAP };
+
+	if ((*spin)++ < ENG_PIPE_SPIN) sched_yield();
+	else                           nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Queue a batch to the next stage and keep the deepest depth
+ *
+ * @details The queues can hold the whole ring, so a push only fails while
+ *          the consumer of the cell of the lap before has not released it.
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static void pipe_push(OASIS_QUEUE *q, ENG_CHUNK *ck, _Atomic uint32_t *max)
+{
+	uint32_t d, m;
+	int      spin = 0;
+
+	while (oasis_queue_push(q, ck) != 0) pipe_wait(&spin);
+	d = (uint32_t)oasis_queue_depth(q);
+	m = atomic_load_explicit(max, memory_order_relaxed);
+	while (d > m && !atomic_compare_exchange_weak_explicit(max, &m, d,
+			memory_order_relaxed, memory_order_relaxed)) {
+		;					// m is reloaded
+	}
+}
+
+/**
+ * @brief Free slot of the ring for batch s (the sieve stalls while it is full)
+ *
+ * @return Slot, or NULL if the scan stopped while waiting
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static ENG_CHUNK *pipe_slot(ENG_RUN *run, ENG_WORK *wk, uint64_t s)
+{
+	OASIS_ENGINE *eng = run->eng;
+	uint64_t      t0 = 0, dt;
+	int           spin = 0;
+
+	while (s >= atomic_load_explicit(&run->out, memory_order_acquire) + run->nring) {
+		if (ENG_REQ(eng) & ENG_REQ_STOP) return NULL;
+		if (spin == 0) t0 = now_ns();
+		pipe_wait(&spin);
+	}
+	if (spin) {					// not sieve time
+		dt = now_ns() - t0;
+		ctr_add(&wk->ctr->ns_idle, dt);
+		wk->t_pub += dt;
+	}
+
+	return &run->ring[s % run->nring];
+}
+
+/**
+ * @brief Sieve stage of the pipelined scan
+ *
+ * @param[in] arg Scan (ENG_RUN)
+ *
+ * @details Cuts the sieve survivors into batches of at most ENG_PIPE_CAND
+ *          candidates or ENG_PIPE_K deserts, each ending at the end of a
+ *          desert, and queues them to the PRP workers in order of k.  The
+ *          candidates are those of scan_loop().  On stop the batch being
+ *          filled is queued up to the desert reached.  Only the time is
+ *          counted here, the deserts are counted when they are tested.
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static void *pipe_sieve(void *arg)
+{
+	ENG_RUN      *run = (ENG_RUN *)arg;
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck  = NULL;
+	ENG_WORK      wk[1];
+	uint64_t      k, t, s = 0;
+	uint64_t      k_poll = eng->k_start;		// next desert to poll at
+	uint64_t      last = (eng->flags & OASIS_ENG_SKIP_LAST)? eng->num - 1: UINT64_MAX;
+	int           first = (eng->flags & OASIS_ENG_SKIP_FIRST) != 0;
+
+	work_init(wk);
+	work_perf_open(wk, eng);
+	wk->ctr   = &run->ctr[0];
+	wk->t_pub = now_ns();
+	oasis_perf_phase(wk->pf, OASIS_PERF_SIEVE);
+
+	for (k = eng->k_start; k < eng->num; k++) {
+
+	   if (k == k_poll) {
+	      k_poll += ENG_POLL;
+	      t = now_ns();
+	      ctr_add(&wk->ctr->ns_scan, t - wk->t_pub);
+	      wk->t_pub = t;
+	      if (ENG_REQ(eng) & ENG_REQ_STOP) break;
+	   }
+	   if (ck == NULL) {
+	      ck = pipe_slot(run, wk, s);
+	      if (ck == NULL) break;			// stopped
+	      ck->no    = s;
+	      ck->k_lo  = k;
+	      ck->nsurv = 0;
+	   }
+
+	   /*--- m1 ---*/
+	   if (!(k == 0 && first) && !(eng->dup && k > 0)) {	// m1 != previous p1
+	      if (run->sv == NULL || oasis_sieve_pass(run->sv, k, OASIS_SIEVE_M1)) {
+		 ck->surv[ck->nsurv].k      = k;
+		 ck->surv[ck->nsurv++].sign = OASIS_SIEVE_M1;
+	      }
+	   }
+
+	   /*--- p1 ---*/
+	   if (k != last) {
+	      if (run->sv == NULL || oasis_sieve_pass(run->sv, k, OASIS_SIEVE_P1)) {
+		 ck->surv[ck->nsurv].k      = k;
+		 ck->surv[ck->nsurv++].sign = OASIS_SIEVE_P1;
+	      }
+	   }
+
+	   if (ck->nsurv > ENG_PIPE_CAND - 2 || k + 1 - ck->k_lo >= ENG_PIPE_K) {
+	      ck->k_hi = k + 1;
+	      pipe_push(&run->q_prp, ck, &run->q_prp_max);
+	      atomic_store_explicit(&run->nbatch, ++s, memory_order_relaxed);
+	      ck = NULL;
+	   }
+	}
+	if (ck != NULL && k > ck->k_lo) {		// the rest
+	   ck->k_hi = k;
+	   pipe_push(&run->q_prp, ck, &run->q_prp_max);
+	   atomic_store_explicit(&run->nbatch, ++s, memory_order_relaxed);
+	}
+	ctr_add(&wk->ctr->ns_scan, now_ns() - wk->t_pub);
+	oasis_perf_phase(wk->pf, OASIS_PERF_NONE);
+	atomic_store_explicit(&run->sieved, 1, memory_order_release);
+
+	pthread_mutex_lock(&run->mtx);
+	work_perf_close(wk, eng);
+	pthread_mutex_unlock(&run->mtx);
+	work_clear(wk);
+
+	return NULL;
+}
+
+/**
+ * @brief PRP stage of the pipelined scan (a worker of the pool)
+ *
+ * @param[in] arg Scan (ENG_RUN)
+ *
+ * @details Screens and tests the survivors of a batch into its hit list and
+ *          queues it to the writer.  A worker takes the batches in order of
+ *          k, so its pit only moves up (add_cand()).  After a stop the
+ *          batches left are passed on untested (k_end = k_lo).
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static void *pipe_prp(void *arg)
+{
+	ENG_RUN      *run = (ENG_RUN *)arg;
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck;
+	ENG_WORK      wk[1];
+	void         *p;
+	uint64_t      t0;
+	int           i, spin;
+
+	work_init(wk);
+	work_perf_open(wk, eng);
+	pthread_mutex_lock(&run->mtx);
+	wk->ctr = &run->ctr[run->nwk++];
+	pthread_mutex_unlock(&run->mtx);
+	mpz_set(wk->pit, eng->start);			// pit(0)
+	wk->k_pit = 0;
+
+	for (;;) {
+		t0   = now_ns();
+		spin = 0;
+		while (oasis_queue_pop(&run->q_prp, &p) != 0) {
+			if (atomic_load_explicit(&run->sieved, memory_order_acquire)
+			&&  oasis_queue_depth(&run->q_prp) == 0) {
+				p = NULL;		// all batches taken
+				break;
+			}
+			pipe_wait(&spin);
+		}
+		ctr_add(&wk->ctr->ns_idle, now_ns() - t0);
+		if (p == NULL) break;
+
+		ck = (ENG_CHUNK *)p;
+		t0 = now_ns();
+		ck->cnt   = 0;
+		ck->err   = 0;
+		ck->k_end = ck->k_lo;
+		if (!(ENG_REQ(eng) & ENG_REQ_STOP)) {
+			XPT_PRF_B(XPT_EV_CHUNK, (uint32_t)ck->no);
+			for (i = 0; i < ck->nsurv && !ck->err; i++) {
+				add_cand(run, wk, ck, ck->surv[i].k, ck->surv[i].sign);
+			}
+			if (wk->ncand && !ck->err) flush_batch(run, wk, ck);
+			XPT_PRF_E(XPT_EV_CHUNK, (uint32_t)ck->cnt);
+			ck->k_end = ck->k_hi;
+		}
+		if (ck->err) {
+			ck->k_end = ck->k_lo;		// nothing done
+			ck->cnt   = 0;
+			wk->ncand = 0;
+		}
+		ctr_add(&wk->ctr->desert, ck->k_end - ck->k_lo);
+		ctr_add(&wk->ctr->cand, oasis_engine_tries(eng, ck->k_lo, ck->k_end));
+		ctr_add(&wk->ctr->ns_scan, now_ns() - t0);
+		pipe_push(&run->q_out, ck, &run->q_out_max);
+	}
+
+	pthread_mutex_lock(&run->mtx);
+	eng->scr_cnt  += wk->pp->cnt;
+	eng->scr_pass += wk->pp->pass;
+	eng->kernel    = oasis_prp_name(wk->pp);
+	work_perf_close(wk, eng);
+	pthread_mutex_unlock(&run->mtx);
+	work_clear(wk);
+
+	return NULL;
+}
+
+/**
+ * @brief Scan the deserts as a pipeline: sieve -> PRP workers -> writer
+ *
+ * @return First desert that has not been scanned (num unless stopped),
+ *         or -1 on memory allocation failure
+ *
+ * @details One thread sieves (pipe_sieve()), threads workers test
+ *          (pipe_prp()) and the calling thread is the writer: it takes the
+ *          tested batches off its queue and delivers them in order of k,
+ *          so the callbacks see the same hits as in the serial scan.  At
+ *          most nring batches are sieved and not yet written, which is the
+ *          backpressure on the sieve.  While waiting the writer polls every
+ *          100ms.  On stop the scan ends at the first batch not tested.
+ *
+ * @note Added in v1.29.0 (2026-10-16)
+ */
+static int scan_pipeline(ENG_RUN *run)
+{
+	OASIS_ENGINE *eng = run->eng;
+	ENG_CHUNK    *ck;
+	ENG_HIT      *surv;
+	pthread_t    *tid;
+	void         *p;
+	uint64_t      k_end = eng->k_start;
+	uint64_t      out = 0;				// next batch to write
+	uint64_t      now, t0, t_poll = 0;
+	uint64_t      c;
+	size_t        h;
+	int           nthr = eng->threads;
+	int           sieve = 0;
+	int           t, spin = 0;
+
+	run->nring = ENG_PIPE_RING(nthr);
+	run->ring  = calloc(run->nring, sizeof(ENG_CHUNK));
+	surv = malloc(run->nring * ENG_PIPE_CAND * sizeof(ENG_HIT));
+	tid  = calloc(nthr + 1, sizeof(pthread_t));
+	if ((run->ring == NULL) || (surv == NULL) || (tid == NULL)
+	||  (oasis_queue_init(&run->q_prp, run->nring) != 0)
+	||  (oasis_queue_init(&run->q_out, run->nring) != 0)) {
+		oasis_queue_clear(&run->q_prp);
+		oasis_queue_clear(&run->q_out);
+		free(run->ring);
+		free(surv);
+		free(tid);
+		return -1;
+	}
+	for (c = 0; c < run->nring; c++) {
+		run->ring[c].surv = &surv[c * ENG_PIPE_CAND];
+	}
+	pthread_mutex_init(&run->mtx, NULL);
+	run->nwk = 1;					// slot 0: the sieve
+
+	for (t = 0; t < nthr; t++) {
+		if (pthread_create(&tid[t + 1], NULL, pipe_prp, run) != 0) {
+			break;
+		}
+	}
+	run->nprp = t;
+	if (run->nprp > 0 && pthread_create(&tid[0], NULL, pipe_sieve, run) == 0) {
+		sieve = 1;
+	}
+	else {
+		atomic_store_explicit(&run->sieved, 1, memory_order_release);
+	}
+
+	/*--- writer: batch 0,1,2,... in order ---*/
+	while (sieve) {
+		now = now_ns();
+		if (now >= t_poll) {			// poll every 100ms
+			t_poll = now + 100 * 1000 * 1000;
+			if (!(ENG_REQ(eng) & ENG_REQ_STOP) && eng->poll && eng->poll(eng->arg)) {
+				oasis_engine_stop(eng);
+			}
+		}
+		report_due(run, ENG_REQ(eng));
+
+		ck = &run->ring[out % run->nring];
+		if (ck->state != ENG_CHUNK_DONE) {
+			if (oasis_queue_pop(&run->q_out, &p) == 0) {
+				((ENG_CHUNK *)p)->state = ENG_CHUNK_DONE;	// tested, maybe out of order
+				spin = 0;
+				continue;
+			}
+			if (atomic_load_explicit(&run->sieved, memory_order_acquire)
+			&&  out == atomic_load_explicit(&run->nbatch, memory_order_relaxed)) {
+				break;			// all written
+			}
+			t0 = now_ns();
+			pipe_wait(&spin);
+			run->ns_out_idle += now_ns() - t0;
+			continue;
+		}
+
+		oasis_perf_phase(run->pf, OASIS_PERF_OUT);
+		for (h = 0; h < ck->cnt; h++) {		// x = start + k * step +- 1
+			mpz_mul_ui(run->x, eng->step, ck->hit[h].k);
+			mpz_add(run->x, run->x, eng->start);
+			if (ck->hit[h].sign == OASIS_SIEVE_M1) mpz_sub_ui(run->x, run->x, 1);
+			else                                   mpz_add_ui(run->x, run->x, 1);
+			if (deliver(run, ck->hit[h].k, ck->hit[h].sign, run->x, ck->hit[h].res)) break;
+		}
+		oasis_perf_phase(run->pf, OASIS_PERF_NONE);
+		k_end = (eng->halted)? eng->k_end: ck->k_end;
+		if (!eng->halted && eng->sync && eng->sync_sec
+		&&  k_end == ck->k_hi && time(NULL) >= run->due) {
+			sync_at(run, k_end);
+		}
+
+		ck->state = ENG_CHUNK_FREE;
+		atomic_store_explicit(&run->out, ++out, memory_order_release);
+		if (eng->halted || k_end < ck->k_hi) break;	// stopped in this batch
+	}
+	if (k_end < eng->num) oasis_engine_stop(eng);	// stop the rest
+
+	if (sieve) pthread_join(tid[0], NULL);
+	for (t = 0; t < run->nprp; t++) {
+		pthread_join(tid[t + 1], NULL);
+	}
+	for (c = 0; c < run->nring; c++) {
+		free(run->ring[c].hit);
+	}
+	oasis_queue_clear(&run->q_prp);
+	oasis_queue_clear(&run->q_out);
+	pthread_mutex_destroy(&run->mtx);
+	free(run->ring);
+	free(surv);
+	free(tid);
+
+	eng->k_end = k_end;
+
+	return 0;
+}
+
+/**
+ * @brief Initialize an engine
+ *
+ * @param[out] eng Engine: serial scan of no deserts, no callbacks
+ */
+void oasis_engine_init(OASIS_ENGINE *eng)
+{
+	memset(eng, 0, sizeof(*eng));
+	mpz_init(eng->start);
+	mpz_init(eng->step);
+	eng->threads = 1;
+}
+
+/**
+ * @brief Release an engine
+ */
+void oasis_engine_clear(OASIS_ENGINE *eng)
+{
+	mpz_clear(eng->start);
+	mpz_clear(eng->step);
+}
+
+/**
+ * @brief Set the deserts of start..end (oasis_layer1/2/3, prime_oasis)
+ *
+ * @param[in,out] eng   Engine
+ * @param[in]     start First pit
+ * @param[in]     end   Last pit (inclusive, pit <= end)
+ * @param[in]     step  Search increment
+ *
+ * @details pit = start + k*step for the (end - start) / step + 1 deserts.
+ *          start - 1 and end + 1 lie outside the deserts and are not
+ *          candidates (end + 1 only if a pit reaches end).
+ */
+void oasis_engine_range(OASIS_ENGINE *eng, mpz_t start, mpz_t end, mpz_t step)
+{
+	mpz_t n;
+
+	mpz_init(n);
+	mpz_set(eng->start, start);
+	mpz_set(eng->step,  step);
+	eng->num   = 0;
+	eng->flags = OASIS_ENG_SKIP_FIRST;
+	if (mpz_cmp(end, start) >= 0) {
+		mpz_sub(n, end, start);			// number of deserts
+		if (mpz_divisible_p(n, step)) {		//   = (end - start) / step + 1
+			eng->flags |= OASIS_ENG_SKIP_LAST;
+		}
+		mpz_fdiv_q(n, n, step);
+		eng->num = mpz_get_ui(n) + 1;
+	}
+	mpz_clear(n);
+}
+
+/**
+ * @brief First desert of the i-th of n slices of num deserts
+ *
+ * @return num * i / n (slice i is [shard_k(i), shard_k(i + 1)))
+ *
+ * @note Added in v1.27.0 (2026-10-16)
+ */
+uint64_t oasis_engine_shard_k(uint64_t num, uint64_t i, uint64_t n)
+{
+	return (uint64_t)((unsigned __int128)num * i / n);
+}
+
+/**
+ * @brief Keep the i-th of n slices of the deserts (--shard i/n)
+ *
+ * @param[in,out] eng Engine (range set, not started)
+ * @param[in]     i   Slice, 0..n-1
+ * @param[in]     n   Number of slices, 1..num
+ *
+ * @return 0 on success, -1 if i or n is out of range
+ *
+ * @details The slice becomes a range of its own: start moves to its first
+ *          pit and k of the hits is relative to it.  The candidates are
+ *          those of the whole range: start - 1 and end + 1 stay out only
+ *          in the first and the last slice, and with step = 2 pit - 1 of
+ *          the first desert of a later slice is pit + 1 of the slice
+ *          before it (SKIP_FIRST), so the slices hand out every hit and
+ *          every try exactly once.
+ *
+ * @note Added in v1.27.0 (2026-10-16)
+ */
+int oasis_engine_shard(OASIS_ENGINE *eng, uint64_t i, uint64_t n)
+{
+	uint64_t lo, hi;
+
+	if (n < 1 || n > eng->num || i >= n) return -1;
+
+	lo = oasis_engine_shard_k(eng->num, i, n);
+	hi = oasis_engine_shard_k(eng->num, i + 1, n);
+	mpz_addmul_ui(eng->start, eng->step, lo);	// start = pit(lo)
+	if (hi < eng->num) eng->flags &= ~OASIS_ENG_SKIP_LAST;
+	if (lo > 0) {
+		eng->flags &= ~OASIS_ENG_SKIP_FIRST;
+		if (mpz_cmp_ui(eng->step, 2) == 0) eng->flags |= OASIS_ENG_SKIP_FIRST;	// dup
+	}
+	eng->num = hi - lo;
+
+	return 0;
+}
+
+/**
+ * @brief Ask a running scan to stop
+ *
+ * @note Async-signal-safe: may be called from a signal handler.  The scan
+ *       stops at its next poll and all hits before the stop are delivered.
+ *
+ * @note Modified in v1.32.1 (2026-10-16): sets ENG_REQ_STOP in eng->req.
+ *
+ * @note Modified in v1.24.0 (2026-10-16): a relaxed atomic store, so any
+ *       thread may call it (the control thread of oasis_ctl.h).
+ */
+void oasis_engine_stop(OASIS_ENGINE *eng)
+{
+	atomic_fetch_or_explicit(&eng->req, ENG_REQ_STOP, memory_order_relaxed);
+}
+
+/**
+ * @brief Ask a running scan for its progress (stat() with pg->req set)
+ *
+ * @note Added in v1.24.0 (2026-10-16): async-signal-safe like
+ *       oasis_engine_stop().  The report comes at the next poll, from the
+ *       thread of oasis_engine_run(); nothing happens without stat().
+ */
+void oasis_engine_stat_now(OASIS_ENGINE *eng)
+{
+	atomic_fetch_or_explicit(&eng->req, ENG_REQ_STAT, memory_order_relaxed);
+}
+
+/**
+ * @brief Scan the deserts k_start..num-1
+ *
+ * @param[in,out] eng Engine (parameters set, the counters start from st)
+ *
+ * @return 0 on success (k_end and st are set), -1 on memory allocation failure
+ *
+ * @details The sieve is disabled (sv_nprm = 0) and the proof is disabled
+ *          (prove = 0, the hits are probable primes) if there is not
+ *          enough memory for them; the scan still runs.
+ *
+ * @note Modified in v1.29.0 (2026-10-16): pipelined scan (pipeline)
+ */
+int oasis_engine_run(OASIS_ENGINE *eng)
+{
+	ENG_RUN     run[1];
+	ENG_WORK    wk[1];
+	OASIS_SIEVE sv[1];
+	uint64_t    k, ns_scan = 0, ns_scr = 0, ns_test = 0;
+	long        e;
+	double      lnx;
+	int         i, ret = 0;
+
+	memset(run, 0, sizeof(run));
+	run->eng = eng;
+	mpz_init(run->x);
+	eng->req      = 0;
+	eng->halted   = 0;
+	eng->part     = 0;
+	eng->m1_hit   = 0;
+	eng->dup      = (mpz_cmp_ui(eng->step, 2) == 0);
+	eng->try0     = eng->st->try_cnt;
+	eng->k_end    = eng->k_start;
+	eng->scr_cnt  = 0;
+	eng->scr_pass = 0;
+	eng->ns_sieve = 0;
+	eng->ns_prp   = 0;
+	eng->ns_out   = 0;
+	eng->chunks   = 0;
+	eng->steals   = 0;
+	memset(eng->pf, 0, sizeof(eng->pf));
+	memset(eng->pipe, 0, sizeof(eng->pipe));
+	if (eng->threads < 1) eng->threads = 1;
+	if (eng->threads > OASIS_ENG_THREADS_MAX) eng->threads = OASIS_ENG_THREADS_MAX;
+	if (eng->k_start >= eng->num) {
+		mpz_clear(run->x);
+		return 0;
+	}
+
+	run->nctr = eng->threads + (eng->pipeline != 0);	// pipeline: + the sieve
+	run->ctr  = aligned_alloc(64, run->nctr * sizeof(ENG_CTR));
+	if (run->ctr == NULL) {
+		mpz_clear(run->x);
+		return -1;
+	}
+	memset(run->ctr, 0, run->nctr * sizeof(ENG_CTR));
+
+	work_init(wk);
+	work_perf_open(wk, eng);
+	wk->ctr = &run->ctr[0];				// serial scan
+	run->pf = wk->pf;				// serial scan, or the writer
+	eng->sv_nprm = 0;
+	if (oasis_sieve_init(sv, eng->start, eng->step,
+			oasis_sieve_limit(eng->start, eng->num)) == 0) {
+		run->sv = sv;
+		eng->sv_nprm = sv->nprm;
+	}
+	if (run->sv && sv->nprm) {			// x = pit(num / 2)
+		mpz_mul_ui(run->x, eng->step, eng->num / 2);
+		mpz_add(run->x, run->x, eng->start);
+		lnx = log(mpz_get_d_2exp(&e, run->x)) + e * log(2.0);
+		run->dens = exp(ENG_EULER_GAMMA) * log((double)sv->prm[sv->nprm - 1]) / lnx;
+	}
+	eng->prove = (eng->prove_n > 0) && (oasis_prove_init(run->prv, eng->prove_n) == 0);
+	eng->kernel = oasis_prp_name(wk->pp);
+
+	run->due      = time(NULL) + eng->sync_sec;
+	run->t0       = now_ns();
+	run->last_t   = run->t0;
+	run->stat_due = run->t0 + (uint64_t)eng->stat_sec * 1000000000;
+	if (eng->pipeline) {
+		ret = scan_pipeline(run);
+	}
+	else if (eng->threads > 1) {
+		ret = scan_parallel(run);
+	}
+	else {
+		k = scan_deserts(run, eng->k_start, eng->num, run->sv, wk, NULL);
+		if (!eng->halted) eng->k_end = k;
+		eng->scr_cnt  = wk->pp->cnt;
+		eng->scr_pass = wk->pp->pass;
+	}
+	eng->st->try_cnt = eng->try0 + oasis_engine_tries(eng, eng->k_start, eng->k_end) + eng->part;
+	for (i = 0; i < run->nctr; i++) {
+		ns_scan += ctr_get(&run->ctr[i].ns_scan);
+		ns_scr  += ctr_get(&run->ctr[i].ns_scr);
+		ns_test += ctr_get(&run->ctr[i].ns_test);
+	}
+	eng->ns_sieve = ns_scan - ns_scr - ns_test;
+	eng->ns_prp   = ns_scr + ns_test;
+	if (eng->threads == 1 && !eng->pipeline) {
+		eng->ns_prp -= eng->ns_out;		// the hits are delivered by flush_batch()
+	}
+	pipe_stat(run, eng->pipe);
+	if (eng->stat) report(run, 1);
+	work_perf_close(wk, eng);
+
+	if (eng->prove) oasis_prove_clear(run->prv);
+	if (run->sv) oasis_sieve_clear(sv);
+	work_clear(wk);
+	free(run->ctr);
+	mpz_clear(run->x);
+
+	return ret;
+}
+
+/**
+ * @brief Print the progress of a scan as one line
+ *
+ * @param[in] fp   Stream
+ * @param[in] prog Name of the scan (command and parameters)
+ * @param[in] pg   Progress (stat callback)
+ * @param[in] json 0: human readable, 1: NDJSON
+ *
+ * @note Modified in v1.29.0 (2026-10-16): the stages of a pipelined scan
+ *       (queue depths, waits of the sieve, the PRP workers and the writer)
+ */
+void oasis_engine_prog_print(FILE *fp, const char *prog, const OASIS_ENG_PROG *pg, int json)
+{
+	double   frac = (pg->num)? (double)pg->k_done / pg->num: 1.0;
+	uint64_t eta  = (pg->eta > 0)? (uint64_t)(pg->eta + 0.5): 0;
+	const OASIS_ENG_PIPE *pi = pg->pipe;
+
+	if (json) {
+		fprintf(fp, "{\"prog\": \"%s\", \"sec\": %.1f, \"k_done\": %lu, \"num\": %lu, \"frac\": %.6f, "
+			"\"cand\": %lu, \"hit\": %lu, \"cand_per_s\": %.1f, \"hits_per_s\": %.2f, "
+			"\"surv\": %.4f, \"density\": %.6f, \"hits_left\": %.0f, \"eta\": %.0f, ",
+			prog, pg->sec, pg->k_done, pg->num, frac,
+			pg->cand, pg->hit, pg->cand_rate, pg->hit_rate,
+			pg->surv, pg->density, pg->hits_left, pg->eta);
+		if (pi->prp) {
+			fprintf(fp, "\"pipe\": {\"prp\": %d, \"batches\": %lu, \"q_prp\": %u, \"q_out\": %u, "
+				"\"q_prp_max\": %u, \"q_out_max\": %u, \"sieve_stall\": %.3f, "
+				"\"prp_idle\": %.3f, \"out_idle\": %.3f}, ",
+				pi->prp, pi->batches, pi->q_prp, pi->q_out, pi->q_prp_max, pi->q_out_max,
+				pi->sieve_stall, pi->prp_idle, pi->out_idle);
+		}
+		fprintf(fp, "\"done\": %s}\n", (pg->done)? "true": "false");
+	}
+	else {
+		fprintf(fp, "[%s] %5.1f%% %lu/%lu, %.0f cand/s, %.2f hits/s, sieve %.1f%% pass, ",
+			prog, frac * 100.0, pg->k_done, pg->num, pg->cand_rate, pg->hit_rate, pg->surv * 100.0);
+		if (pi->prp) {
+			fprintf(fp, "queue %u/%u (max %u/%u), wait sieve %.1fs prp %.1fs out %.1fs, ",
+				pi->q_prp, pi->q_out, pi->q_prp_max, pi->q_out_max,
+				pi->sieve_stall, pi->prp_idle, pi->out_idle);
+		}
+		if (pg->done)        fprintf(fp, "done in %.1fs\n", pg->sec);
+		else if (pg->eta < 0) fprintf(fp, "ETA --\n");
+		else                 fprintf(fp, "ETA %lu:%02lu:%02lu (~%.0f hits left)\n",
+					     eta / 3600, eta / 60 % 60, eta % 60, pg->hits_left);
+	}
+	fflush(fp);
+}
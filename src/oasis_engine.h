@@ -0,0 +1,176 @@
+/**
+ * @file oasis_engine.h
+ * @brief Scan engine of liboasis: the oasis candidates pit +- 1 of a run of deserts.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Every command scans pit(k) = start + k*step for k = 0,1,...,num-1 and tests
+ * pit(k) - 1 and pit(k) + 1:
+ *
+ *   oasis_layer1/2/3, prime_oasis   start = d<start>, step = d<step>
+ *   prime_oases                     start = d<n> * no, step = d<n>
+ *
+ * The engine does the whole scan (segmented sieve, batched Fermat screen,
+ * probable prime test or --prove, threads) and hands every prime to a
+ * callback, in order of k and m1 before p1, as (n, k, sign, x).  Nothing is
+ * formatted: the commands print the hits, an embedding program can keep
+ * them in memory.
+ *
+ * With threads the hits of a chunk are kept as (k, sign) and x is rebuilt
+ * by the calling thread, so the callbacks always run on the thread of
+ * oasis_engine_run() and need no locking.
+ *
+ * With pipeline the scan is staged instead: one sieve thread hands batches
+ * of survivors through lock-free queues (oasis_queue.h) to threads PRP
+ * workers, the calling thread writes the hits in order (OASIS_ENG_PIPE).
+ *
+ * @note v1.32.1 (2026-10-16): stop and stat_req are folded into one atomic flag word (req)
+ *
+ * @note v1.29.0 (2026-10-16): Add the pipelined scan (pipeline, OASIS_ENG_PIPE)
+ *
+ * @note v1.28.0 (2026-10-16): Work-stealing parallel scan (chunks, steals)
+ *
+ * @note v1.27.0 (2026-10-16): Add oasis_engine_shard() (--shard i/n of the commands)
+ *
+ * @note v1.24.0 (2026-10-16): stop is a relaxed atomic flag, add oasis_engine_stat_now() (see oasis_ctl.h)
+ *
+ * @note v1.22.0 (2026-10-16): Add perf_event counters of the phases of a scan (perf, pf)
+ *
+ * @note v1.20.0 (2026-10-16): Add the progress of a running scan (stat callback)
+ *
+ * @note v1.19.0 (2026-10-16): Add the time split of a scan (ns_sieve, ns_prp, ns_out)
+ *
+ * @note v1.18.0 (2026-10-16): Add scan engine (liboasis)
+ */
+
+#ifndef _OASIS_ENGINE_H
+#define _OASIS_ENGINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <gmp.h>
+
+#include "oasis_perf.h"
+
+/* OASIS_ENGINE.flags */
+#define OASIS_ENG_SKIP_FIRST	(0x01)		// pit(0) - 1 is not a candidate
+#define OASIS_ENG_SKIP_LAST	(0x02)		// pit(num - 1) + 1 is not a candidate
+
+/* Flags of a hit, same values as OASIS_REC_* (see oasis_rec.h) */
+#define OASIS_HIT_TWIN		(0x01)		// pit + 1 of a twin (pit - 1 is a hit too)
+#define OASIS_HIT_PROVEN	(0x02)		// proven prime (prove_n)
+#define OASIS_HIT_PROBABLE	(0x04)		// not proven (prove_n)
+
+#define OASIS_ENG_THREADS_MAX	(256)
+
+/**
+ * @brief Callback of a hit
+ *
+ * @param[in] arg   OASIS_ENGINE.arg
+ * @param[in] n     OASIS_ENGINE.n
+ * @param[in] k     Desert index: x = start + k*step + sign
+ * @param[in] sign  -1 or +1
+ * @param[in] x     The prime (valid during the call only)
+ * @param[in] flags OASIS_HIT_*
+ *
+ * @return 0 to continue, nonzero to stop the scan after this hit
+ */
+typedef int (*OASIS_HIT_FN)(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags);
+
+/* Counters of a scan */
+typedef struct {
+	uint64_t	try_cnt;		// candidates (struck out by the sieve included)
+	uint64_t	hit_cnt;
+	uint64_t	twin_cnt;
+	uint64_t	prv_cnt;		// proven hits (prove_n)
+} OASIS_ENG_STAT;
+
+/* Stages of a pipelined scan: queue depths and waits (backpressure) */
+typedef struct {
+	int		prp;			// PRP workers (0: not a pipelined scan)
+	uint64_t	batches;		// batches of survivors sieved
+	uint32_t	q_prp;			// batches waiting for a PRP worker
+	uint32_t	q_out;			// batches waiting for the writer
+	uint32_t	q_prp_max;		// deepest q_prp seen
+	uint32_t	q_out_max;		// deepest q_out seen
+	double		sieve_stall;		// s the sieve waited for a free slot (the stages after it behind)
+	double		prp_idle;		// s the PRP workers waited for a batch (all workers)
+	double		out_idle;		// s the writer waited for the next batch in order
+} OASIS_ENG_PIPE;
+
+/* Progress of a running scan, see OASIS_ENGINE.stat */
+typedef struct {
+	double		sec;			// seconds since oasis_engine_run()
+	uint64_t	k_done;			// deserts done (k_start included, any order with threads)
+	uint64_t	num;			// OASIS_ENGINE.num
+	uint64_t	cand;			// candidates done by this run
+	uint64_t	hit;			// primes found by this run
+	double		cand_rate;		// candidates/s of the last interval
+	double		hit_rate;		// hits/s of the last interval
+	double		surv;			// sieve survivors / candidates (measured)
+	double		density;		// expected primes / candidate
+	double		hits_left;		// expected hits of the deserts left
+	double		eta;			// seconds left (-1: not known yet)
+	int		done;			// the last report of the run
+	int		req;			// asked for by oasis_engine_stat_now()
+	OASIS_ENG_PIPE	pipe[1];		// stages of a pipelined scan (pipeline)
+} OASIS_ENG_PROG;
+
+typedef struct {
+	/*--- parameters ---*/
+	mpz_t		 start;			// pit(0)
+	mpz_t		 step;			// pit(k + 1) - pit(k)
+	uint64_t	 num;			// number of deserts
+	uint64_t	 k_start;		// first desert to scan (resume)
+	int		 n;			// passed to the callback (n of d<n>)
+	int		 flags;			// OASIS_ENG_*
+	int		 threads;		// 1: serial scan
+	int		 prove_n;		// prove with d<prove_n> | step (0: probable prime test)
+	int		 sync_sec;		// seconds between sync() (0: never)
+	OASIS_HIT_FN	 hit;			// hit callback (NULL: count only)
+	int		(*poll)(void *arg);	// polled every 100 deserts / 100ms, nonzero: stop (NULL: none)
+	void		(*sync)(void *arg, uint64_t k_next);	// all hits of k < k_next are done
+	int		 stat_sec;		// seconds between stat() (0: only on request)
+	void		(*stat)(void *arg, const OASIS_ENG_PROG *pg);	// progress, and once at the end
+	void		*arg;			// argument of the callbacks
+	int		 perf;			// count the phases with perf_event (see oasis_perf.h)
+	int		 pipeline;		// staged scan: sieve -> threads PRP workers -> writer
+
+	/*--- results ---*/
+	OASIS_ENG_STAT	 st[1];			// counters (added to the initial values)
+	uint64_t	 k_end;			// first desert not scanned (num unless stopped)
+	int		 prove;			// the hits were proven (d<prove_n> factored)
+	uint32_t	 sv_nprm;		// sieve primes (0: no sieve)
+	uint64_t	 scr_cnt;		// candidates of the Fermat screen
+	uint64_t	 scr_pass;		// probable primes of the Fermat screen
+	const char	*kernel;		// kernel of the Fermat screen
+	uint64_t	 ns_sieve;		// ns in the scan loop and the sieve (all threads)
+	uint64_t	 ns_prp;		// ns in the screen and the primality tests (all threads)
+	uint64_t	 ns_out;		// ns in the hit callback
+	OASIS_PERF_CNT	 pf[1];			// perf_event counts of the phases (perf)
+	uint64_t	 chunks;		// chunks of the parallel scan
+	uint64_t	 steals;		// chunks stolen from the deque of another thread
+	OASIS_ENG_PIPE	 pipe[1];		// stages of the pipelined scan (pipeline)
+
+	/*--- internal ---*/
+	_Atomic int	 req;			// requests: oasis_engine_stop(), oasis_engine_stat_now()
+	int		 dup;			// step = 2: pit(k) - 1 = pit(k - 1) + 1
+	uint64_t	 m1_hit;		// k + 1 of the last hit pit(k) - 1
+	uint64_t	 try0;			// st->try_cnt before the scan
+	int		 halted;		// stopped by the hit callback
+	int		 part;			// halted after pit(k_end) - 1
+} OASIS_ENGINE;
+
+void oasis_engine_init(OASIS_ENGINE *eng);
+void oasis_engine_clear(OASIS_ENGINE *eng);
+void oasis_engine_range(OASIS_ENGINE *eng, mpz_t start, mpz_t end, mpz_t step);
+int  oasis_engine_shard(OASIS_ENGINE *eng, uint64_t i, uint64_t n);
+uint64_t oasis_engine_shard_k(uint64_t num, uint64_t i, uint64_t n);
+uint64_t oasis_engine_tries(const OASIS_ENGINE *eng, uint64_t a, uint64_t b);
+int  oasis_engine_run(OASIS_ENGINE *eng);
+void oasis_engine_stop(OASIS_ENGINE *eng);
+void oasis_engine_stat_now(OASIS_ENGINE *eng);
+void oasis_engine_prog_print(FILE *fp, const char *prog, const OASIS_ENG_PROG *pg, int json);
+
+#endif  // _OASIS_ENGINE_H
@@ -0,0 +1,154 @@
+/**
+ * @file oasis_fermat.c
+ * @brief Base-2 Fermat test of the oasis candidates on fixed-width mpn.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * 2^(N-1) mod N is computed left to right in Montgomery form (R = B^n):
+ * a squaring with REDC per bit of N-1, and a doubling with a conditional
+ * subtraction for each 1 bit.  The result is compared with R mod N, so the
+ * value never leaves Montgomery form.
+ * The kernel is inlined for the usual limb counts 16/24/32/64, so the
+ * loop bounds are constants there.
+ *
+ * @note v1.11.0 (2026-10-16): Add mpn Montgomery Fermat filter
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_fermat.h"
+
+/**
+ * @brief -N^-1 mod B for odd N
+ *
+ * @param[in] n0 Lowest limb of N
+ *
+ * @return ninv, with n0 * ninv = -1 (mod B)
+ */
+static mp_limb_t mont_ninv(mp_limb_t n0)
+{
+	mp_limb_t inv = n0;				// 3 bits: n0 * n0 = 1 (mod 8)
+	int       i;
+
+	for (i = 0; i < 5; i++) {			// Newton: 3, 6, 12, 24, 48, 96 bits
+		inv *= 2 - n0 * inv;
+	}
+
+	return -inv;
+}
+
+/**
+ * @brief rp = ap^2 / R mod N
+ *
+ * @param[out]    rp   Result (may be ap), < N
+ * @param[in]     ap   Operand, < N
+ * @param[in]     np   N
+ * @param[in]     ninv -N^-1 mod B
+ * @param[in,out] tp   Scratch of 2n limbs
+ * @param[in]     n    Number of limbs
+ */
+static inline __attribute__((always_inline))
+void mont_sqr(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *np,
+	      mp_limb_t ninv, mp_limb_t *tp, mp_size_t n)
+{
+	mp_limb_t cy;
+	mp_size_t i;
+
+	mpn_sqr(tp, ap, n);
+	for (i = 0; i < n; i++) {			// REDC: clear the low limbs
+		tp[i] = mpn_addmul_1(tp + i, np, n, tp[i] * ninv);	// keep the carry in tp[i]
+	}
+	cy = mpn_add_n(rp, tp + n, tp, n);		// high half + carries, < 2N
+	if (cy || mpn_cmp(rp, np, n) >= 0) {
+		mpn_sub_n(rp, rp, np, n);
+	}
+}
+
+/**
+ * @brief Fermat kernel for n limbs
+ *
+ * @param[in,out] fm Scratch, fm->np holds N
+ * @param[in]     n  Number of limbs of N
+ *
+ * @return 1 if 2^(N-1) = 1 (mod N), 0 otherwise
+ */
+static inline __attribute__((always_inline))
+int fermat_kernel(OASIS_FERMAT *fm, mp_size_t n)
+{
+	mp_limb_t *np = fm->np;
+	mp_limb_t *xp = fm->xp;
+	mp_limb_t  ninv = mont_ninv(np[0]);
+	mp_limb_t  cy;
+	long       b;
+	long       nbits = (long)(n - 1) * GMP_NUMB_BITS + (GMP_NUMB_BITS - __builtin_clzl(np[n - 1]));
+
+	/*--- one = B^n mod N, xp = 2*B^n mod N (top bit of N-1) ---*/
+	memset(fm->tp, 0, n * sizeof(mp_limb_t));
+	fm->tp[n] = 1;
+	mpn_tdiv_qr(fm->qp, fm->one, 0, fm->tp, n + 1, np, n);
+	cy = mpn_lshift(xp, fm->one, n, 1);
+	if (cy || mpn_cmp(xp, np, n) >= 0) {
+		mpn_sub_n(xp, xp, np, n);
+	}
+
+	/*--- N-1 differs from N only in bit 0 ---*/
+	for (b = nbits - 2; b >= 0; b--) {
+		mont_sqr(xp, xp, np, ninv, fm->tp, n);
+		if (b > 0 && (np[b / GMP_NUMB_BITS] >> (b % GMP_NUMB_BITS) & 1)) {
+			cy = mpn_lshift(xp, xp, n, 1);	// x *= 2
+			if (cy || mpn_cmp(xp, np, n) >= 0) {
+				mpn_sub_n(xp, xp, np, n);
+			}
+		}
+	}
+
+	return (mpn_cmp(xp, fm->one, n) == 0);
+}
+
+/**
+ * @brief Initialize the scratch
+ *
+ * @param[out] fm Scratch
+ */
+void oasis_fermat_init(OASIS_FERMAT *fm)
+{
+	memset(fm, 0, sizeof(*fm));
+}
+
+/**
+ * @brief Base-2 Fermat test
+ *
+ * @param[in,out] fm Scratch of the calling thread
+ * @param[in]     N  Candidate, odd
+ *
+ * @return 1 if N is a base-2 Fermat probable prime, 0 if N is composite
+ *
+ * @note A prime passes always, so the test only filters composites before
+ *       mpz_probab_prime_p() (or the proof of oasis_prove.h).
+ *       N <= 3 and N larger than OASIS_FERMAT_MAX_LIMBS limbs pass unchecked.
+ */
+int oasis_fermat(OASIS_FERMAT *fm, mpz_t N)
+{
+	mp_size_t n = (mp_size_t)mpz_size(N);
+	int       ret;
+
+	if ((mpz_cmp_ui(N, 3) <= 0) || (n > OASIS_FERMAT_MAX_LIMBS)) return 1;
+	if (mpz_even_p(N)) return 0;
+
+	memcpy(fm->np, mpz_limbs_read(N), n * sizeof(mp_limb_t));
+	switch (n) {
+	case 16: ret = fermat_kernel(fm, 16); break;	// d701  ~ 1024 bits
+	case 24: ret = fermat_kernel(fm, 24); break;	//       ~ 1536 bits
+	case 32: ret = fermat_kernel(fm, 32); break;	// d1429 ~ 2048 bits
+	case 64: ret = fermat_kernel(fm, 64); break;	//       ~ 4096 bits
+	default: ret = fermat_kernel(fm, n);  break;
+	}
+	fm->cnt++;
+	fm->pass += ret;
+
+	return ret;
+}
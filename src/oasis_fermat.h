@@ -0,0 +1,37 @@
+/**
+ * @file oasis_fermat.h
+ * @brief Base-2 Fermat test of the oasis candidates on fixed-width mpn.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * All candidates of a scan have the same number of limbs (d701: 16 limbs,
+ * d1429: 32 limbs), so the test works on preallocated limb arrays with
+ * Montgomery reduction.  With base 2 the multiplication step of the
+ * exponentiation is a doubling (one shift), and only the squarings remain.
+ *
+ * @note v1.11.0 (2026-10-16): Add mpn Montgomery Fermat filter
+ */
+
+#ifndef _OASIS_FERMAT_H
+#define _OASIS_FERMAT_H
+
+#include <stdint.h>
+#include <gmp.h>
+
+#define OASIS_FERMAT_MAX_LIMBS	(64)		// 4096 bits, larger N use mpz_powm()
+
+/* Scratch of a thread: no allocation per candidate */
+typedef struct {
+	mp_limb_t	np[OASIS_FERMAT_MAX_LIMBS];		// N
+	mp_limb_t	one[OASIS_FERMAT_MAX_LIMBS];		// R mod N (Montgomery form of 1)
+	mp_limb_t	xp[OASIS_FERMAT_MAX_LIMBS];		// 2^e (Montgomery form)
+	mp_limb_t	tp[2 * OASIS_FERMAT_MAX_LIMBS + 2];	// square / remainder
+	mp_limb_t	qp[OASIS_FERMAT_MAX_LIMBS + 2];		// quotient
+	uint64_t	cnt;					// number of tests
+	uint64_t	pass;					// number of probable primes
+} OASIS_FERMAT;
+
+void oasis_fermat_init(OASIS_FERMAT *fm);
+int  oasis_fermat(OASIS_FERMAT *fm, mpz_t N);
+
+#endif  // _OASIS_FERMAT_H
@@ -7,6 +7,18 @@
  * This program demonstrates finding prime numbers within prime deserts
  * using the innovative LCM method - a constructive (non-sieve) approach.
  *
+ * @note v1.32.1 (2026-10-16): SIGTERM stops the search like Ctrl+C (see oasis_ctl.h)
+ *       Add --checkpoint <file> / --resume <file> (see oasis_ckpt.h), as prime_oasis
+ *
+ * @note v1.30.0 (2026-10-16): The hits are written through an output stream (see oasis_out.h)
+ *
+ * @note v1.24.0 (2026-10-16): Ctrl+C, 'q' and ESC are taken by a control thread (see oasis_ctl.h),
+ *       SIGUSR1 prints the progress to stderr
+ *
+ * @note v1.18.0 (2026-10-16): Scan with the engine of liboasis (see oasis_engine.h)
+ *
+ * @note v1.15.0 (2026-10-16): Take LCM(1,2,3,...,n) from the LCM table (see oasis_lcm.h)
+ *
  * @note v1.4.2 (2026-01-02): Enhanced user interaction and twin prime display
  *       1. Keyboard interrupt support: Press 'q', 'Q', ESC, or Ctrl+C to stop
  *       2. Non-blocking keyboard input check during computation
@@ -26,9 +38,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <gmp.h>
-#include <termios.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
 
 #define MAX_HIT_COUNT (32000)
 
@@ -36,85 +48,85 @@
 #include "xpt.h"
 int xpt_flg = 0;
 
-#define make_lcm(A, B) {		\
-	mpz_set_ui(A, 1);		\
-	for (int i = 2; i <= B; i++) {	\
-		mpz_lcm_ui(A, A, i);	\
-	}				\
-}
-	
-/* Global variables: interrupt flag and terminal settings */
-static volatile sig_atomic_t interrupted = 0;
-static struct termios orig_termios;
-static int tty_configured = 0;
+#include "oasis_lcm.h"
+#include "oasis_engine.h"
+#include "oasis_out.h"
+#include "oasis_ctl.h"
+#include "oasis_ckpt.h"
 
-/**
- * @brief Signal handler for Ctrl+C (SIGINT)
- */
-void signal_handler(int sig)
-{
-	(void)sig; // Suppress unused parameter warning
-	interrupted = 1;
-}
+static OASIS_OUT out[1];			// stdout of the hits
+
+/* Global variables: --checkpoint/--resume option */
+static const char *ckpt_file = NULL;		// checkpoint file (NULL: off)
+static int         resume    = 0;		// --resume
+static OASIS_CKPT  ckpt[1];			// position, counters and output
 
 /**
- * @brief Enable terminal raw mode for non-blocking input
+ * @brief Print a hit (hit callback of the engine)
+ *
+ * @return nonzero to stop the search at MAX_HIT_COUNT hits
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the line is counted in the
+ *       checkpoint
+ *
+ * @note Modified in v1.30.0 (2026-10-16): written through the output stream
+ *
+ * @note Added in v1.18.0 (2026-10-16)
  */
-void enable_raw_mode(void)
+static int on_hit(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags)
 {
-	struct termios raw;
-
-	if (!isatty(STDIN_FILENO)) return;
-
-	tcgetattr(STDIN_FILENO, &orig_termios);
-	tty_configured = 1;
+	int len;
 
-	raw = orig_termios;
-	raw.c_lflag &= ~(ICANON | ECHO); // Disable canonical mode and echo
-	raw.c_cc[VMIN] = 0;  // Non-blocking
-	raw.c_cc[VTIME] = 0; // No timeout
-
-	tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+	(void)n;
+	(void)k;
+	(void)sign;
+	len = oasis_out_printf(out, NULL, "oasis prime%c = %Zd\n", (flags & OASIS_HIT_TWIN)? 's': ' ', x);
+	if (len > 0) ckpt->lines++;			// the output lines of the checkpoint
+	return ((OASIS_ENGINE *)arg)->st->hit_cnt >= MAX_HIT_COUNT;
 }
 
 /**
- * @brief Restore original terminal settings
+ * @brief Print the progress on SIGUSR1 (stat callback of the engine)
+ *
+ * @note Added in v1.24.0 (2026-10-16)
  */
-void disable_raw_mode(void)
+static void on_stat(void *arg, const OASIS_ENG_PROG *pg)
 {
-	if (tty_configured) {
-		tcsetattr(STDIN_FILENO, TCSAFLUSH, &orig_termios);
-		tty_configured = 0;
-	}
+	(void)arg;
+	if (pg->req) oasis_engine_prog_print(stderr, "oasis_layer3", pg, 0);
 }
 
 /**
- * @brief Check for keyboard input (non-blocking)
- * @return Character code of pressed key, or 0 if no input
+ * @brief Save the checkpoint
+ *
+ * @param[in] eng  Scan
+ * @param[in] next First desert that has not been searched
+ *
+ * @note Added in v1.32.1 (2026-10-16): stdout is flushed first, so the
+ *       output always covers the checkpoint.
  */
-int check_key_pressed(void)
+static void save_checkpoint(const OASIS_ENGINE *eng, uint64_t next)
 {
-	char c;
-	int n = read(STDIN_FILENO, &c, 1);
-	if (n == 1) {
-		return (int)(unsigned char)c;
+	ckpt->next     = next;
+	ckpt->try_cnt  = eng->st->try_cnt;
+	ckpt->hit_cnt  = eng->st->hit_cnt;
+	ckpt->twin_cnt = eng->st->twin_cnt;
+	fflush(stdout);
+	oasis_out_flush(out);
+	oasis_ckpt_mark(ckpt, STDOUT_FILENO);
+	if (oasis_ckpt_save(ckpt_file, ckpt) != 0) {
+		XPT(XPT_WRN, "WRN: checkpoint '%s' not saved\n", ckpt_file);
 	}
-	return 0;
 }
 
 /**
- * @brief Check if interrupt has been requested
- * @return 1 if should interrupt, 0 to continue
+ * @brief Save the checkpoint (sync callback of the engine)
+ *
+ * @note Added in v1.32.1 (2026-10-16)
  */
-int should_interrupt(void)
+static void on_sync(void *arg, uint64_t next)
 {
-	if (interrupted) return 1;
-
-	int key = check_key_pressed();
-	if (key == 'q' || key == 'Q' || key == 27) { // 27 = ESC
-		return 1;
-	}
-	return 0;
+	save_checkpoint((OASIS_ENGINE *)arg, next);
 }
 
 /**
@@ -124,6 +136,24 @@ int should_interrupt(void)
  * @param[in] end   Lower boundary of the prime gap (botom lcm)
  * @param[in] step  Search increment (smaller lcm)
  *
+ * @note Modified in v1.32.1 (2026-10-16):
+ *       - The search starts at ckpt->next with the counters of ckpt
+ *         (--resume, stdout cut back to the checkpoint), and the checkpoint
+ *         is saved every OASIS_CKPT_SEC seconds and at the end (--checkpoint)
+ *       - The search is not started if stdout is the file of the
+ *         checkpoint but cannot be cut back to it (shorter than it)
+ *
+ * @note Modified in v1.30.0 (2026-10-16):
+ *       - The hits are written by the thread of the output stream, which
+ *         is closed (all hits written) before anything else is printed
+ *
+ * @note Modified in v1.24.0 (2026-10-16):
+ *       - The interrupt is taken by the control thread (see oasis_ctl.h)
+ *         instead of polling the keyboard from the scan
+ *
+ * @note Modified in v1.18.0 (2026-10-16):
+ *       - The scan is done by the engine (see oasis_engine.h)
+ *
  * @note Modified in v1.4.2 (2026-01-02):
  *       - Added keyboard interrupt checking in main loop (every 100 iterations)
  *       - Added twin prime counter and statistics display
@@ -136,88 +166,134 @@ int should_interrupt(void)
  *
  * @note All mpz_t parameters must be initialized before calling
  * @details Search for primes in the form: pit +- 1, where pit = start + k*step
+ *
+ * @return 0 on success, -8 if stdout does not match the checkpoint
+ *         (--resume), -7 on memory allocation failure
  */
-void find_prime_oasis(mpz_t start, mpz_t end, mpz_t step)
+int find_prime_oasis(mpz_t start, mpz_t end, mpz_t step)
 {
-	int twin_flag;
-	int twin_cnt = 0;
-	int try_cnt  = 0;
-	int hit_cnt  = 0;
-	int loop_cnt = 0;
-
+	OASIS_ENGINE eng[1];
+	OASIS_CTL    ctl[1];
 	mpz_t pit;
-	mpz_t p1;	// plus 1
-	mpz_t m1;	// minus 1
 
 	mpz_init(pit);
-	mpz_init(p1);
-	mpz_init(m1);
-
-	mpz_set_ui(p1, 0);				// p1 = 0;
-	for (mpz_set(pit, start);			// for (pit =  start
-	     mpz_cmp(pit, end) <= 0;			//      pit <= end
-	     mpz_add(pit, pit, step)) {			//      pit += step) {
-
-	   /* Periodically check for interrupt (every 100 iterations) */
-	   if (++loop_cnt % 100 == 0) {
-	      loop_cnt = 0;
-	      if (should_interrupt()) {
-	         printf("\n\n*** Interrupted by user ***\n");
-		 printf("Current position: ");
-		 gmp_printf("pit = %Zd\n", pit);
-		 break;
-	      }
-	   }
-
-           twin_flag = 0;				//
-	   if (mpz_cmp(pit, start) != 0) {		//    if (pit != start) {
-	      mpz_sub_ui(m1, pit, 1);			//       m1 = pit - 1;
-	      if (mpz_cmp(m1, p1) == 0) {		//       if (m1 == p1) {
-	         ;					//          nothing to do.
-	      }						//       }
-              else {					//       else  {
-		 try_cnt++;				//
-	         if (mpz_probab_prime_p(m1, 25)) {	//          prime?
-		    hit_cnt++;				//
-		    gmp_printf("oasis prime  = %Zd\n", m1);
-		    twin_flag = 1;			//
-		    if (hit_cnt >= MAX_HIT_COUNT) break;
-	         }
-	      }
-	   }
-
-	   if (mpz_cmp(pit, end) != 0) {		//    if (pit != end) {
-	      mpz_add_ui(p1, pit, 1);			//       p1 = pit + 1;
-	      try_cnt++;				//
-	      if (mpz_probab_prime_p(p1, 25)) {		//          prime?
-		 hit_cnt++;				//
-		 gmp_printf("oasis prime%c = %Zd\n", (twin_flag)? 's':' ', p1);
-		 if (twin_flag) twin_cnt++;		//
-		 if (hit_cnt >= MAX_HIT_COUNT) break;
-	      }
-           }
+	oasis_engine_init(eng);
+	oasis_engine_range(eng, start, end, step);	// pit = start + k * step <= end
+	eng->hit  = on_hit;
+	eng->stat = on_stat;
+	eng->sync = on_sync;
+	eng->arg  = eng;
+	eng->k_start  = ckpt->next;			// 0 unless --resume
+	eng->sync_sec = (ckpt_file)? OASIS_CKPT_SEC: 0;
+	eng->st->try_cnt  = ckpt->try_cnt;
+	eng->st->hit_cnt  = ckpt->hit_cnt;
+	eng->st->twin_cnt = ckpt->twin_cnt;
+
+	if (resume && oasis_ckpt_cut(ckpt, STDOUT_FILENO) < 0) {	// before stdout is flushed
+		fprintf(stderr, "ERR: stdout does not match the checkpoint '%s'\n", ckpt_file);
+		oasis_engine_clear(eng);
+		mpz_clear(pit);
+		return -8;
+	}
+	fflush(stdout);
+	if (oasis_out_open(out, STDOUT_FILENO, 0) != 0) {
+		printf("ERR: Out of memory\n");
+		oasis_engine_clear(eng);
+		mpz_clear(pit);
+		return -7;
+	}
+	oasis_ctl_start(ctl, eng, OASIS_CTL_KEYS);
+	oasis_engine_run(eng);
+	oasis_out_close(out);				// all hits written, the interrupt still taken
+	oasis_ctl_end(ctl);
+	if (ckpt_file) {				// stdout is cut back to here by --resume
+		save_checkpoint(eng, eng->k_end);
+	}
+	if (eng->k_end < eng->num && eng->st->hit_cnt < MAX_HIT_COUNT) {
+		mpz_mul_ui(pit, step, eng->k_end);
+		mpz_add(pit, pit, start);
+		printf("\n\n*** Interrupted by user ***\n");
+		printf("Current position: ");
+		gmp_printf("pit = %Zd\n", pit);
 	}
-	printf("(try=%d, hit=%d, twin=%d)\n", try_cnt, hit_cnt, twin_cnt); 
+	printf("(try=%lu, hit=%lu, twin=%lu)\n", eng->st->try_cnt, eng->st->hit_cnt, eng->st->twin_cnt); 
 
+	oasis_engine_clear(eng);
 	mpz_clear(pit);
-	mpz_clear(p1);
-	mpz_clear(m1);
+
+	return 0;
+}
+
+/**
+ * @brief Display usage information
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_layer3 [--checkpoint <file>]\n");
+	printf("       oasis_layer3 --resume <file>\n\n");
+	printf("---< OPTIONS:\n");
+	printf("       --checkpoint <file>  Save the position of the search every %d seconds and at the end\n", OASIS_CKPT_SEC);
+	printf("       --resume <file>      Continue the search of the checkpoint (and keep saving it)\n");
+	printf("---< CAUTION:\n");
+	printf("       1) Ctrl+C, 'q' and SIGTERM stop the search with every prime written and save the\n");
+	printf("          checkpoint. After a kill -9, --resume cuts stdout redirected with >> back to\n");
+	printf("          the checkpoint, so no line is written twice. Lines to a terminal or a pipe\n");
+	printf("          after the last checkpoint ('lines=' in <file>) are written again.\n");
+	printf("       2) kill -USR1 <pid> prints the progress to stderr.\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Parse the options
+ *
+ * @return 0 on success, -4 on an invalid option
+ *
+ * @details --checkpoint <file>: save the checkpoint of the search
+ *          --resume <file>: continue the search of the checkpoint
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+static int check_option(int argc, char *argv[])
+{
+	int ret = 0;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--checkpoint") == 0)	// --checkpoint <file>
+		||  (strcmp(argv[i], "--resume") == 0)) {	// --resume <file>
+			if (i + 1 >= argc) {
+				printf("ERR: %s needs <file>\n", argv[i]);
+				ret = -4;
+			}
+			else {
+				resume   |= (strcmp(argv[i], "--resume") == 0);
+				ckpt_file = argv[++i];
+			}
+		}
+		else {
+			printf("ERR: Unknown option '%s'\n", argv[i]);
+			ret = -4;
+		}
+	}
+
+	return ret;
 }
 
 /**
  * @brief Main entry point
+ *
+ * @note Modified in v1.32.1 (2026-10-16): --checkpoint <file>, --resume <file>
  */
-int main()
+int main(int argc, char *argv[])
 {
+	int ret;
 	mpz_t start;
 	mpz_t end;
 	mpz_t step;
 
-	/* Setup signal handler and raw mode */
-	signal(SIGINT, signal_handler);
-	enable_raw_mode();
-	atexit(disable_raw_mode); // Automatically restore on exit
-
 	XPT_INIT();
 
 	printf("Prime Oasis Layer 3 - Press 'q', ESC, or Ctrl+C to interrupt\n");
@@ -227,15 +303,36 @@ int main()
 	mpz_init(end);
 	mpz_init(step);
 
-	make_lcm(start, 701);				// start = lcm(1,2,3,..,701), around 2^1024
-	mpz_mul_ui(end, start, 2);		        // end   = start*2;
-	make_lcm(step,  677);				// step  = lcm(1,2,3,..,677)
-						
-        find_prime_oasis(start, end, step);		// display prime oasis.
+	ret = check_option(argc, argv);
+	if (ret == 0 && resume) {
+		if ((oasis_ckpt_load(ckpt_file, ckpt) != 0)
+		||  (strcmp(ckpt->prog, "oasis_layer3") != 0)) {
+			printf("ERR: '%s' is not a checkpoint of oasis_layer3\n", ckpt_file);
+			ret = -5;
+		}
+		else {
+			printf("Resume: %lu deserts done\n\n", ckpt->next);
+		}
+	}
+	if (ret == 0 && ckpt_file) {
+		snprintf(ckpt->prog, sizeof(ckpt->prog), "oasis_layer3");
+		snprintf(ckpt->args, sizeof(ckpt->args), "701 677");	// fixed <start> <step>
+	}
+
+	if (ret) {	// err?
+		disp_usage();
+	}
+	else {
+		oasis_lcm_get(start, 701);		// start = lcm(1,2,3,..,701), around 2^1024
+		mpz_mul_ui(end, start, 2);		// end   = start*2;
+		oasis_lcm_get(step,  677);		// step  = lcm(1,2,3,..,677)
+
+		ret = find_prime_oasis(start, end, step);	// display prime oasis.
+	}
 
 	mpz_clear(start);
 	mpz_clear(end);
 	mpz_clear(step);
 
-	return 0;
+	return ret;
 }
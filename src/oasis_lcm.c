@@ -0,0 +1,508 @@
+/**
+ * @file oasis_lcm.c
+ * @brief Memory-mapped table of d<n> = LCM(1,2,3,...,n).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * @note v1.16.0 (2026-10-16): Add product-tree builder oasis_lcm_build()
+ * @note v1.15.0 (2026-10-16): Add LCM table
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gmp.h>
+
+#include "oasis_lcm.h"
+#include "oasis_sieve.h"
+
+#define ALIGN8(X)	(((X) + 7) & ~(uint64_t)7)
+
+/* Global variables: table of oasis_lcm_get() */
+static OASIS_LCM lcm_tab[1];
+static int       lcm_tried = 0;		// 1: lcm_tab has been opened (or failed)
+
+/**
+ * @brief Offsets of the parts of a table
+ *
+ * @param[in]  n_max   Largest n
+ * @param[in]  nent    Number of entries
+ * @param[in]  nprm    Number of primes
+ * @param[out] o_idx   Offset of idx
+ * @param[out] o_ent   Offset of ent
+ * @param[out] o_prm   Offset of prm
+ * @param[out] o_limbs Offset of limbs
+ */
+static void lcm_layout(uint32_t n_max, uint32_t nent, uint32_t nprm,
+		       uint64_t *o_idx, uint64_t *o_ent, uint64_t *o_prm, uint64_t *o_limbs)
+{
+	*o_idx   = ALIGN8(sizeof(OASIS_LCM_HDR));
+	*o_ent   = ALIGN8(*o_idx + ((uint64_t)n_max + 1) * sizeof(uint32_t));
+	*o_prm   = ALIGN8(*o_ent + (uint64_t)nent * sizeof(OASIS_LCM_ENT));
+	*o_limbs = ALIGN8(*o_prm + (uint64_t)nprm * sizeof(uint32_t));
+}
+
+/**
+ * @brief Map a table read-only
+ *
+ * @param[out] tab  Table
+ * @param[in]  path Table file
+ *
+ * @return 0 on success, -1 if the file cannot be mapped or is not a table
+ *         of this build (version, limb size)
+ */
+int oasis_lcm_open(OASIS_LCM *tab, const char *path)
+{
+	const OASIS_LCM_HDR *hdr;
+	const OASIS_LCM_ENT *last;
+	struct stat st;
+	uint64_t o_idx, o_ent, o_prm, o_limbs;
+	int fd;
+
+	memset(tab, 0, sizeof(*tab));
+	fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(OASIS_LCM_HDR)) {
+		close(fd);
+		return -1;
+	}
+	tab->map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (tab->map == MAP_FAILED) {
+		tab->map = NULL;
+		return -1;
+	}
+	tab->size = st.st_size;
+
+	hdr = (const OASIS_LCM_HDR *)tab->map;
+	lcm_layout(hdr->n_max, hdr->nent, hdr->nprm, &o_idx, &o_ent, &o_prm, &o_limbs);
+	if ((memcmp(hdr->magic, OASIS_LCM_MAGIC, sizeof(hdr->magic)) != 0)
+	||  (hdr->version != OASIS_LCM_VERSION) || (hdr->limb_bits != GMP_NUMB_BITS)
+	||  (hdr->size != tab->size) || (hdr->nent == 0) || (o_limbs > tab->size)) {
+		oasis_lcm_close(tab);
+		return -1;
+	}
+	tab->hdr   = hdr;
+	tab->idx   = (const uint32_t *)((const char *)tab->map + o_idx);
+	tab->ent   = (const OASIS_LCM_ENT *)((const char *)tab->map + o_ent);
+	tab->prm   = (const uint32_t *)((const char *)tab->map + o_prm);
+	tab->limbs = (const mp_limb_t *)((const char *)tab->map + o_limbs);
+
+	last = &tab->ent[hdr->nent - 1];		// limbs in the file?
+	if (o_limbs + (last->off + last->len) * sizeof(mp_limb_t) > tab->size) {
+		oasis_lcm_close(tab);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Unmap a table
+ */
+void oasis_lcm_close(OASIS_LCM *tab)
+{
+	if (tab->map) munmap(tab->map, tab->size);
+	memset(tab, 0, sizeof(*tab));
+}
+
+/**
+ * @brief Take LCM(1,2,3,...,n) from a table
+ *
+ * @param[in]  tab Table
+ * @param[out] lcm LCM(1,2,3,...,n)
+ * @param[in]  n   n
+ *
+ * @return 0 on success, -1 if n is not in the table (lcm is unchanged)
+ */
+int oasis_lcm_find(const OASIS_LCM *tab, mpz_t lcm, int n)
+{
+	const OASIS_LCM_ENT *ent;
+	mpz_t v;
+
+	if ((tab->map == NULL) || (n < 0) || ((uint32_t)n > tab->hdr->n_max)) return -1;
+
+	ent = &tab->ent[tab->idx[n]];
+	mpz_set(lcm, mpz_roinit_n(v, tab->limbs + ent->off, (mp_size_t)ent->len));
+
+	return 0;
+}
+
+/**
+ * @brief Product of q[lo..hi) by a balanced binary tree
+ *
+ * @param[out] r  Product
+ * @param[in]  q  Prime powers
+ * @param[in]  lo First index
+ * @param[in]  hi End index (exclusive)
+ *
+ * @details The leaves multiply machine words as long as they do not
+ *          overflow, so the tree starts with operands of a few limbs and
+ *          every level multiplies two operands of about the same size.
+ */
+static void lcm_prod(mpz_t r, const unsigned long *q, size_t lo, size_t hi)
+{
+	mpz_t         t;
+	size_t        mid, i;
+	unsigned long w;
+
+	if (hi - lo <= OASIS_LCM_LEAF) {
+		mpz_set_ui(r, 1);
+		for (i = lo, w = 1; i < hi; i++) {
+			if (w > ULONG_MAX / q[i]) {		// word full?
+				mpz_mul_ui(r, r, w);
+				w = 1;
+			}
+			w *= q[i];
+		}
+		mpz_mul_ui(r, r, w);
+		return;
+	}
+
+	mid = lo + (hi - lo) / 2;
+	mpz_init(t);
+	lcm_prod(r, q, lo, mid);
+	lcm_prod(t, q, mid, hi);
+	mpz_mul(r, r, t);
+	mpz_clear(t);
+}
+
+/* A part of the product tree for a thread */
+typedef struct {
+	const unsigned long *q;
+	size_t		     lo;
+	size_t		     hi;
+	mpz_t		     r;
+} LCM_PART;
+
+/**
+ * @brief Thread of oasis_lcm_build(): product of a part
+ */
+static void *lcm_part(void *arg)
+{
+	LCM_PART *pt = (LCM_PART *)arg;
+
+	lcm_prod(pt->r, pt->q, pt->lo, pt->hi);
+
+	return NULL;
+}
+
+/**
+ * @brief Build LCM(1,2,3,...,n) with a product tree of prime powers
+ *
+ * @param[out] lcm     LCM(1,2,3,...,n), 1 for n < 2
+ * @param[in]  n       n
+ * @param[in]  threads Number of threads (0: number of CPUs)
+ * @param[out] fac     Factorization of lcm (NULL: not needed),
+ *                     released by oasis_lcm_fac_clear()
+ *
+ * @return 0 on success, -1 on memory allocation failure
+ *
+ * @details The primes p <= n are sieved, q = p^floor(log_p n), and the q
+ *          are multiplied by a balanced tree: O(M(n) log n) instead of the
+ *          n LCM operations of a gcd each.  The leaves of the tree are
+ *          split into equal parts for the threads, and the parts are
+ *          multiplied by the same tree.  Small n use one thread.
+ */
+int oasis_lcm_build(mpz_t lcm, uint32_t n, int threads, OASIS_LCM_FAC *fac)
+{
+	LCM_PART      *pt;
+	pthread_t     *tid;
+	unsigned long *q;
+	uint32_t      *prm;
+	uint32_t       cnt, i;
+	size_t         lo;
+	int            t, nthr, step;
+
+	mpz_set_ui(lcm, 1);
+	if (fac) memset(fac, 0, sizeof(*fac));
+	if (n < 2) return 0;
+
+	prm = oasis_prime_table(n, &cnt);
+	q   = malloc(((size_t)cnt + 1) * sizeof(unsigned long));
+	if (fac && prm) {
+		fac->e = malloc(((size_t)cnt + 1) * sizeof(uint8_t));
+	}
+	if ((prm == NULL) || (q == NULL) || (fac && fac->e == NULL)) {
+		free(prm);
+		free(q);
+		if (fac) free(fac->e);
+		return -1;
+	}
+	for (i = 0; i < cnt; i++) {			// q = p^floor(log_p n)
+		for (q[i] = prm[i], t = 1; q[i] <= n / prm[i]; q[i] *= prm[i], t++);
+		if (fac) fac->e[i] = (uint8_t)t;
+	}
+
+	nthr = (threads > 0)? threads: (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthr > OASIS_LCM_THREADS_MAX) nthr = OASIS_LCM_THREADS_MAX;
+	if ((n < OASIS_LCM_PAR_MIN) || (nthr < 2)) nthr = 1;
+
+	pt  = calloc(nthr, sizeof(LCM_PART));
+	tid = calloc(nthr, sizeof(pthread_t));
+	if ((pt == NULL) || (tid == NULL)) nthr = 0;	// one part in this thread
+
+	if (nthr <= 1) {
+		lcm_prod(lcm, q, 0, cnt);
+	}
+	else {
+		for (t = 0, lo = 0; t < nthr; t++) {	// equal parts of the leaves
+			pt[t].q  = q;
+			pt[t].lo = lo;
+			pt[t].hi = lo = (size_t)cnt * (t + 1) / nthr;
+			mpz_init(pt[t].r);
+			if (t > 0 && pthread_create(&tid[t], NULL, lcm_part, &pt[t]) != 0) {
+				tid[t] = 0;
+				lcm_part(&pt[t]);	// no thread: here
+			}
+		}
+		lcm_part(&pt[0]);
+		for (t = 1; t < nthr; t++) {
+			if (tid[t]) pthread_join(tid[t], NULL);
+		}
+		for (step = 1; step < nthr; step *= 2) {	// the tree over the parts
+			for (t = 0; t + step < nthr; t += 2 * step) {
+				mpz_mul(pt[t].r, pt[t].r, pt[t + step].r);
+			}
+		}
+		mpz_swap(lcm, pt[0].r);
+		for (t = 0; t < nthr; t++) {
+			mpz_clear(pt[t].r);
+		}
+	}
+	free(pt);
+	free(tid);
+	free(q);
+
+	if (fac) {
+		fac->cnt = cnt;
+		fac->p   = prm;
+	}
+	else {
+		free(prm);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Release the factorization of oasis_lcm_build()
+ */
+void oasis_lcm_fac_clear(OASIS_LCM_FAC *fac)
+{
+	free(fac->p);
+	free(fac->e);
+	memset(fac, 0, sizeof(*fac));
+}
+
+/**
+ * @brief Compute LCM(1,2,3,...,n)
+ *
+ * @param[out] lcm LCM(1,2,3,...,n), 1 for n < 2
+ * @param[in]  n   n
+ *
+ * @note Modified in v1.16.0 (2026-10-16): built by oasis_lcm_build()
+ *       (product tree, threads for large n).
+ */
+void oasis_lcm_calc(mpz_t lcm, int n)
+{
+	int i;
+
+	if (n < 2) {
+		mpz_set_ui(lcm, 1);
+	}
+	else if (oasis_lcm_build(lcm, (uint32_t)n, 0, NULL) != 0) {
+		mpz_set_ui(lcm, 1);			// out of memory: the plain way
+		for (i = 2; i <= n; i++) {
+			mpz_lcm_ui(lcm, lcm, i);
+		}
+	}
+}
+
+/**
+ * @brief Map the table of $OASIS_LCM (or OASIS_LCM_FILE) on the first call
+ */
+static void lcm_map(void)
+{
+	const char *path;
+
+	if (!lcm_tried) {
+		lcm_tried = 1;
+		path = getenv(OASIS_LCM_ENV);
+		oasis_lcm_open(lcm_tab, (path && *path)? path: OASIS_LCM_FILE);
+	}
+}
+
+/**
+ * @brief LCM(1,2,3,...,n) of the table of $OASIS_LCM (or OASIS_LCM_FILE)
+ *
+ * @param[out] lcm LCM(1,2,3,...,n), 1 for n < 2
+ * @param[in]  n   n
+ *
+ * @note The table is mapped on the first call; without the table, or for
+ *       n beyond it, the value is computed by oasis_lcm_calc().
+ */
+void oasis_lcm_get(mpz_t lcm, int n)
+{
+	lcm_map();
+	if (n < 2) {
+		mpz_set_ui(lcm, 1);
+	}
+	else if (oasis_lcm_find(lcm_tab, lcm, n) != 0) {
+		oasis_lcm_calc(lcm, n);
+	}
+}
+
+/**
+ * @brief Prime factorization of LCM(1,2,3,...,n)
+ *
+ * @param[in]  n   n
+ * @param[out] p   Primes p <= n, ascending
+ * @param[out] e   Exponents floor(log_p n)
+ * @param[in]  max Size of p[] and e[]
+ *
+ * @return Number of primes, -1 if max is too small or out of memory
+ *
+ * @note The primes come from the table of oasis_lcm_get() when it holds n.
+ */
+int oasis_lcm_factor(int n, uint32_t p[], int e[], int max)
+{
+	const uint32_t *prm;
+	uint32_t       *tbl = NULL;
+	uint32_t        cnt, i;
+	unsigned long   q;
+
+	if (n < 2) return 0;
+
+	lcm_map();
+	if (lcm_tab->map && (uint32_t)n <= lcm_tab->hdr->n_max) {
+		prm = lcm_tab->prm;
+		for (cnt = 0; cnt < lcm_tab->hdr->nprm && prm[cnt] <= (uint32_t)n; cnt++);
+	}
+	else {
+		prm = tbl = oasis_prime_table((uint32_t)n, &cnt);
+		if (tbl == NULL) return -1;
+	}
+
+	if (cnt > (uint32_t)max) {
+		free(tbl);
+		return -1;
+	}
+	for (i = 0; i < cnt; i++) {
+		p[i] = prm[i];
+		for (e[i] = 1, q = prm[i]; q <= (unsigned long)n / prm[i]; q *= prm[i], e[i]++);
+	}
+	free(tbl);
+
+	return (int)cnt;
+}
+
+/**
+ * @brief Make a table
+ *
+ * @param[in] path  Table file
+ * @param[in] n_max Largest n
+ *
+ * @return 0 on success, -1 on failure
+ *
+ * @note The file is written to <path>.tmp and renamed, so a reader never
+ *       maps a half-written table.
+ */
+int oasis_lcm_write(const char *path, int n_max)
+{
+	OASIS_LCM_HDR  hdr[1];
+	OASIS_LCM_ENT *ent;
+	uint32_t      *idx;
+	uint32_t      *prm;
+	uint32_t       nprm, nent, n, i, p;
+	uint64_t       o_idx, o_ent, o_prm, o_limbs, off;
+	unsigned long  q;
+	char           tmp[4096];
+	FILE          *fp;
+	mpz_t          lcm;
+	int            ret = 0;
+
+	if ((n_max < 2) || (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))) return -1;
+
+	prm = oasis_prime_table((uint32_t)n_max, &nprm);
+	idx = calloc((size_t)n_max + 1, sizeof(uint32_t));
+	ent = calloc((size_t)n_max + 1, sizeof(OASIS_LCM_ENT));
+	fp  = fopen(tmp, "wb");
+	if ((prm == NULL) || (idx == NULL) || (ent == NULL) || (fp == NULL)) {
+		free(prm);
+		free(idx);
+		free(ent);
+		if (fp) fclose(fp);
+		return -1;
+	}
+
+	/*--- entries: LCM() changes at q = p^e ---*/
+	for (i = 0; i < nprm; i++) {			// idx[q] = p for now
+		for (q = prm[i]; q <= (unsigned long)n_max; q *= prm[i]) {
+			idx[q] = prm[i];
+		}
+	}
+	ent[0].q   = 1;					// LCM() = 1 for n = 0, 1
+	ent[0].p   = 1;
+	ent[0].len = 1;
+	idx[0] = idx[1] = 0;
+	for (nent = 1, n = 2; n <= (uint32_t)n_max; n++) {
+		if ((p = idx[n]) != 0) {
+			ent[nent].q = n;
+			ent[nent].p = p;
+			nent++;
+		}
+		idx[n] = nent - 1;
+	}
+
+	/*--- limbs of the entries ---*/
+	lcm_layout((uint32_t)n_max, nent, nprm, &o_idx, &o_ent, &o_prm, &o_limbs);
+	mpz_init_set_ui(lcm, 1);
+	for (i = 0, off = 0; i < nent; i++) {
+		if (i > 0) mpz_mul_ui(lcm, lcm, ent[i].p);
+		ent[i].off = off;
+		ent[i].len = mpz_size(lcm);
+		off += ent[i].len;
+	}
+
+	memset(hdr, 0, sizeof(hdr));
+	memcpy(hdr->magic, OASIS_LCM_MAGIC, sizeof(hdr->magic));
+	hdr->version   = OASIS_LCM_VERSION;
+	hdr->limb_bits = GMP_NUMB_BITS;
+	hdr->n_max     = (uint32_t)n_max;
+	hdr->nent      = nent;
+	hdr->nprm      = nprm;
+	hdr->size      = o_limbs + off * sizeof(mp_limb_t);
+
+	ret |= (fwrite(hdr, sizeof(hdr), 1, fp) != 1);
+	ret |= (fseek(fp, (long)o_idx, SEEK_SET) != 0);
+	ret |= (fwrite(idx, sizeof(uint32_t), (size_t)n_max + 1, fp) != (size_t)n_max + 1);
+	ret |= (fseek(fp, (long)o_ent, SEEK_SET) != 0);
+	ret |= (fwrite(ent, sizeof(OASIS_LCM_ENT), nent, fp) != nent);
+	ret |= (fseek(fp, (long)o_prm, SEEK_SET) != 0);
+	ret |= (fwrite(prm, sizeof(uint32_t), nprm, fp) != nprm);
+	ret |= (fseek(fp, (long)o_limbs, SEEK_SET) != 0);
+	mpz_set_ui(lcm, 1);
+	for (i = 0; i < nent && ret == 0; i++) {
+		if (i > 0) mpz_mul_ui(lcm, lcm, ent[i].p);
+		ret |= (fwrite(mpz_limbs_read(lcm), sizeof(mp_limb_t), ent[i].len, fp) != ent[i].len);
+	}
+	mpz_clear(lcm);
+
+	ret |= (fclose(fp) != 0);
+	if (ret == 0 && rename(tmp, path) != 0) ret = 1;
+	if (ret != 0) remove(tmp);
+
+	free(prm);
+	free(idx);
+	free(ent);
+
+	return (ret == 0)? 0: -1;
+}
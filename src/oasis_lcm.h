@@ -0,0 +1,93 @@
+/**
+ * @file oasis_lcm.h
+ * @brief Memory-mapped table of d<n> = LCM(1,2,3,...,n).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * LCM(1,2,3,...,n) only changes at a prime power q = p^e, where it is
+ * multiplied by p, so the table holds one entry per prime power <= n_max:
+ *
+ *   header  OASIS_LCM_HDR: magic, version, limb size, n_max, counts
+ *   idx     uint32_t[n_max + 1]: entry of LCM(1,2,3,...,n)
+ *   ent     OASIS_LCM_ENT[nent]: prime power q, prime p, limbs of the value
+ *   prm     uint32_t[nprm]: primes <= n_max (the factorization of d<n> is
+ *           p^floor(log_p n) for the primes p <= n)
+ *   limbs   mp_limb_t[]: values of the entries
+ *
+ * The file is made once by oasis_lcm_gen and mapped read-only, so the
+ * pages are shared by all processes.  oasis_lcm_get() takes d<n> from the
+ * table of $OASIS_LCM (default OASIS_LCM_FILE) and computes it when the
+ * table or the entry is missing.
+ *
+ * d<n> beyond the table is built by oasis_lcm_build(): the prime powers
+ * p^floor(log_p n) are multiplied by a balanced product tree, split over
+ * threads for large n, and the factorization is returned with the value.
+ *
+ * @note v1.16.0 (2026-10-16): Add product-tree builder oasis_lcm_build()
+ * @note v1.15.0 (2026-10-16): Add LCM table
+ */
+
+#ifndef _OASIS_LCM_H
+#define _OASIS_LCM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#define OASIS_LCM_MAGIC		"OASISLCM"
+#define OASIS_LCM_VERSION	(1)
+#define OASIS_LCM_ENV		"OASIS_LCM"	// path of the table
+#ifndef OASIS_LCM_FILE
+#define OASIS_LCM_FILE		"oasis_lcm.bin"	// default path (set by CMake)
+#endif
+#define OASIS_LCM_N_MAX		(8192)		// default n_max of oasis_lcm_gen
+#define OASIS_LCM_LEAF		(16)		// prime powers per leaf of the product tree
+#define OASIS_LCM_PAR_MIN	(1 << 16)	// smallest n built with threads
+#define OASIS_LCM_THREADS_MAX	(64)
+
+typedef struct {
+	char		magic[8];		// OASIS_LCM_MAGIC (not terminated)
+	uint32_t	version;		// OASIS_LCM_VERSION
+	uint32_t	limb_bits;		// GMP_NUMB_BITS
+	uint32_t	n_max;			// largest n
+	uint32_t	nent;			// number of entries
+	uint32_t	nprm;			// number of primes <= n_max
+	uint32_t	reserved;
+	uint64_t	size;			// file size
+} OASIS_LCM_HDR;
+
+typedef struct {
+	uint32_t	q;			// prime power (1 for LCM() = 1)
+	uint32_t	p;			// prime of q
+	uint64_t	off;			// first limb (index into limbs)
+	uint64_t	len;			// number of limbs
+} OASIS_LCM_ENT;
+
+/* Factorization of LCM(1,2,3,...,n) */
+typedef struct {
+	uint32_t	 cnt;			// number of primes <= n
+	uint32_t	*p;			// primes, ascending
+	uint8_t		*e;			// exponents floor(log_p n)
+} OASIS_LCM_FAC;
+
+typedef struct {
+	void		    *map;		// mapped file (NULL: not open)
+	size_t		     size;
+	const OASIS_LCM_HDR *hdr;
+	const uint32_t	    *idx;
+	const OASIS_LCM_ENT *ent;
+	const uint32_t	    *prm;
+	const mp_limb_t	    *limbs;
+} OASIS_LCM;
+
+int  oasis_lcm_open(OASIS_LCM *tab, const char *path);
+void oasis_lcm_close(OASIS_LCM *tab);
+int  oasis_lcm_find(const OASIS_LCM *tab, mpz_t lcm, int n);
+int  oasis_lcm_write(const char *path, int n_max);
+int  oasis_lcm_build(mpz_t lcm, uint32_t n, int threads, OASIS_LCM_FAC *fac);
+void oasis_lcm_fac_clear(OASIS_LCM_FAC *fac);
+void oasis_lcm_calc(mpz_t lcm, int n);
+void oasis_lcm_get(mpz_t lcm, int n);
+int  oasis_lcm_factor(int n, uint32_t p[], int e[], int max);
+
+#endif  // _OASIS_LCM_H
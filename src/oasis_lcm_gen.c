@@ -0,0 +1,236 @@
+/**
+ * @file oasis_lcm_gen.c
+ * @brief Make the LCM table of d<n> = LCM(1,2,3,...,n).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The table (see oasis_lcm.h) is made once, at build time, and mapped by
+ * the other commands.
+ *
+ * @note v1.16.0 (2026-10-16): Add --bench
+ *       1. --bench [-j <threads>] [<n>]: time the LCM builders for n = 10^3..<n>
+ *
+ * @note v1.15.0 (2026-10-16): Add oasis_lcm_gen command
+ *       1. Specify the table file and n_max as arguments to the command
+ *       2. Display USAGE message
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <gmp.h>
+
+#define XPT_ON
+#include "xpt.h"
+int xpt_flg = 0;
+
+#include "oasis_lcm.h"
+#include "oasis_sieve.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_INVL	(-5)	// Invalid value
+#define ERR_FILE	(-2)	// Table cannot be written
+
+#define LCM_GEN_N_LIMIT	(65536)		// largest n_max (a table of ~40 MB)
+#define BENCH_N_MAX	(1000000)	// default largest n of --bench
+#define BENCH_LCM_MAX	(100000)	// largest n of the mpz_lcm_ui() loop (too slow beyond)
+#define BENCH_SEC	(0.2)		// repeat each measurement for this long
+
+/**
+ * @brief Elapsed time in seconds
+ */
+static double now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Time one LCM builder
+ *
+ * @param[out] lcm     LCM(1,2,3,...,n)
+ * @param[in]  n       n
+ * @param[in]  method  0: mpz_lcm_ui() loop (make_lcm), 1: mpz_mul_ui() of the
+ *                     prime powers, 2: product tree
+ * @param[in]  threads Threads of the product tree
+ *
+ * @return Seconds per build (best of the repetitions)
+ */
+static double bench_one(mpz_t lcm, int n, int method, int threads)
+{
+	uint32_t     *prm;
+	uint32_t      cnt, j;
+	unsigned long q;
+	double        t0, t1, best = 1e30, total = 0.0;
+	int           i;
+
+	do {
+		t0 = now_sec();
+		switch (method) {
+		case 0:
+			mpz_set_ui(lcm, 1);
+			for (i = 2; i <= n; i++) {
+				mpz_lcm_ui(lcm, lcm, i);
+			}
+			break;
+		case 1:
+			prm = oasis_prime_table((uint32_t)n, &cnt);
+			mpz_set_ui(lcm, 1);
+			for (j = 0; prm && j < cnt; j++) {
+				for (q = prm[j]; q <= (unsigned long)n / prm[j]; q *= prm[j]);
+				mpz_mul_ui(lcm, lcm, q);
+			}
+			free(prm);
+			break;
+		default:
+			oasis_lcm_build(lcm, (uint32_t)n, threads, NULL);
+			break;
+		}
+		t1 = now_sec();
+		if (t1 - t0 < best) best = t1 - t0;
+		total += t1 - t0;
+	} while (total < BENCH_SEC);
+
+	return best;
+}
+
+/**
+ * @brief Time the LCM builders for n = 10^3, 10^4, ... <= n_max
+ *
+ * @param[in] n_max   Largest n
+ * @param[in] threads Threads of the parallel product tree
+ *
+ * @return ERR_OK, or ERR_INVL if a builder gives another value
+ */
+static int bench_lcm(int n_max, int threads)
+{
+	mpz_t  ref, lcm;
+	double t[4];
+	int    n, ret = ERR_OK;
+
+	mpz_init(ref);
+	mpz_init(lcm);
+	printf("%9s %9s %12s %12s %12s %12s\n", "n", "bits", "make_lcm", "mul_ui", "tree(1)", "tree(j)");
+	for (n = 1000; n <= n_max && ret == ERR_OK; n *= 10) {
+		t[3] = bench_one(ref, n, 2, threads);
+		t[2] = bench_one(lcm, n, 2, 1);
+		ret |= mpz_cmp(lcm, ref);
+		t[1] = bench_one(lcm, n, 1, 1);
+		ret |= mpz_cmp(lcm, ref);
+		t[0] = -1.0;
+		if (n <= BENCH_LCM_MAX) {
+			t[0] = bench_one(lcm, n, 0, 1);
+			ret |= mpz_cmp(lcm, ref);
+		}
+		printf("%9d %9lu ", n, (unsigned long)mpz_sizeinbase(ref, 2));
+		if (t[0] < 0) printf("%12s ", "-");
+		else          printf("%10.3fms ", t[0] * 1e3);
+		printf("%10.3fms %10.3fms %10.3fms\n", t[1] * 1e3, t[2] * 1e3, t[3] * 1e3);
+	}
+	if (ret != ERR_OK) {
+		printf("ERR: LCM(1,2,3,...,%d) differs\n", n / 10);
+		ret = ERR_INVL;
+	}
+	mpz_clear(ref);
+	mpz_clear(lcm);
+
+	return ret;
+}
+
+/**
+ * @brief Display usage information for the oasis_lcm_gen command
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_lcm_gen [-n <n_max>] <file>\n");
+	printf("       oasis_lcm_gen --bench [-j <threads>] [<n>]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <file>      LCM table to make\n");
+	printf("---< OPTIONS:\n");
+	printf("       -n <n_max>  Largest n of LCM(1,2,3,...,n) (2..%d, defaults to %d)\n",
+	       LCM_GEN_N_LIMIT, OASIS_LCM_N_MAX);
+	printf("       --bench     Time the builders of LCM(1,2,3,...,n) for n = 10^3..<n> (defaults to %d)\n",
+	       BENCH_N_MAX);
+	printf("       -j <threads>  Threads of the product tree of --bench (defaults to the number of CPUs)\n");
+	printf("---< CAUTION:\n");
+	printf("       1) The commands map $%s, or %s without it.\n", OASIS_LCM_ENV, OASIS_LCM_FILE);
+	printf("          d<n> beyond <n_max> is computed.\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char *argv[])
+{
+	OASIS_LCM   tab[1];
+	const char *path  = NULL;
+	int         n_max = OASIS_LCM_N_MAX;
+	int         bench = 0;
+	int         threads = 0;
+	int         ret   = ERR_OK;
+	int         i;
+
+	XPT_INIT();
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			n_max = atoi(argv[++i]);
+			if (n_max < 2 || n_max > LCM_GEN_N_LIMIT || !isdigit((unsigned char)argv[i][0])) {
+				printf("ERR: <n_max> must be 2..%d\n", LCM_GEN_N_LIMIT);
+				ret = ERR_INVL;
+			}
+		}
+		else if (strcmp(argv[i], "--bench") == 0) {
+			bench = 1;
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+			if (threads < 1 || threads > OASIS_LCM_THREADS_MAX) {
+				printf("ERR: -j <threads> must be 1..%d\n", OASIS_LCM_THREADS_MAX);
+				ret = ERR_INVL;
+			}
+		}
+		else if (argv[i][0] != '-' && path == NULL) {
+			path = argv[i];
+		}
+		else {
+			ret = ERR_PNUM;
+		}
+	}
+	if (ret == ERR_OK && bench) {
+		n_max = (path)? atoi(path): BENCH_N_MAX;
+		if (n_max < 1000) {
+			printf("ERR: <n> of --bench must be >= 1000\n");
+			ret = ERR_INVL;
+		}
+		else {
+			ret = bench_lcm(n_max, threads);
+		}
+	}
+	else if (ret == ERR_OK && path == NULL) {
+		ret = ERR_PNUM;
+	}
+	else if (ret == ERR_OK) {
+		if ((oasis_lcm_write(path, n_max) != 0) || (oasis_lcm_open(tab, path) != 0)) {
+			printf("ERR: Cannot write '%s'\n", path);
+			ret = ERR_FILE;
+		}
+		else {
+			printf("%s: LCM(1,2,3,...,n) for n <= %u, %u entries, %u primes, %lu bytes\n",
+			       path, tab->hdr->n_max, tab->hdr->nent, tab->hdr->nprm, tab->hdr->size);
+			oasis_lcm_close(tab);
+		}
+	}
+	if (ret == ERR_PNUM || ret == ERR_INVL) {
+		disp_usage();
+	}
+
+	return ret;
+}
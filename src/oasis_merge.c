@@ -0,0 +1,529 @@
+/**
+ * @file oasis_merge.c
+ * @brief Merge the outputs of the --shard slices of prime_oases / prime_oasis.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * "prime_oases --shard i/n ..." (and prime_oasis) scans the i-th of n slices
+ * of the deserts, so an array job of a batch cluster needs no coordinator.
+ * oasis_merge k-merges the hits of the slices in the order of the whole
+ * scan and sums their statistics lines:
+ *
+ *   text    hit lines "d<n>*<k>+-1 = ..." / "oasis prime = ...", ordered by
+ *           k and m1 before p1 (by the prime for prime_oasis); the other
+ *           lines (banner, statistics) are not copied
+ *   binary  records of "--format=bin -o <file>" (see oasis_rec.h), ordered
+ *           by k; the header covers the deserts of all the slices
+ *
+ * The statistics lines "{ prime_oases d<n> x<no> <num>: try=..., hit=... }"
+ * and "(try=..., hit=..., twin=...)" in the inputs are summed and printed
+ * at the end, as the single scan prints them; the x<no> <num> of the
+ * slices must be contiguous.
+ *
+ * @note v1.27.0 (2026-10-16): Add oasis_merge command
+ *
+ * @note Around 1024-bit version for educational purposes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <gmp.h>
+
+#include "oasis_rec.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_FILE	(-2)	// File cannot be read
+#define ERR_FMT		(-3)	// Inputs that do not make one scan
+#define ERR_OUT		(-4)	// Output file cannot be written
+#define ERR_MEM		(-5)	// Out of memory
+
+/* Kind of the text lines (OM.kind) */
+#define OM_NONE		(0)
+#define OM_OASES	(1)		// prime_oases
+#define OM_OASIS	(2)		// prime_oasis
+
+/* An input file */
+typedef struct {
+	const char	*path;
+	FILE		*fp;
+	int		 bin;		// binary result stream
+	OASIS_REC_HDR	 hdr[1];	// header (bin)
+	OASIS_REC	 rec[1];	// current record (bin)
+	char		*line;		// current hit line (text)
+	size_t		 size;		// size of line
+	const char	*key;		// digits of k (prime_oases) or of the prime (prime_oasis)
+	int		 key_len;
+	int		 ord;		// 0: m1, 1: p1
+} OM_IN;
+
+/* A statistics line of prime_oases (one per slice) */
+typedef struct {
+	mpz_t		 no;		// x<no>
+	uint64_t	 num;		// <num>
+} OM_PART;
+
+typedef struct {
+	int		 kind;		// OM_* of the text lines
+	int		 desert;	// n of d<n> (prime_oases)
+	int		 lines;		// statistics lines
+	int		 proven;	// ", proven=" was printed
+	int		 cut;		// an interrupted slice
+	uint64_t	 try_cnt;
+	uint64_t	 hit_cnt;
+	uint64_t	 twin_cnt;
+	uint64_t	 prv_cnt;
+	OM_PART		*part;		// x<no> <num> of the statistics lines
+	int		 npart;
+	int		 apart;		// allocated part
+} OM;
+
+static OM om[1];
+
+/**
+ * @brief Display usage information for the oasis_merge command
+ */
+static void disp_usage()
+{
+	printf("---< USAGE:\n");
+	printf("       oasis_merge [-o <file>] <file> [<file> ...]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <file>    Output of a slice: 'prime_oases --shard <i>/<n> ...' (screen or -o <file>,\n");
+	printf("                 text or --format=bin) or 'prime_oasis --shard <i>/<n> ...' (screen)\n");
+	printf("                 The files may be given in any order.\n");
+	printf("---< OPTIONS:\n");
+	printf("       -o <file> Write the merged hits to <file> instead of the screen (needed for binary)\n");
+	printf("---< CAUTION:\n");
+	printf("       1) The hits are the output of the whole scan, the statistics lines of the slices\n");
+	printf("          are summed into the statistics line of the whole scan.\n");
+	printf("       2) The statistics lines of prime_oases must cover contiguous deserts.\n");
+	printf("---< EXAMPLES:\n");
+	printf("       prime_oases --shard 0/2 -o s0.txt d691 2000 > s0.log\n");
+	printf("       prime_oases --shard 1/2 -o s1.txt d691 2000 > s1.log\n");
+	printf("       oasis_merge -o all.txt s0.txt s1.txt s0.log s1.log  # Same as 'prime_oases -o all.txt d691 2000'\n");
+	printf("---\n");
+}
+
+/**
+ * @brief Take the kind of the text lines (all the inputs are of one kind)
+ *
+ * @return 0, or -1 if the kind differs from the lines before
+ */
+static int om_kind(const OM_IN *in, int kind)
+{
+	if (om->kind == OM_NONE) om->kind = kind;
+	if (om->kind == kind) return 0;
+
+	printf("ERR: '%s' mixes prime_oases and prime_oasis\n", in->path);
+	return -1;
+}
+
+/**
+ * @brief Add a statistics line of a slice
+ *
+ * @return 1 if the line is a statistics line, 0 if not, -1 on error
+ */
+static int om_stat(const OM_IN *in, const char *line)
+{
+	char         x[256];
+	int          desert;
+	unsigned long num, t, h, w = 0, p;
+	const char  *pp;
+	OM_PART     *part;
+
+	if (sscanf(line, "{ prime_oases d%d x%255[0-9] %lu: try=%lu, hit=%lu(", &desert, x, &num, &t, &h) == 5) {
+		if (om_kind(in, OM_OASES) != 0) return -1;
+		if (om->lines > 0 && desert != om->desert) {
+			printf("ERR: '%s' is a scan of d%d, not d%d\n", in->path, desert, om->desert);
+			return -1;
+		}
+		if (om->npart == om->apart) {
+			om->apart = (om->apart)? om->apart * 2: 16;
+			part = realloc(om->part, om->apart * sizeof(OM_PART));
+			if (part == NULL) return -1;
+			om->part = part;
+		}
+		mpz_init_set_str(om->part[om->npart].no, x, 10);
+		om->part[om->npart++].num = num;
+		om->desert = desert;
+	}
+	else if (sscanf(line, "(try=%lu, hit=%lu, twin=%lu", &t, &h, &w) == 3) {
+		if (om_kind(in, OM_OASIS) != 0) return -1;
+	}
+	else {
+		return 0;
+	}
+	if ((pp = strstr(line, "proven=")) != NULL && sscanf(pp, "proven=%lu", &p) == 1) {
+		om->prv_cnt += p;
+		om->proven   = 1;
+	}
+	om->try_cnt  += t;
+	om->hit_cnt  += h;
+	om->twin_cnt += w;
+	om->lines++;
+
+	return 1;
+}
+
+/**
+ * @brief Take the key of a hit line
+ *
+ * @return 1 for a hit line (key set), 0 for another line, -1 on error
+ */
+static int om_key(OM_IN *in)
+{
+	const char *p = in->line;
+	int         kind;
+
+	if (p[0] == 'd' && (p = strchr(p, '*')) != NULL) {	// d<n>*<k>+-1 = ...
+		kind = OM_OASES;
+		p++;
+	}
+	else if (strncmp(p, "oasis prime", 11) == 0 && (p = strstr(p, " = ")) != NULL) {	// oasis prime = <x>
+		kind = OM_OASIS;
+		p += 3;
+	}
+	else {
+		return 0;
+	}
+	in->key     = p;
+	in->key_len = (int)strspn(p, "0123456789");
+	in->ord     = (kind == OM_OASES && p[in->key_len] == '+');
+	if (in->key_len == 0) return 0;
+
+	return (om_kind(in, kind) == 0)? 1: -1;
+}
+
+/**
+ * @brief Read the next hit of an input
+ *
+ * @return 1 if a hit was read, 0 at the end of the input, -1 on error
+ */
+static int om_next(OM_IN *in)
+{
+	int ret;
+
+	if (in->bin) {
+		return (fread(in->rec, sizeof(in->rec), 1, in->fp) == 1);	// a cut record is the end
+	}
+	while (getline(&in->line, &in->size, in->fp) >= 0) {
+		if ((ret = om_key(in)) != 0) return ret;
+		if ((ret = om_stat(in, in->line)) != 0) {
+			if (ret < 0) return -1;
+			continue;
+		}
+		if (strstr(in->line, "*** Interrupted by user ***")) {
+			om->cut = 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Order of the current hits of two inputs
+ *
+ * @return < 0 if a comes first, > 0 if b comes first
+ */
+static int om_cmp(const OM_IN *a, const OM_IN *b)
+{
+	int c;
+
+	if (a->bin) {
+		if (a->rec->k_hi != b->rec->k_hi) return (a->rec->k_hi < b->rec->k_hi)? -1: 1;
+		if (a->rec->k    != b->rec->k)    return (a->rec->k    < b->rec->k)?    -1: 1;
+		return (b->rec->sign == '-') - (a->rec->sign == '-');	// m1 first
+	}
+	if (a->key_len != b->key_len) return a->key_len - b->key_len;
+	if ((c = memcmp(a->key, b->key, a->key_len)) != 0) return c;
+
+	return a->ord - b->ord;
+}
+
+/**
+ * @brief Restore the order of the heap from position i down
+ */
+static void om_down(OM_IN **hp, int n, int i)
+{
+	OM_IN *t;
+	int    c;
+
+	while ((c = 2 * i + 1) < n) {
+		if (c + 1 < n && om_cmp(hp[c + 1], hp[c]) < 0) c++;
+		if (om_cmp(hp[i], hp[c]) <= 0) break;
+		t = hp[i]; hp[i] = hp[c]; hp[c] = t;
+		i = c;
+	}
+}
+
+/**
+ * @brief Order of the slices by x<no>
+ */
+static int om_part_cmp(const void *a, const void *b)
+{
+	return mpz_cmp(((const OM_PART *)a)->no, ((const OM_PART *)b)->no);
+}
+
+static int om_hdr_cmp(const void *a, const void *b)
+{
+	const OM_IN *x = *(OM_IN * const *)a;
+	const OM_IN *y = *(OM_IN * const *)b;
+
+	return (x->hdr->no > y->hdr->no) - (x->hdr->no < y->hdr->no);
+}
+
+/**
+ * @brief Check that the slices are contiguous, take the header of the whole scan
+ *
+ * @param[in]  in   Binary inputs
+ * @param[in]  n    Number of binary inputs
+ * @param[out] hdr  Header of the merged stream
+ *
+ * @return ERR_OK, or ERR_FMT if the slices are not of one scan
+ */
+static int om_bin_hdr(OM_IN **in, int n, OASIS_REC_HDR *hdr)
+{
+	uint64_t num = 0;
+	int      i;
+
+	qsort(in, n, sizeof(in[0]), om_hdr_cmp);
+	for (i = 0; i < n; i++) {
+		if (in[i]->hdr->desert != in[0]->hdr->desert || in[i]->hdr->flags != in[0]->hdr->flags) {
+			printf("ERR: '%s' is not a slice of the scan of '%s'\n", in[i]->path, in[0]->path);
+			return ERR_FMT;
+		}
+		if (in[i]->hdr->no < in[0]->hdr->no + num) {
+			printf("ERR: x%lu of '%s' is in another file\n", in[i]->hdr->no, in[i]->path);
+			return ERR_FMT;
+		}
+		if (in[i]->hdr->no > in[0]->hdr->no + num) {
+			printf("ERR: x%lu..x%lu are missing before '%s'\n",
+			       in[0]->hdr->no + num, in[i]->hdr->no - 1, in[i]->path);
+			return ERR_FMT;
+		}
+		num += in[i]->hdr->num;
+	}
+	oasis_rec_hdr_init(hdr, (int)in[0]->hdr->desert, in[0]->hdr->no, num, in[0]->hdr->flags);
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Print the statistics line of the whole scan
+ *
+ * @return ERR_OK, or ERR_FMT if the slices are not contiguous
+ */
+static int om_print_stat(void)
+{
+	uint64_t num;
+	int      i;
+	mpz_t    x;
+
+	if (om->lines == 0) return ERR_OK;
+
+	if (om->kind == OM_OASIS) {
+		printf("(try=%lu, hit=%lu, twin=%lu", om->try_cnt, om->hit_cnt, om->twin_cnt);
+		if (om->proven) {
+			printf(", proven=%lu", om->prv_cnt);
+		}
+		printf(")\n");
+		return ERR_OK;
+	}
+
+	mpz_init(x);
+	qsort(om->part, om->npart, sizeof(OM_PART), om_part_cmp);
+	for (i = 0, num = 0; i < om->npart; i++) {
+		mpz_add_ui(x, om->part[0].no, num);
+		if (mpz_cmp(om->part[i].no, x) < 0) {
+			gmp_printf("ERR: x%Zd is in two statistics lines\n", om->part[i].no);
+			mpz_clear(x);
+			return ERR_FMT;
+		}
+		if (mpz_cmp(om->part[i].no, x) > 0) {
+			mpz_sub_ui(om->part[i].no, om->part[i].no, 1);
+			gmp_printf("ERR: x%Zd..x%Zd are not in the statistics lines\n", x, om->part[i].no);
+			mpz_clear(x);
+			return ERR_FMT;
+		}
+		num += om->part[i].num;
+	}
+	gmp_printf("{ prime_oases d%d x%Zd %lu: try=%lu, hit=%lu(%2.1f%%)",
+		om->desert, om->part[0].no, num, om->try_cnt, om->hit_cnt,
+		(double)om->hit_cnt / (double)om->try_cnt * 100.0);
+	if (om->proven) {
+		printf(", proven=%lu", om->prv_cnt);
+	}
+	printf(" }\n");
+	mpz_clear(x);
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Merge the inputs
+ *
+ * @param[in] path  Input files
+ * @param[in] n     Number of input files
+ * @param[in] out   Output file (NULL: stdout)
+ *
+ * @return ERR_OK on success, ERR_* on failure
+ */
+static int om_merge(char *path[], int n, const char *out)
+{
+	OM_IN         *in;
+	OM_IN        **hp;
+	OASIS_REC_HDR  hdr[1];
+	FILE          *fp = stdout;
+	int            nbin = 0, nhit = 0;
+	int            i, r;
+	int            ret = ERR_OK;
+
+	in = calloc(n, sizeof(OM_IN));
+	hp = calloc(n, sizeof(OM_IN *));
+	if (in == NULL || hp == NULL) {
+		free(in);
+		free(hp);
+		printf("ERR: Out of memory\n");
+		return ERR_MEM;
+	}
+
+	/*--- open the inputs, read their first hits ---*/
+	for (i = 0; i < n && ret == ERR_OK; i++) {
+		in[i].path = path[i];
+		in[i].fp   = fopen(path[i], "rb");
+		if (in[i].fp == NULL) {
+			printf("ERR: Cannot open '%s'\n", path[i]);
+			ret = ERR_FILE;
+			break;
+		}
+		if (fread(in[i].hdr, sizeof(in[i].hdr), 1, in[i].fp) == 1 && oasis_rec_hdr_check(in[i].hdr) == 0) {
+			in[i].bin = 1;
+			hp[nbin++] = &in[i];
+		}
+		else {
+			rewind(in[i].fp);
+		}
+	}
+	if (ret == ERR_OK && nbin > 0) {
+		if (out == NULL) {
+			printf("ERR: Binary inputs need -o <file>\n");
+			ret = ERR_PNUM;
+		}
+		else {
+			ret = om_bin_hdr(hp, nbin, hdr);
+		}
+	}
+	for (i = 0; i < n && ret == ERR_OK; i++) {
+		if ((r = om_next(&in[i])) < 0) {
+			ret = ERR_FMT;
+		}
+		else if (r > 0) {
+			if (in[i].bin != (nbin > 0)) {
+				printf("ERR: '%s' mixes text and binary hits\n", in[i].path);
+				ret = ERR_FMT;
+			}
+			hp[nhit++] = &in[i];
+		}
+	}
+
+	/*--- k-merge ---*/
+	if (ret == ERR_OK && out) {
+		fp = fopen(out, (nbin > 0)? "wb": "w");
+		if (fp == NULL) {
+			printf("ERR: Cannot open '%s'\n", out);
+			ret = ERR_OUT;
+		}
+		else if (nbin > 0) {
+			fwrite(hdr, sizeof(hdr), 1, fp);
+		}
+	}
+	for (i = nhit / 2 - 1; i >= 0 && ret == ERR_OK; i--) {
+		om_down(hp, nhit, i);
+	}
+	while (nhit > 0 && ret == ERR_OK) {
+		if (hp[0]->bin) {
+			fwrite(hp[0]->rec, sizeof(hp[0]->rec), 1, fp);
+		}
+		else {
+			fputs(hp[0]->line, fp);
+		}
+		if ((r = om_next(hp[0])) < 0) {
+			ret = ERR_FMT;
+		}
+		else if (r == 0) {
+			hp[0] = hp[--nhit];
+		}
+		om_down(hp, nhit, 0);
+	}
+	if (fp != stdout && fclose(fp) != 0) {
+		printf("ERR: Cannot write '%s'\n", out);
+		ret = ERR_OUT;
+	}
+
+	/*--- statistics ---*/
+	if (ret == ERR_OK) {
+		fflush(stdout);
+		if (om->cut) {
+			printf("WRN: a slice was interrupted, the merge does not cover it\n");
+		}
+		ret = om_print_stat();
+	}
+
+	for (i = 0; i < n; i++) {
+		if (in[i].fp) fclose(in[i].fp);
+		free(in[i].line);
+	}
+	for (i = 0; i < om->npart; i++) {
+		mpz_clear(om->part[i].no);
+	}
+	free(om->part);
+	free(in);
+	free(hp);
+
+	return ret;
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char *argv[])
+{
+	const char *out = NULL;
+	int         ret = ERR_OK;
+	int         i, n = 0;
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if (strcmp(argv[i], "-o") == 0) {		// -o <file>
+			if (i + 1 >= argc) {
+				printf("ERR: -o needs <file>\n");
+				ret = ERR_PNUM;
+			}
+			else {
+				out = argv[++i];
+			}
+		}
+		else if (argv[i][0] == '-') {
+			printf("ERR: Unknown option '%s'\n", argv[i]);
+			ret = ERR_PNUM;
+		}
+		else {
+			argv[1 + n++] = argv[i];
+		}
+	}
+	if (ret == ERR_OK && n == 0) {
+		ret = ERR_PNUM;
+	}
+
+	if (ret == ERR_OK) {
+		ret = om_merge(&argv[1], n, out);
+	}
+
+	if (ret == ERR_PNUM) {
+		disp_usage();
+	}
+
+	return ret;
+}
@@ -0,0 +1,540 @@
+/**
+ * @file oasis_microbench.c
+ * @brief Microbenchmarks of the arithmetic primitives of the scan.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Times the primitives the engine is built on, one at a time:
+ *
+ *   lcm     make_lcm (mpz_lcm_ui loop) and the product tree, n = 100..1429
+ *   prp     mpz_probab_prime_p() with reps 1/2/25 and one Fermat test
+ *           (oasis_fermat()) of a prime of 512..4096 bits
+ *   add     mpz_add() of pit and desert (pit += d<n>)
+ *   dec     decimal conversion of a hit (mpz_get_str())
+ *   sieve   one segment of the sieve (oasis_sieve_next())
+ *   inv     setup of the sieve primes (prime table and inverses, oasis_sieve_init())
+ *
+ * A sample times as many operations as fit in -t <ms>; after -w <n>
+ * warmup samples, -r <n> samples are kept and the median and the median
+ * absolute deviation (MAD) of ns per operation are reported.  The inputs
+ * are fixed (seeded), so two runs time the same work.
+ *
+ * @note v1.32.1 (2026-10-16): A <case> that selects no case is an error, the
+ *       usage lists each case name once
+ * @note v1.23.0 (2026-10-16): Add oasis_microbench command
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#define XPT_ON
+#include "xpt.h"
+int xpt_flg = 0;
+
+#include "oasis_lcm.h"
+#include "oasis_sieve.h"
+#include "oasis_fermat.h"
+
+#define ERR_OK		(0)
+#define ERR_PNUM	(-1)	// Invalid number of arguments
+#define ERR_FILE	(-2)	// File cannot be written
+#define ERR_INVL	(-5)	// Invalid value
+#define ERR_MEM		(-7)	// Out of memory
+
+#define MB_WARMUP	(3)		// default warmup samples
+#define MB_REPS		(15)		// default samples kept
+#define MB_REPS_MAX	(1000)
+#define MB_TIME_MS	(10)		// default time of a sample [ms]
+#define MB_SEED		(20261016)	// seed of the inputs
+#define MB_DEC_MAX	(1300)		// digits of a 4096-bit number + 1
+
+/* Inputs of a case */
+typedef struct {
+	int		arg;		// n, bits, reps or sieve limit
+	int		reps;		// reps of mpz_probab_prime_p() (0: Fermat)
+	mpz_t		a, b;
+	OASIS_FERMAT	fm[1];
+	OASIS_SIEVE	sv[1];
+	char		buf[MB_DEC_MAX];
+	uint64_t	sink;		// keeps the results alive
+} MB_CTX;
+
+/* A case: group, parameter, operation */
+typedef struct {
+	const char *group;
+	const char *param;	// printf format of arg
+	int         arg;
+	int         reps;
+	uint64_t    items;	// items per operation (k per segment, 1 otherwise)
+	int       (*setup)(MB_CTX *cx);
+	void      (*run)(MB_CTX *cx, uint64_t ops);
+	void      (*clear)(MB_CTX *cx);
+} MB_CASE;
+
+/* Result of a case, one line of the JSON file */
+typedef struct {
+	char     name[48];
+	uint64_t ops;		// operations per sample
+	double   median;	// ns per operation
+	double   mad;
+	double   min;
+	double   items_per_s;
+} MB_RES;
+
+static volatile uint64_t mb_sink;	// results of all cases
+
+/**
+ * @brief Elapsed time in ns
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*--- lcm ---------------------------------------------------------------*/
+
+static int lcm_setup(MB_CTX *cx)
+{
+	(void)cx;
+	return 0;
+}
+
+static void lcm_loop(MB_CTX *cx, uint64_t ops)	// make_lcm
+{
+	uint64_t o;
+	int      i;
+
+	for (o = 0; o < ops; o++) {
+		mpz_set_ui(cx->a, 1);
+		for (i = 2; i <= cx->arg; i++) {
+			mpz_lcm_ui(cx->a, cx->a, i);
+		}
+		cx->sink += mpz_getlimbn(cx->a, 0);
+	}
+}
+
+static void lcm_tree(MB_CTX *cx, uint64_t ops)	// oasis_lcm_build()
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		oasis_lcm_build(cx->a, (uint32_t)cx->arg, 1, NULL);
+		cx->sink += mpz_getlimbn(cx->a, 0);
+	}
+}
+
+/*--- prp ---------------------------------------------------------------*/
+
+/**
+ * @brief A fixed prime of arg bits (the worst case of a test: all rounds)
+ */
+static int prp_setup(MB_CTX *cx)
+{
+	gmp_randstate_t rs;
+
+	gmp_randinit_default(rs);
+	gmp_randseed_ui(rs, MB_SEED + cx->arg);
+	mpz_urandomb(cx->a, rs, cx->arg);
+	mpz_setbit(cx->a, cx->arg - 1);
+	mpz_nextprime(cx->a, cx->a);
+	gmp_randclear(rs);
+	oasis_fermat_init(cx->fm);
+
+	return 0;
+}
+
+static void prp_gmp(MB_CTX *cx, uint64_t ops)	// mpz_probab_prime_p()
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		cx->sink += mpz_probab_prime_p(cx->a, cx->reps);
+	}
+}
+
+static void prp_fermat(MB_CTX *cx, uint64_t ops)	// oasis_fermat()
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		cx->sink += oasis_fermat(cx->fm, cx->a);
+	}
+}
+
+/*--- add, dec ----------------------------------------------------------*/
+
+/**
+ * @brief pit = d<n> * no of arg bits, desert = d<n> a bit smaller than pit
+ */
+static int num_setup(MB_CTX *cx)
+{
+	gmp_randstate_t rs;
+
+	gmp_randinit_default(rs);
+	gmp_randseed_ui(rs, MB_SEED + cx->arg);
+	mpz_urandomb(cx->a, rs, cx->arg);
+	mpz_setbit(cx->a, cx->arg - 1);
+	mpz_urandomb(cx->b, rs, cx->arg - 20);
+	mpz_setbit(cx->b, cx->arg - 21);
+	gmp_randclear(rs);
+
+	return 0;
+}
+
+static void num_add(MB_CTX *cx, uint64_t ops)	// pit += desert
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		mpz_add(cx->a, cx->a, cx->b);
+	}
+	cx->sink += mpz_getlimbn(cx->a, 0);
+}
+
+static void num_dec(MB_CTX *cx, uint64_t ops)	// decimal digits of a hit
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		mpz_get_str(cx->buf, 10, cx->a);
+		cx->sink += (unsigned char)cx->buf[o % 16];
+	}
+}
+
+/*--- sieve, inv --------------------------------------------------------*/
+
+/**
+ * @brief Sieve of prime_oases d683 x484391 with primes up to arg
+ */
+static void sieve_pit(MB_CTX *cx)
+{
+	oasis_lcm_get(cx->b, 683);			// step = d683
+	mpz_mul_ui(cx->a, cx->b, 484391);		// pit0 = d683 * 484391
+}
+
+static int sieve_setup(MB_CTX *cx)
+{
+	sieve_pit(cx);
+	return oasis_sieve_init(cx->sv, cx->a, cx->b, (uint32_t)cx->arg);
+}
+
+static void sieve_seg(MB_CTX *cx, uint64_t ops)	// oasis_sieve_next()
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		oasis_sieve_next(cx->sv);
+		cx->sink += cx->sv->bits[OASIS_SIEVE_M1][0];
+	}
+}
+
+static void sieve_clear(MB_CTX *cx)
+{
+	oasis_sieve_clear(cx->sv);
+}
+
+static int inv_setup(MB_CTX *cx)
+{
+	sieve_pit(cx);
+	return 0;
+}
+
+static void inv_init(MB_CTX *cx, uint64_t ops)	// oasis_sieve_init()
+{
+	uint64_t o;
+
+	for (o = 0; o < ops; o++) {
+		if (oasis_sieve_init(cx->sv, cx->a, cx->b, (uint32_t)cx->arg) == 0) {
+			cx->sink += cx->sv->nprm;
+			oasis_sieve_clear(cx->sv);
+		}
+	}
+}
+
+static const MB_CASE cases[] = {
+	{"lcm_loop",   "n=%d",        100,  0, 1, lcm_setup,   lcm_loop,    NULL},
+	{"lcm_loop",   "n=%d",        400,  0, 1, lcm_setup,   lcm_loop,    NULL},
+	{"lcm_loop",   "n=%d",        691,  0, 1, lcm_setup,   lcm_loop,    NULL},
+	{"lcm_loop",   "n=%d",       1429,  0, 1, lcm_setup,   lcm_loop,    NULL},
+	{"lcm_tree",   "n=%d",        100,  0, 1, lcm_setup,   lcm_tree,    NULL},
+	{"lcm_tree",   "n=%d",        400,  0, 1, lcm_setup,   lcm_tree,    NULL},
+	{"lcm_tree",   "n=%d",        691,  0, 1, lcm_setup,   lcm_tree,    NULL},
+	{"lcm_tree",   "n=%d",       1429,  0, 1, lcm_setup,   lcm_tree,    NULL},
+	{"prp_fermat", "bits=%d",     512,  0, 1, prp_setup,   prp_fermat,  NULL},
+	{"prp_reps1",  "bits=%d",     512,  1, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps2",  "bits=%d",     512,  2, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps25", "bits=%d",     512, 25, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_fermat", "bits=%d",    1024,  0, 1, prp_setup,   prp_fermat,  NULL},
+	{"prp_reps1",  "bits=%d",    1024,  1, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps2",  "bits=%d",    1024,  2, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps25", "bits=%d",    1024, 25, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_fermat", "bits=%d",    2048,  0, 1, prp_setup,   prp_fermat,  NULL},
+	{"prp_reps1",  "bits=%d",    2048,  1, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps2",  "bits=%d",    2048,  2, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps25", "bits=%d",    2048, 25, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_fermat", "bits=%d",    4096,  0, 1, prp_setup,   prp_fermat,  NULL},
+	{"prp_reps1",  "bits=%d",    4096,  1, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps2",  "bits=%d",    4096,  2, 1, prp_setup,   prp_gmp,     NULL},
+	{"prp_reps25", "bits=%d",    4096, 25, 1, prp_setup,   prp_gmp,     NULL},
+	{"add",        "bits=%d",     512,  0, 1, num_setup,   num_add,     NULL},
+	{"add",        "bits=%d",    1024,  0, 1, num_setup,   num_add,     NULL},
+	{"add",        "bits=%d",    2048,  0, 1, num_setup,   num_add,     NULL},
+	{"add",        "bits=%d",    4096,  0, 1, num_setup,   num_add,     NULL},
+	{"dec",        "bits=%d",     512,  0, 1, num_setup,   num_dec,     NULL},
+	{"dec",        "bits=%d",    1024,  0, 1, num_setup,   num_dec,     NULL},
+	{"dec",        "bits=%d",    2048,  0, 1, num_setup,   num_dec,     NULL},
+	{"dec",        "bits=%d",    4096,  0, 1, num_setup,   num_dec,     NULL},
+	{"sieve_seg",  "limit=%d",  1 << 16, 0, OASIS_SIEVE_SEG_BITS, sieve_setup, sieve_seg, sieve_clear},
+	{"sieve_seg",  "limit=%d",  1 << 20, 0, OASIS_SIEVE_SEG_BITS, sieve_setup, sieve_seg, sieve_clear},
+	{"sieve_seg",  "limit=%d",  1 << 24, 0, OASIS_SIEVE_SEG_BITS, sieve_setup, sieve_seg, sieve_clear},
+	{"sieve_inv",  "limit=%d",  1 << 16, 0, 1, inv_setup,   inv_init,    NULL},
+	{"sieve_inv",  "limit=%d",  1 << 20, 0, 1, inv_setup,   inv_init,    NULL},
+	{"sieve_inv",  "limit=%d",  1 << 24, 0, 1, inv_setup,   inv_init,    NULL},
+	{NULL,         NULL,            0,  0, 0, NULL,        NULL,        NULL}
+};
+
+/**
+ * @brief Compare two doubles (qsort)
+ */
+static int cmp_dbl(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Median of v[0..n-1] (v is sorted)
+ */
+static double median(double *v, int n)
+{
+	qsort(v, n, sizeof(double), cmp_dbl);
+	return (n % 2)? v[n / 2]: (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+/**
+ * @brief Time one case
+ *
+ * @param[out] res    Result
+ * @param[in]  mc     Case
+ * @param[in]  warmup Warmup samples
+ * @param[in]  reps   Samples kept
+ * @param[in]  ms     Time of a sample [ms]
+ *
+ * @return ERR_OK, or ERR_MEM
+ *
+ * @details The operations per sample are doubled until a sample takes
+ *          ms (one operation if it takes longer), then fixed for all
+ *          the samples of the case.
+ */
+static int mb_run(MB_RES *res, const MB_CASE *mc, int warmup, int reps, int ms)
+{
+	MB_CTX   cx[1];
+	double   ns[MB_REPS_MAX], dev[MB_REPS_MAX];
+	uint64_t ops = 1, t0, t;
+	int      i;
+
+	memset(cx, 0, sizeof(cx));
+	cx->arg  = mc->arg;
+	cx->reps = mc->reps;
+	mpz_init(cx->a);
+	mpz_init(cx->b);
+	snprintf(res->name, sizeof(res->name), "%s ", mc->group);
+	snprintf(res->name + strlen(res->name), sizeof(res->name) - strlen(res->name), mc->param, mc->arg);
+	if (mc->setup(cx) != 0) {
+		mpz_clear(cx->a);
+		mpz_clear(cx->b);
+		return ERR_MEM;
+	}
+
+	for (;;) {					// operations per sample
+		t0 = now_ns();
+		mc->run(cx, ops);
+		t = now_ns() - t0;
+		if (t >= (uint64_t)ms * 1000000 || ops >= ((uint64_t)1 << 40)) break;
+		ops = (t > 0 && t < (uint64_t)ms * 1000000 / 4)? ops * 4: ops * 2;
+	}
+	for (i = 0; i < warmup; i++) {
+		mc->run(cx, ops);
+	}
+	for (i = 0; i < reps; i++) {
+		t0 = now_ns();
+		mc->run(cx, ops);
+		ns[i] = (double)(now_ns() - t0) / ops;
+	}
+	res->ops    = ops;
+	res->median = median(ns, reps);
+	res->min    = ns[0];
+	for (i = 0; i < reps; i++) {
+		dev[i] = (ns[i] > res->median)? ns[i] - res->median: res->median - ns[i];
+	}
+	res->mad         = median(dev, reps);
+	res->items_per_s = (res->median > 0)? mc->items * 1e9 / res->median: 0.0;
+
+	mb_sink += cx->sink;
+	if (mc->clear) mc->clear(cx);
+	mpz_clear(cx->a);
+	mpz_clear(cx->b);
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Write the results as JSON, one result per line
+ *
+ * @return ERR_OK, or ERR_FILE
+ */
+static int mb_write(const char *path, const MB_RES *res, int nres, int warmup, int reps, int ms)
+{
+	FILE *fp;
+	int   i;
+
+	fp = fopen(path, "w");
+	if (fp == NULL) return ERR_FILE;
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"bench\": \"oasis_microbench\",\n");
+	fprintf(fp, "  \"gmp\": \"%s\",\n", gmp_version);
+	fprintf(fp, "  \"warmup\": %d,\n", warmup);
+	fprintf(fp, "  \"reps\": %d,\n", reps);
+	fprintf(fp, "  \"sample_ms\": %d,\n", ms);
+	fprintf(fp, "  \"results\": [\n");
+	for (i = 0; i < nres; i++) {
+		fprintf(fp, "    {\"case\": \"%s\", \"ops\": %lu, \"median_ns\": %.1f, \"mad_ns\": %.1f, "
+			"\"min_ns\": %.1f, \"items_per_s\": %.1f}%s\n",
+			res[i].name, res[i].ops, res[i].median, res[i].mad,
+			res[i].min, res[i].items_per_s, (i + 1 < nres)? ",": "");
+	}
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+
+	return (fclose(fp) == 0)? ERR_OK: ERR_FILE;
+}
+
+/**
+ * @brief Display usage information for the oasis_microbench command
+ *
+ * @note Modified in v1.32.1 (2026-10-16): each case name once (the sizes of
+ *       the prp cases are interleaved)
+ */
+static void disp_usage()
+{
+	int i, j;
+
+	printf("---< USAGE:\n");
+	printf("       oasis_microbench [-w <warmup>] [-r <reps>] [-t <ms>] [-o <file>] [<case>...]\n\n");
+	printf("---< DESCRIPTION:\n");
+	printf("       <case>  Cases to run, by the start of the name (defaults to all of them):\n");
+	for (i = 0; cases[i].group; i++) {
+		for (j = 0; j < i && strcmp(cases[i].group, cases[j].group) != 0; j++);
+		if (j == i) {				// first of the name
+			printf("                 %s\n", cases[i].group);
+		}
+	}
+	printf("---< OPTIONS:\n");
+	printf("       -w <warmup>  Warmup samples, not counted (defaults to %d)\n", MB_WARMUP);
+	printf("       -r <reps>    Samples of a case, 1..%d (defaults to %d)\n", MB_REPS_MAX, MB_REPS);
+	printf("       -t <ms>      Time of a sample (defaults to %d)\n", MB_TIME_MS);
+	printf("       -o <file>    Write the results as JSON\n");
+	printf("---< CAUTION:\n");
+	printf("       1) median and MAD are ns per operation; a MAD above a few %% of the median\n");
+	printf("          means a noisy machine, run again with more -r.\n");
+	printf("       2) prp_* test a prime, so every round of mpz_probab_prime_p() is run.\n");
+	printf("       3) sieve_seg is %d k of d683 x484391, sieve_inv the setup of its sieve primes.\n",
+	       OASIS_SIEVE_SEG_BITS);
+	printf("---\n");
+}
+
+/**
+ * @brief Main entry point
+ *
+ * @note Modified in v1.32.1 (2026-10-16): ERR_INVL for a <case> that
+ *       selects no case
+ */
+int main(int argc, char *argv[])
+{
+	static MB_RES res[sizeof(cases) / sizeof(cases[0])];
+	const char *out_file = NULL;
+	const char *sel[64];
+	int         nsel   = 0;
+	int         warmup = MB_WARMUP;
+	int         reps   = MB_REPS;
+	int         ms     = MB_TIME_MS;
+	int         nres   = 0;
+	int         ret    = ERR_OK;
+	int         i, c, s;
+
+	XPT_INIT();
+
+	for (i = 1; i < argc && ret == ERR_OK; i++) {
+		if ((strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "-t") == 0)
+		&&  i + 1 < argc) {
+			if (!isdigit((unsigned char)argv[i + 1][0])) {
+				printf("ERR: %s needs a number\n", argv[i]);
+				ret = ERR_INVL;
+			}
+			else if (argv[i][1] == 'w') warmup = atoi(argv[++i]);
+			else if (argv[i][1] == 'r') reps   = atoi(argv[++i]);
+			else                        ms     = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			out_file = argv[++i];
+		}
+		else if (argv[i][0] != '-' && nsel < 64) {
+			sel[nsel++] = argv[i];
+		}
+		else {
+			ret = ERR_PNUM;
+		}
+	}
+	if (ret == ERR_OK && (reps < 1 || reps > MB_REPS_MAX || ms < 1)) {
+		printf("ERR: -r <reps> must be 1..%d, -t <ms> >= 1\n", MB_REPS_MAX);
+		ret = ERR_INVL;
+	}
+	for (s = 0; s < nsel && ret == ERR_OK; s++) {
+		for (c = 0; cases[c].group && strncmp(cases[c].group, sel[s], strlen(sel[s])) != 0; c++);
+		if (!cases[c].group) {
+			printf("ERR: No case '%s'\n", sel[s]);
+			ret = ERR_INVL;
+		}
+	}
+	if (ret != ERR_OK) {
+		disp_usage();
+		return ret;
+	}
+
+	printf("%-24s %12s %14s %12s %7s %14s %16s\n", "case", "ops/sample", "median ns", "MAD ns", "MAD%",
+	       "min ns", "items/s");
+	for (c = 0; cases[c].group && ret == ERR_OK; c++) {
+		for (s = 0; s < nsel && strncmp(cases[c].group, sel[s], strlen(sel[s])) != 0; s++);
+		if (nsel && s == nsel) continue;
+
+		ret = mb_run(&res[nres], &cases[c], warmup, reps, ms);
+		if (ret != ERR_OK) {
+			printf("ERR: Out of memory\n");
+			break;
+		}
+		printf("%-24s %12lu %14.1f %12.1f %6.2f%% %14.1f %16.1f\n",
+		       res[nres].name, res[nres].ops, res[nres].median, res[nres].mad,
+		       (res[nres].median > 0)? res[nres].mad / res[nres].median * 100.0: 0.0,
+		       res[nres].min, res[nres].items_per_s);
+		fflush(stdout);
+		nres++;
+	}
+
+	if (ret == ERR_OK && out_file && mb_write(out_file, res, nres, warmup, reps, ms) != ERR_OK) {
+		printf("ERR: Cannot write '%s'\n", out_file);
+		ret = ERR_FILE;
+	}
+
+	return ret;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file oasis_net.c
+ * @brief Stream sockets of the work-unit coordinator (oasis_coord).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_net.h.
+ *
+ * @note v1.26.0 (2026-10-16): Add stream sockets (oasis_net)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "oasis_net.h"
+
+#define NET_BACKLOG	(64)
+
+/**
+ * @brief Open a socket of an address, bound (listen) or connected
+ *
+ * @return File descriptor, -1 on error (errno is set)
+ */
+static int net_open(const char *addr, int listen_fd)
+{
+	struct sockaddr_un su;
+	struct addrinfo    hints, *ai, *p;
+	char               host[256];
+	const char        *port;
+	int                fd = -1;
+	int                one = 1;
+
+	if (strncmp(addr, "unix:", 5) == 0) {		// unix:<path>
+		memset(&su, 0, sizeof(su));
+		su.sun_family = AF_UNIX;
+		if (strlen(addr + 5) >= sizeof(su.sun_path)) {
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		strcpy(su.sun_path, addr + 5);
+		if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) return -1;
+		if (listen_fd) {
+			unlink(su.sun_path);			// left by a coordinator that died
+			if (bind(fd, (struct sockaddr *)&su, sizeof(su)) == 0
+			&&  listen(fd, NET_BACKLOG) == 0) return fd;
+		}
+		else if (connect(fd, (struct sockaddr *)&su, sizeof(su)) == 0) {
+			return fd;
+		}
+		close(fd);
+		return -1;
+	}
+
+	port = strrchr(addr, ':');			// <host>:<port>
+	if (port == NULL || port - addr >= (long)sizeof(host)) {
+		errno = EINVAL;
+		return -1;
+	}
+	memcpy(host, addr, port - addr);
+	host[port - addr] = '\0';
+	port++;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags    = (listen_fd)? AI_PASSIVE: 0;
+	if (getaddrinfo((host[0])? host: NULL, port, &hints, &ai) != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (p = ai; p; p = p->ai_next) {
+		if ((fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) < 0) continue;
+		if (listen_fd) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (bind(fd, p->ai_addr, p->ai_addrlen) == 0 && listen(fd, NET_BACKLOG) == 0) break;
+		}
+		else if (connect(fd, p->ai_addr, p->ai_addrlen) == 0) {
+			break;
+		}
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(ai);
+
+	return fd;
+}
+
+/**
+ * @brief Listen on an address
+ *
+ * @param[in] addr "unix:<path>" or "<host>:<port>"
+ *
+ * @return Listening socket, -1 on error
+ */
+int oasis_net_listen(const char *addr)
+{
+	return net_open(addr, 1);
+}
+
+/**
+ * @brief Connect to an address
+ *
+ * @param[in] addr "unix:<path>" or "<host>:<port>"
+ *
+ * @return Connected socket, -1 on error
+ */
+int oasis_net_connect(const char *addr)
+{
+	return net_open(addr, 0);
+}
+
+/**
+ * @brief Write all of a buffer (a closed peer is an error, not SIGPIPE)
+ *
+ * @return 0, or -1 on error
+ */
+int oasis_net_write(int fd, const void *buf, size_t len)
+{
+	const char *p = (const char *)buf;
+	ssize_t     n;
+
+	while (len > 0) {
+		n = send(fd, p, len, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return -1;
+		p   += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read all of a buffer
+ *
+ * @return 0, or -1 on error or end of stream
+ */
+int oasis_net_read(int fd, void *buf, size_t len)
+{
+	char   *p = (char *)buf;
+	ssize_t n;
+
+	while (len > 0) {
+		n = read(fd, p, len);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return -1;
+		p   += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read a line (blocking, for the workers)
+ *
+ * @param[in]  fd   Socket
+ * @param[out] buf  Line without '\n', terminated
+ * @param[in]  size Size of buf
+ *
+ * @return Length of the line, -1 on error, end of stream or a too long line
+ */
+int oasis_net_line(int fd, char *buf, int size)
+{
+	int n = 0;
+
+	while (n < size - 1) {
+		if (oasis_net_read(fd, &buf[n], 1) != 0) return -1;
+		if (buf[n] == '\n') {
+			buf[n] = '\0';
+			return n;
+		}
+		n++;
+	}
+
+	return -1;
+}
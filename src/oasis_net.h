@@ -0,0 +1,28 @@
+/**
+ * @file oasis_net.h
+ * @brief Stream sockets of the work-unit coordinator (oasis_coord).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * An address is "unix:<path>" (Unix domain socket) or "<host>:<port>"
+ * (TCP, <host> may be empty: any address for a listener, localhost for a
+ * client).  The protocol on the socket is made of '\n' terminated lines
+ * (see oasis_coord.c).
+ *
+ * @note v1.26.0 (2026-10-16): Add stream sockets (oasis_net)
+ */
+
+#ifndef _OASIS_NET_H
+#define _OASIS_NET_H
+
+#include <stddef.h>
+
+#define OASIS_NET_LINE		(512)		// longest line of the protocol
+
+int oasis_net_listen(const char *addr);
+int oasis_net_connect(const char *addr);
+int oasis_net_write(int fd, const void *buf, size_t len);
+int oasis_net_read(int fd, void *buf, size_t len);
+int oasis_net_line(int fd, char *buf, int size);
+
+#endif  // _OASIS_NET_H
@@ -0,0 +1,444 @@
+/**
+ * @file oasis_out.c
+ * @brief Output stream of the hits: large buffers written by a background thread.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_out.h.  The buffers are a ring: buf[head] .. buf[head + nfull - 1]
+ * are queued to the thread, buf[head + nfull] is being filled.  The thread
+ * also takes the buffer being filled when it has waited OASIS_OUT_MS, or
+ * on oasis_out_flush() / oasis_out_close().
+ *
+ * @note v1.32.1 (2026-10-16): Close a gzip member cut at a checkpoint (oasis_out_gz_end())
+ * @note v1.30.0 (2026-10-16): Add asynchronous output stream (oasis_out)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <gmp.h>
+#ifdef OASIS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "oasis_out.h"
+
+/**
+ * @brief Monotonic time in ns
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Write n bytes to the file (thread of the stream)
+ *
+ * @details After a failed write the rest is dropped and err is kept for
+ *          oasis_out_flush() / oasis_out_close().
+ */
+static void out_put(OASIS_OUT *o, const char *p, size_t n)
+{
+	ssize_t w;
+
+	while (n > 0 && o->err == 0) {
+		w = write(o->fd, p, n);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			o->err = errno;
+			break;
+		}
+		p += w;
+		n -= w;
+		o->bytes_out += w;
+		o->writes++;
+	}
+}
+
+/**
+ * @brief Write a buffer, compressed with OASIS_OUT_GZIP (thread of the stream)
+ *
+ * @param[in,out] o    Stream
+ * @param[in]     p    Bytes (NULL if n = 0)
+ * @param[in]     n    Number of bytes
+ * @param[in]     mode gzip: Z_NO_FLUSH, Z_SYNC_FLUSH or Z_FINISH (0, 1, 2)
+ */
+static void out_emit(OASIS_OUT *o, const char *p, size_t n, int mode)
+{
+#ifdef OASIS_HAVE_ZLIB
+	static const int zmode[] = { Z_NO_FLUSH, Z_SYNC_FLUSH, Z_FINISH };
+	z_stream *zs = (z_stream *)o->zs;
+
+	if (o->flags & OASIS_OUT_GZIP) {
+		zs->next_in  = (Bytef *)p;
+		zs->avail_in = (uInt)n;
+		do {
+			zs->next_out  = (Bytef *)o->zbuf;
+			zs->avail_out = OASIS_OUT_BUF;
+			deflate(zs, zmode[mode]);
+			out_put(o, o->zbuf, OASIS_OUT_BUF - zs->avail_out);
+		} while (zs->avail_out == 0);
+		return;
+	}
+#endif
+	(void)mode;
+	out_put(o, p, n);
+}
+
+/**
+ * @brief Thread of the stream: write the queued buffers
+ *
+ * @param[in] arg Stream (OASIS_OUT)
+ */
+static void *out_thread(void *arg)
+{
+	OASIS_OUT      *o = (OASIS_OUT *)arg;
+	struct timespec ts;
+	int             i, mode;
+
+	pthread_mutex_lock(&o->mtx);
+	for (;;) {
+		if (o->nfull == 0 && o->len[o->head] > 0 && (o->sync || o->quit)) {
+			o->nfull = 1;			// the buffer being filled
+		}
+		if (o->nfull > 0) {
+			i = o->head;
+			o->busy = 1;
+			pthread_mutex_unlock(&o->mtx);
+			out_emit(o, o->buf[i], o->len[i], 0);
+			pthread_mutex_lock(&o->mtx);
+			o->len[i] = 0;
+			o->head   = (i + 1) % OASIS_OUT_NBUF;
+			o->nfull--;
+			o->busy   = 0;
+			pthread_cond_broadcast(&o->freed);
+			continue;
+		}
+		if (o->sync || o->quit) {		// all written
+			mode = (o->quit)? 2: 1;
+			pthread_mutex_unlock(&o->mtx);
+			out_emit(o, NULL, 0, mode);
+			pthread_mutex_lock(&o->mtx);
+			o->sync = 0;
+			pthread_cond_broadcast(&o->freed);
+			if (mode == 2) break;
+			continue;
+		}
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += OASIS_OUT_MS * 1000 * 1000;
+		while (ts.tv_nsec >= 1000 * 1000 * 1000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000 * 1000 * 1000;
+		}
+		if (pthread_cond_timedwait(&o->full, &o->mtx, &ts) == ETIMEDOUT
+		&&  o->nfull == 0 && o->len[o->head] > 0) {
+			o->nfull = 1;			// waited too long
+		}
+	}
+	pthread_mutex_unlock(&o->mtx);
+
+	return NULL;
+}
+
+/**
+ * @brief Release the buffers of a stream
+ */
+static void out_free(OASIS_OUT *o)
+{
+	int i;
+
+#ifdef OASIS_HAVE_ZLIB
+	if (o->zs) deflateEnd((z_stream *)o->zs);
+#endif
+	for (i = 0; i < OASIS_OUT_NBUF; i++) {
+		free(o->buf[i]);
+		o->buf[i] = NULL;
+	}
+	free(o->zs);
+	free(o->zbuf);
+	free(o->line);
+	o->zs   = NULL;
+	o->zbuf = NULL;
+	o->line = NULL;
+}
+
+/**
+ * @brief Open a stream on a file descriptor and start its thread
+ *
+ * @param[out] o     Stream
+ * @param[in]  fd    File descriptor, positioned (not closed by the stream)
+ * @param[in]  flags OASIS_OUT_*
+ *
+ * @return 0 on success, -1 on memory allocation failure, or if
+ *         OASIS_OUT_GZIP is asked for without zlib
+ *
+ * @details Anything the caller printed to fd through stdio must be
+ *          flushed first (fflush(stdout) for STDOUT_FILENO).
+ *          The thread blocks all signals: Ctrl+C and SIGTERM are left to
+ *          the control thread of the scan (see oasis_ctl.h).
+ */
+int oasis_out_open(OASIS_OUT *o, int fd, int flags)
+{
+	sigset_t all, old;
+	int      i, ret = 0;
+
+	memset(o, 0, sizeof(*o));
+	o->fd    = fd;
+	o->flags = flags;
+#ifndef OASIS_HAVE_ZLIB
+	if (flags & OASIS_OUT_GZIP) return -1;	// built without zlib
+#endif
+	for (i = 0; i < OASIS_OUT_NBUF; i++) {
+		o->buf[i] = malloc(OASIS_OUT_BUF);
+		if (o->buf[i] == NULL) ret = -1;
+	}
+#ifdef OASIS_HAVE_ZLIB
+	if (ret == 0 && (flags & OASIS_OUT_GZIP)) {
+		o->zbuf = malloc(OASIS_OUT_BUF);
+		o->zs   = calloc(1, sizeof(z_stream));
+		if ((o->zbuf == NULL) || (o->zs == NULL)
+		||  (deflateInit2((z_stream *)o->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				  15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)) {	// 15 + 16: gzip header
+			free(o->zs);
+			o->zs = NULL;
+			ret = -1;
+		}
+	}
+#endif
+	if (ret != 0) {
+		out_free(o);
+		return -1;
+	}
+
+	pthread_mutex_init(&o->mtx, NULL);
+	pthread_cond_init(&o->full, NULL);
+	pthread_cond_init(&o->freed, NULL);
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);	// inherited by the thread
+	ret = pthread_create(&o->tid, NULL, out_thread, o);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (ret != 0) {
+		pthread_mutex_destroy(&o->mtx);
+		pthread_cond_destroy(&o->full);
+		pthread_cond_destroy(&o->freed);
+		out_free(o);
+		return -1;
+	}
+	o->running = 1;
+
+	return 0;
+}
+
+/**
+ * @brief Append bytes to the stream
+ *
+ * @return 0, or -1 if a write of the stream has failed
+ *
+ * @details Waits only when all buffers are queued (ns_stall).
+ */
+int oasis_out_write(OASIS_OUT *o, const void *p, size_t n)
+{
+	const char *s = (const char *)p;
+	uint64_t    t0;
+	size_t      c;
+	int         f, err;
+
+	pthread_mutex_lock(&o->mtx);
+	o->bytes_in += n;
+	while (n > 0) {
+		f = (o->head + o->nfull) % OASIS_OUT_NBUF;
+		c = OASIS_OUT_BUF - o->len[f];
+		if (c == 0) {				// full: queue it
+			if (o->nfull == OASIS_OUT_NBUF - 1) {
+				t0 = now_ns();
+				pthread_cond_wait(&o->freed, &o->mtx);
+				o->ns_stall += now_ns() - t0;
+				continue;
+			}
+			o->nfull++;
+			pthread_cond_signal(&o->full);
+			continue;
+		}
+		if (c > n) c = n;
+		memcpy(o->buf[f] + o->len[f], s, c);
+		o->len[f] += c;
+		s += c;
+		n -= c;
+	}
+	err = o->err;
+	pthread_mutex_unlock(&o->mtx);
+
+	return (err)? -1: 0;
+}
+
+/**
+ * @brief Format a line with gmp_printf() conversions and append it
+ *
+ * @param[in,out] o    Stream
+ * @param[out]    line The formatted text, valid until the next call (NULL: not needed)
+ * @param[in]     fmt  Format of gmp_printf()
+ *
+ * @return Length of the text, or -1 on memory allocation failure
+ *
+ * @note The scratch of the text is the stream's own: one thread formats.
+ */
+int oasis_out_printf(OASIS_OUT *o, const char **line, const char *fmt, ...)
+{
+	va_list ap, aq;
+	char   *nl;
+	int     len;
+
+	va_start(ap, fmt);
+	va_copy(aq, ap);
+	len = gmp_vsnprintf(o->line, o->line_cap, fmt, ap);
+	if (len >= 0 && (size_t)len >= o->line_cap) {	// grow the scratch, format again
+		nl = realloc(o->line, len + 256);
+		if (nl == NULL) {
+			len = -1;
+		}
+		else {
+			o->line     = nl;
+			o->line_cap = len + 256;
+			len = gmp_vsnprintf(o->line, o->line_cap, fmt, aq);
+		}
+	}
+	va_end(aq);
+	va_end(ap);
+	if (len < 0) return -1;
+
+	if (line) *line = o->line;
+	oasis_out_write(o, o->line, len);
+
+	return len;
+}
+
+/**
+ * @brief Write everything appended so far
+ *
+ * @return 0, or -1 if a write of the stream has failed
+ *
+ * @details A gzip stream is flushed to a byte boundary (Z_SYNC_FLUSH):
+ *          the file can be decompressed up to here even if the process
+ *          dies before oasis_out_close().
+ */
+int oasis_out_flush(OASIS_OUT *o)
+{
+	int err;
+
+	if (!o->running) return 0;
+	pthread_mutex_lock(&o->mtx);
+	o->sync = 1;
+	pthread_cond_signal(&o->full);
+	while (o->sync) {
+		pthread_cond_wait(&o->freed, &o->mtx);
+	}
+	err = o->err;
+	pthread_mutex_unlock(&o->mtx);
+
+	return (err)? -1: 0;
+}
+
+/**
+ * @brief Write the rest, end the gzip stream and stop the thread
+ *
+ * @return 0, or -1 if a write of the stream has failed (again on a
+ *         stream closed already)
+ *
+ * @note The file descriptor is left open.
+ */
+int oasis_out_close(OASIS_OUT *o)
+{
+	if (!o->running) return (o->err)? -1: 0;	// closed already
+	pthread_mutex_lock(&o->mtx);
+	o->quit = 1;
+	pthread_cond_signal(&o->full);
+	pthread_mutex_unlock(&o->mtx);
+	pthread_join(o->tid, NULL);
+	o->running = 0;
+
+	pthread_mutex_destroy(&o->mtx);
+	pthread_cond_destroy(&o->full);
+	pthread_cond_destroy(&o->freed);
+	out_free(o);
+
+	return (o->err)? -1: 0;
+}
+
+/**
+ * @brief Output file to be compressed?
+ *
+ * @return OASIS_OUT_GZIP if path ends with ".gz", 0 otherwise
+ */
+int oasis_out_gz(const char *path)
+{
+	size_t n = (path)? strlen(path): 0;
+
+	return (n > 3 && strcmp(&path[n - 3], ".gz") == 0)? OASIS_OUT_GZIP: 0;
+}
+
+/**
+ * @brief CRC and length of the open gzip member (after oasis_out_flush())
+ *
+ * @param[in]  o   Stream, flushed and nothing appended since
+ * @param[out] crc CRC-32 of the bytes of the member
+ * @param[out] len Bytes of the member (mod 2^32)
+ *
+ * @return 1 if o is an open gzip stream, 0 otherwise (crc, len not set)
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+int oasis_out_gz_member(OASIS_OUT *o, uint32_t *crc, uint32_t *len)
+{
+#ifdef OASIS_HAVE_ZLIB
+	z_stream *zs = (z_stream *)o->zs;
+
+	if (o->running && (o->flags & OASIS_OUT_GZIP) && zs) {
+		pthread_mutex_lock(&o->mtx);		// the thread is idle: the stream is flushed
+		*crc = (uint32_t)zs->adler;		// gzip wrapper: adler is the CRC-32
+		*len = (uint32_t)zs->total_in;
+		pthread_mutex_unlock(&o->mtx);
+		return 1;
+	}
+#endif
+	(void)o;
+	(void)crc;
+	(void)len;
+	return 0;
+}
+
+/**
+ * @brief Close a gzip member that was cut right after a sync flush
+ *
+ * @param[in] fd  File, positioned at the end of the member
+ * @param[in] crc CRC-32 of the member (oasis_out_gz_member())
+ * @param[in] len Its uncompressed bytes (mod 2^32)
+ *
+ * @return 0 on success, -1 if it cannot be written
+ *
+ * @details A sync flush ends on a byte boundary, so the member is closed
+ *          by an empty final block (fixed Huffman codes: 0x03 0x00, what
+ *          deflate() writes for Z_FINISH there) and the gzip trailer.
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+int oasis_out_gz_end(int fd, uint32_t crc, uint32_t len)
+{
+	unsigned char end[10] = { 0x03, 0x00 };
+	int           i;
+
+	for (i = 0; i < 4; i++) {
+		end[2 + i] = (unsigned char)(crc >> (8 * i));	// little endian
+		end[6 + i] = (unsigned char)(len >> (8 * i));
+	}
+
+	return (write(fd, end, sizeof(end)) == (ssize_t)sizeof(end))? 0: -1;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file oasis_out.h
+ * @brief Output stream of the hits: large buffers written by a background thread.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The hit callbacks used to gmp_printf() every line to stdout, so a
+ * terminal or a slow pipe held up the scan at each line.  The commands now
+ * append the lines to a buffer of OASIS_OUT_BUF bytes; a full buffer, or
+ * one that has waited OASIS_OUT_MS, is handed to the thread of the stream,
+ * which writes it with one write() (and compresses it first with
+ * OASIS_OUT_GZIP).  The scan only waits when all OASIS_OUT_NBUF buffers
+ * are queued (the stall of the stream).
+ *
+ * oasis_out_flush() returns when every byte appended so far is written
+ * (a gzip stream is flushed to a byte boundary, so it can be read up to
+ * there): the commands call it before a checkpoint and before anything
+ * else is printed.  Every command that writes through a stream runs the
+ * control thread of the scan (see oasis_ctl.h), which takes Ctrl+C and
+ * SIGTERM, and closes the stream before that thread ends, so an interrupt
+ * never loses a hit.  Only a kill -9 loses the bytes not flushed yet.
+ *
+ * A gzip member flushed by oasis_out_flush() can be closed later from
+ * its CRC and length (oasis_out_gz_member(), oasis_out_gz_end()): --resume
+ * cuts the file back to a checkpoint, closes the member and appends a new
+ * one, so the file stays one valid gzip stream.
+ *
+ * @note v1.32.1 (2026-10-16): oasis_layer1 runs the control thread too;
+ *       add oasis_out_gz_member() and oasis_out_gz_end()
+ *
+ * @note v1.30.0 (2026-10-16): Add asynchronous output stream (oasis_out)
+ */
+
+#ifndef _OASIS_OUT_H
+#define _OASIS_OUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define OASIS_OUT_BUF		(1 << 20)	// bytes of a buffer (a write())
+#define OASIS_OUT_NBUF		(4)		// buffers: one filled, the others queued
+#define OASIS_OUT_MS		(500)		// a buffer is written after waiting this long
+
+/* oasis_out_open() flags */
+#define OASIS_OUT_GZIP		(0x01)		// gzip stream (zlib, see oasis_out_gz())
+
+typedef struct {
+	int		 fd;			// written by the thread of the stream (not closed)
+	int		 flags;			// OASIS_OUT_*
+	char		*buf[OASIS_OUT_NBUF];
+	size_t		 len[OASIS_OUT_NBUF];
+	int		 head;			// first queued buffer
+	int		 nfull;			// queued buffers, buf[head + nfull] is filled
+	int		 busy;			// the thread is writing buf[head]
+	int		 sync;			// oasis_out_flush() waits (gzip: flush the stream)
+	int		 quit;			// oasis_out_close(): write the rest and end
+	int		 err;			// errno of a failed write (0: none)
+	char		*line;			// scratch of oasis_out_printf()
+	size_t		 line_cap;
+	void		*zs;			// z_stream (OASIS_OUT_GZIP)
+	char		*zbuf;			// compressed bytes
+	uint64_t	 bytes_in;		// bytes appended
+	uint64_t	 bytes_out;		// bytes written
+	uint64_t	 writes;		// write() calls
+	uint64_t	 ns_stall;		// ns the caller waited for a free buffer
+	pthread_mutex_t	 mtx;
+	pthread_cond_t	 full;			// a buffer is queued, or sync/quit
+	pthread_cond_t	 freed;			// a buffer is written
+	pthread_t	 tid;
+	int		 running;
+} OASIS_OUT;
+
+int  oasis_out_open(OASIS_OUT *o, int fd, int flags);
+int  oasis_out_write(OASIS_OUT *o, const void *p, size_t n);
+int  oasis_out_printf(OASIS_OUT *o, const char **line, const char *fmt, ...);
+int  oasis_out_flush(OASIS_OUT *o);
+int  oasis_out_close(OASIS_OUT *o);
+int  oasis_out_gz(const char *path);
+int  oasis_out_gz_member(OASIS_OUT *o, uint32_t *crc, uint32_t *len);
+int  oasis_out_gz_end(int fd, uint32_t crc, uint32_t len);
+
+#endif  // _OASIS_OUT_H
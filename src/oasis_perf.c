@@ -0,0 +1,255 @@
+/**
+ * @file oasis_perf.c
+ * @brief Hardware performance counters of the phases of a scan (perf_event).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_perf.h.  The counters of a thread are one group (read with one
+ * read()), counted in user space only, so perf_event_paranoid <= 2 is
+ * enough.  The counts are scaled by time enabled / time running when the
+ * kernel multiplexes the PMU.
+ *
+ * @note v1.22.0 (2026-10-16): Add hardware performance counters (perf_event)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "oasis_perf.h"
+
+/* The counters: name, type and config */
+typedef struct {
+	const char *name;
+	uint32_t    type;
+	uint64_t    config;
+} PERF_EV;
+
+#ifdef __linux__
+static const PERF_EV perf_ev[OASIS_PERF_NUM] = {
+	{"task_ns",  PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+	{"cycles",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{"instr",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{"l1d_miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+				       | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+				       | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	{"llc_miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{"br_miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+#else
+static const PERF_EV perf_ev[OASIS_PERF_NUM] = {
+	{"task_ns", 0, 0}, {"cycles", 0, 0}, {"instr", 0, 0},
+	{"l1d_miss", 0, 0}, {"llc_miss", 0, 0}, {"br_miss", 0, 0},
+};
+#endif
+
+/**
+ * @brief Name of a counter (JSON key)
+ */
+const char *oasis_perf_name(int ctr)
+{
+	return (ctr >= 0 && ctr < OASIS_PERF_NUM)? perf_ev[ctr].name: "?";
+}
+
+/**
+ * @brief Read the group: counts and times of the counters that are open
+ *
+ * @return 0, or -1 if the read failed
+ */
+static int perf_read(OASIS_PERF *pf, uint64_t *val, uint64_t *ena, uint64_t *run)
+{
+	uint64_t buf[3 + OASIS_PERF_NUM];		// nr, enabled, running, values
+	int      i;
+
+	if (read(pf->fd[OASIS_PERF_CLOCK], buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) {
+		return -1;
+	}
+	*ena = buf[1];
+	*run = buf[2];
+	for (i = 0; i < OASIS_PERF_NUM; i++) {
+		val[i] = (pf->fd[i] >= 0 && pf->idx[i] < (int)buf[0])? buf[3 + pf->idx[i]]: 0;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Open the counter group of the calling thread
+ *
+ * @param[out] pf Counter group, in phase OASIS_PERF_NONE
+ *
+ * @return 0 if at least the task clock is counted, -1 otherwise
+ *         (pf->cnt->err is set, oasis_perf_phase() does nothing)
+ */
+int oasis_perf_open(OASIS_PERF *pf)
+{
+	int i;
+
+	memset(pf, 0, sizeof(*pf));
+	for (i = 0; i < OASIS_PERF_NUM; i++) {
+		pf->fd[i] = -1;
+	}
+	pf->phase = OASIS_PERF_NONE;
+
+#ifdef __linux__
+	struct perf_event_attr attr;
+
+	for (i = 0; i < OASIS_PERF_NUM; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.size           = sizeof(attr);
+		attr.type           = perf_ev[i].type;
+		attr.config         = perf_ev[i].config;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv     = 1;
+		attr.read_format    = PERF_FORMAT_GROUP
+				    | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attr.disabled       = (i == OASIS_PERF_CLOCK);	// the leader starts the group
+		pf->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+					 (i == OASIS_PERF_CLOCK)? -1: pf->fd[OASIS_PERF_CLOCK], 0);
+		if (pf->fd[i] < 0) {
+			if (i == OASIS_PERF_CLOCK) {
+				pf->cnt->err = errno;
+				return -1;
+			}
+			continue;				// not offered by this machine
+		}
+		pf->idx[i] = pf->nfd++;
+		pf->cnt->avail |= 1u << i;
+	}
+	if (ioctl(pf->fd[OASIS_PERF_CLOCK], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0
+	||  perf_read(pf, pf->last, &pf->ena, &pf->run) != 0) {
+		pf->cnt->err   = errno;
+		pf->cnt->avail = 0;
+		oasis_perf_close(pf);
+		return -1;
+	}
+
+	return 0;
+#else
+	pf->cnt->err = ENOSYS;
+	return -1;
+#endif
+}
+
+/**
+ * @brief Change the phase of the calling thread
+ *
+ * @param[in,out] pf    Counter group of the thread
+ * @param[in]     phase OASIS_PERF_SIEVE/PRP/OUT/NONE
+ *
+ * @return The phase before
+ *
+ * @details The counts since the last change are added to the phase that
+ *          ends.  Staying in the same phase costs nothing, a change is one
+ *          read() of the group.
+ */
+int oasis_perf_phase(OASIS_PERF *pf, int phase)
+{
+	uint64_t val[OASIS_PERF_NUM];
+	uint64_t ena, run;
+	double   scale;
+	int      old = pf->phase;
+	int      i;
+
+	if (phase == old || pf->nfd == 0) return old;
+
+	pf->phase = phase;
+	if (perf_read(pf, val, &ena, &run) != 0) return old;
+	if (old != OASIS_PERF_NONE) {
+		scale = (run > pf->run)? (double)(ena - pf->ena) / (run - pf->run): 1.0;
+		for (i = 0; i < OASIS_PERF_NUM; i++) {
+			pf->cnt->v[old][i] += (uint64_t)((val[i] - pf->last[i]) * scale + 0.5);
+		}
+	}
+	memcpy(pf->last, val, sizeof(val));
+	pf->ena = ena;
+	pf->run = run;
+
+	return old;
+}
+
+/**
+ * @brief Close the counter group (the counts stay in pf->cnt)
+ */
+void oasis_perf_close(OASIS_PERF *pf)
+{
+	int i;
+
+	oasis_perf_phase(pf, OASIS_PERF_NONE);
+	for (i = OASIS_PERF_NUM - 1; i >= 0; i--) {	// the leader last
+		if (pf->fd[i] >= 0) close(pf->fd[i]);
+		pf->fd[i] = -1;
+	}
+	pf->nfd = 0;
+}
+
+/**
+ * @brief Add the counts of a thread
+ *
+ * @details A counter is available if it was counted by every thread that
+ *          counted at all; the error is the one of the first thread.
+ */
+void oasis_perf_add(OASIS_PERF_CNT *dst, const OASIS_PERF_CNT *src)
+{
+	int p, i;
+
+	if (src->err) {
+		if (dst->err == 0 && dst->avail == 0) dst->err = src->err;
+		return;
+	}
+	dst->avail = (dst->avail)? dst->avail & src->avail: src->avail;
+	dst->err   = 0;
+	for (p = 0; p < OASIS_PERF_PHASES; p++) {
+		for (i = 0; i < OASIS_PERF_NUM; i++) {
+			dst->v[p][i] += src->v[p][i];
+		}
+	}
+}
+
+/**
+ * @brief Print the counts per million candidates, one line per phase
+ *
+ * @param[in] fp   Stream
+ * @param[in] pc   Counts of the scan
+ * @param[in] cand Candidates of the scan (try count)
+ */
+void oasis_perf_print(FILE *fp, const OASIS_PERF_CNT *pc, uint64_t cand)
+{
+	static const char *phase[OASIS_PERF_PHASES] = { "sieve", "prp", "out" };
+	double per = (cand)? 1e6 / cand: 0.0;
+	int    p, i;
+
+	if (pc->avail == 0) {
+		fprintf(fp, "perf counters not available (%s)\n", strerror(pc->err));
+		return;
+	}
+	fprintf(fp, "%-6s", "per 1M");
+	for (i = 0; i < OASIS_PERF_NUM; i++) {
+		fprintf(fp, " %14s", perf_ev[i].name);
+	}
+	fprintf(fp, " %6s\n", "IPC");
+	for (p = 0; p < OASIS_PERF_PHASES; p++) {
+		fprintf(fp, "%-6s", phase[p]);
+		for (i = 0; i < OASIS_PERF_NUM; i++) {
+			if (pc->avail & (1u << i)) fprintf(fp, " %14.0f", pc->v[p][i] * per);
+			else                       fprintf(fp, " %14s", "-");
+		}
+		if ((pc->avail & (1u << OASIS_PERF_CYCLES)) && (pc->avail & (1u << OASIS_PERF_INSTR))
+		&&  pc->v[p][OASIS_PERF_CYCLES]) {
+			fprintf(fp, " %6.2f\n", (double)pc->v[p][OASIS_PERF_INSTR] / pc->v[p][OASIS_PERF_CYCLES]);
+		}
+		else {
+			fprintf(fp, " %6s\n", "-");
+		}
+	}
+	fflush(fp);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file oasis_perf.h
+ * @brief Hardware performance counters of the phases of a scan (perf_event).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * A thread opens one perf_event group of its own (task clock, cycles,
+ * instructions, L1D read misses, LLC misses, branch misses) and tells which
+ * phase of the scan it is in; the counts between two phase changes go to
+ * the phase that ended.  The counters of the threads are added up at the
+ * end of the scan.
+ *
+ * Counters the kernel does not offer (a VM, perf_event_paranoid, no PMU)
+ * are left out; if not even the task clock can be opened, nothing is
+ * counted and err tells why.  The scan runs the same either way.
+ *
+ * @note v1.22.0 (2026-10-16): Add hardware performance counters (perf_event)
+ */
+
+#ifndef _OASIS_PERF_H
+#define _OASIS_PERF_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Counters */
+#define OASIS_PERF_CLOCK	(0)		// task clock [ns], the group leader
+#define OASIS_PERF_CYCLES	(1)
+#define OASIS_PERF_INSTR	(2)
+#define OASIS_PERF_L1D_MISS	(3)		// L1 data cache read misses
+#define OASIS_PERF_LLC_MISS	(4)		// last level cache misses
+#define OASIS_PERF_BR_MISS	(5)		// mispredicted branches
+#define OASIS_PERF_NUM		(6)
+
+/* Phases of a scan */
+#define OASIS_PERF_NONE		(-1)		// not counted (waiting)
+#define OASIS_PERF_SIEVE	(0)		// scan loop and sieve
+#define OASIS_PERF_PRP		(1)		// screen and primality test
+#define OASIS_PERF_OUT		(2)		// hit callback
+#define OASIS_PERF_PHASES	(3)
+
+/* Counts of the phases */
+typedef struct {
+	uint64_t	v[OASIS_PERF_PHASES][OASIS_PERF_NUM];
+	uint32_t	avail;				// bit i: counter i was counted
+	int		err;				// errno of the task clock (0: counted)
+} OASIS_PERF_CNT;
+
+/* Counter group of a thread */
+typedef struct {
+	int		fd[OASIS_PERF_NUM];		// -1: not opened
+	int		idx[OASIS_PERF_NUM];		// position in the group read
+	int		nfd;
+	int		phase;				// OASIS_PERF_*
+	uint64_t	last[OASIS_PERF_NUM];		// counts at the last change
+	uint64_t	ena, run;			// time enabled/running at the last change
+	OASIS_PERF_CNT	cnt[1];
+} OASIS_PERF;
+
+int         oasis_perf_open(OASIS_PERF *pf);
+int         oasis_perf_phase(OASIS_PERF *pf, int phase);
+void        oasis_perf_close(OASIS_PERF *pf);
+void        oasis_perf_add(OASIS_PERF_CNT *dst, const OASIS_PERF_CNT *src);
+const char *oasis_perf_name(int ctr);
+void        oasis_perf_print(FILE *fp, const OASIS_PERF_CNT *pc, uint64_t cand);
+
+#endif  // _OASIS_PERF_H
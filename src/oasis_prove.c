@@ -0,0 +1,535 @@
+/**
+ * @file oasis_prove.c
+ * @brief Primality proof of d<n>*k+-1 from the factorization of d<n>.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Only a part F of d<n> is used, just large enough for the theorem:
+ *   - d<n>*k+1: F^3 >= N (Brillhart-Lehmer-Selfridge), F^2 >= N (Pocklington)
+ *   - d<n>*k-1: (F-1)^2 > N (Morrison)
+ * The prime factors are taken in order of decreasing exponent, so the
+ * high powers 2^9, 3^5, 5^4, ... come almost for free.
+ *
+ * Every prime p <= n divides N-+1, so every base made of them is a
+ * quadratic residue of N: the N-1 test uses the first non-residue as the
+ * base, and the N+1 test (Q = 1 makes U_((N+1)/2) vanish) leaves 2 out of F.
+ *
+ * For every prime q | F the theorems need a^((N-1)/q) (or the Lucas term
+ * V_((N+1)/q)).  They are computed with a product tree from
+ * y = a^((N-1)/R), R = product of the q: each level of the tree costs
+ * one exponentiation by R, and the root y^R = a^(N-1) is the Fermat
+ * test itself, so a composite is rejected after one exponentiation.
+ *
+ * @note v1.32.1 (2026-10-16): The N+1 retry of a q keeps the discriminant D
+ *       common to all q, as Morrison's theorem needs
+ * @note v1.10.0 (2026-10-16): Add N-1 / N+1 primality proof
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_sieve.h"
+#include "oasis_prove.h"
+
+#define PROVE_SMALL	(1000000)	// mpz_probab_prime_p() is exact below
+#define PROVE_BASES	(64)		// bases (Lucas parameters) to try per q
+
+typedef struct {
+	uint32_t	p;
+	uint32_t	e;
+	uint32_t	pe;
+} PV_FAC;
+
+/**
+ * @brief qsort() order of the prime factors: 2, then exponent desc, prime desc
+ */
+static int cmp_fac(const void *a, const void *b)
+{
+	const PV_FAC *fa = (const PV_FAC *)a;
+	const PV_FAC *fb = (const PV_FAC *)b;
+
+	if (fa->p == 2 || fb->p == 2) return (fa->p == 2)? -1: 1;
+	if (fa->e != fb->e) return (fa->e < fb->e)? 1: -1;
+	if (fa->p != fb->p) return (fa->p < fb->p)? 1: -1;
+	return 0;
+}
+
+/**
+ * @brief Initialize the factorization of d<n>
+ *
+ * @param[out] pv Prover
+ * @param[in]  n  d<n> = LCM(1,2,3,...n), n >= 2
+ *
+ * @return 0 on success, -1 on memory allocation failure
+ *
+ * @note The prover is read only afterwards and may be shared by threads.
+ */
+int oasis_prove_init(OASIS_PROVE *pv, int n)
+{
+	uint32_t *tbl;
+	uint32_t  cnt;
+	PV_FAC   *fac;
+	uint64_t  pe;
+	uint32_t  j;
+
+	memset(pv, 0, sizeof(*pv));
+	pv->n = n;
+
+	tbl = oasis_prime_table((uint32_t)n, &cnt);
+	if (tbl == NULL) return -1;
+
+	fac      = malloc(((size_t)cnt + 1) * sizeof(PV_FAC));
+	pv->prm  = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	pv->pwr  = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	if ((fac == NULL) || (pv->prm == NULL) || (pv->pwr == NULL)) {
+		free(tbl);
+		free(fac);
+		oasis_prove_clear(pv);
+		return -1;
+	}
+
+	for (j = 0; j < cnt; j++) {			// p^e <= n < p^(e+1)
+		fac[j].p = tbl[j];
+		fac[j].e = 1;
+		for (pe = tbl[j]; pe * tbl[j] <= (uint64_t)n; pe *= tbl[j]) {
+			fac[j].e++;
+		}
+		fac[j].pe = (uint32_t)pe;
+	}
+	qsort(fac, cnt, sizeof(PV_FAC), cmp_fac);
+
+	for (j = 0; j < cnt; j++) {
+		pv->prm[j] = fac[j].p;
+		pv->pwr[j] = fac[j].pe;
+	}
+	pv->nfac = cnt;
+
+	free(fac);
+	free(tbl);
+
+	return 0;
+}
+
+/**
+ * @brief Release the prover
+ *
+ * @param[in,out] pv Prover
+ */
+void oasis_prove_clear(OASIS_PROVE *pv)
+{
+	free(pv->prm);
+	free(pv->pwr);
+	memset(pv, 0, sizeof(*pv));
+}
+
+/**
+ * @brief Take the factored part F of d<n> needed for N
+ *
+ * @param[in]  pv    Prover
+ * @param[in]  N     Candidate
+ * @param[in]  root  3: F^3 >= N, 2: (F-1)^2 > N
+ * @param[in]  first First prime factor to use (1: leave 2 out)
+ * @param[out] F     Product of prm[j]^e, first <= j < end
+ * @param[out] R     Product of prm[j], first <= j < end
+ *
+ * @return end, 0 if all of d<n> is not enough
+ */
+static uint32_t factored_part(const OASIS_PROVE *pv, mpz_t N, int root, uint32_t first,
+			      mpz_t F, mpz_t R)
+{
+	size_t   nbits = mpz_sizeinbase(N, 2);
+	uint32_t j;
+	int      ok = 0;
+	mpz_t    t;
+
+	mpz_init(t);
+	mpz_set_ui(F, 1);
+	mpz_set_ui(R, 1);
+	for (j = first; j < pv->nfac && !ok; j++) {
+		mpz_mul_ui(F, F, pv->pwr[j]);
+		mpz_mul_ui(R, R, pv->prm[j]);
+		if ((mpz_sizeinbase(F, 2) - 1) * root + 1 < nbits) continue;	// too small
+
+		if (root == 3) {
+			mpz_pow_ui(t, F, 3);
+			ok = (mpz_cmp(t, N) >= 0);
+		}
+		else {
+			mpz_sub_ui(t, F, 1);
+			mpz_mul(t, t, t);
+			ok = (mpz_cmp(t, N) > 0);
+		}
+	}
+	mpz_clear(t);
+
+	return (ok)? j: 0;
+}
+
+/**
+ * @brief Product of primes
+ */
+static void prime_product(mpz_t r, const uint32_t *q, uint32_t cnt)
+{
+	mpz_set_ui(r, 1);
+	while (cnt--) {
+		mpz_mul_ui(r, r, *q++);
+	}
+}
+
+/**
+ * @brief V_e(P) mod N of the Lucas sequence with Q = 1
+ *
+ * @param[out] v V_e(P)
+ * @param[in]  P Parameter of the sequence (discriminant P^2 - 4)
+ * @param[in]  e Index
+ * @param[in]  N Modulus
+ *
+ * @note With Q = 1, V_mn(P) = V_m(V_n(P)), so V behaves like a power.
+ */
+static void lucas_v(mpz_t v, mpz_t P, mpz_t e, mpz_t N)
+{
+	mpz_t v0, v1;	// V_k, V_k+1
+	long  b;
+
+	mpz_init_set_ui(v0, 2);
+	mpz_init_set(v1, P);
+	for (b = (long)mpz_sizeinbase(e, 2) - 1; b >= 0 && mpz_sgn(e) > 0; b--) {
+		if (mpz_tstbit(e, b)) {			// k -> 2k+1
+			mpz_mul(v0, v0, v1);
+			mpz_sub(v0, v0, P);
+			mpz_mod(v0, v0, N);
+			mpz_mul(v1, v1, v1);
+			mpz_sub_ui(v1, v1, 2);
+			mpz_mod(v1, v1, N);
+		}
+		else {					// k -> 2k
+			mpz_mul(v1, v0, v1);
+			mpz_sub(v1, v1, P);
+			mpz_mod(v1, v1, N);
+			mpz_mul(v0, v0, v0);
+			mpz_sub_ui(v0, v0, 2);
+			mpz_mod(v0, v0, N);
+		}
+	}
+	mpz_set(v, v0);
+
+	mpz_clear(v0);
+	mpz_clear(v1);
+}
+
+/**
+ * @brief Check a^((N-1)/q) (or V_((N+1)/q)) for every q with a product tree
+ *
+ * @param[in]  w     a^((N-1)/(q[0]*...*q[cnt-1])), or the Lucas term
+ * @param[in]  q     Primes
+ * @param[in]  cnt   Number of primes
+ * @param[in]  N     Candidate
+ * @param[in]  lucas 0: N-1 (power), 1: N+1 (Lucas V with Q = 1)
+ * @param[out] retry Primes whose condition failed for this base
+ * @param[out] nretry Number of retry[]
+ *
+ * @return 0 if no factor of N was found, -1 if N is composite
+ *
+ * @details The leaf condition is gcd(a^((N-1)/q) - 1, N) = 1 for N-1 and
+ *          gcd(V^2 - 4, N) = 1 (i.e. gcd(U_((N+1)/q), N) = 1) for N+1.
+ *          A leaf that is 1 (or +-2) modulo N only asks for another base.
+ */
+static int prove_tree(mpz_t w, const uint32_t *q, uint32_t cnt, mpz_t N, int lucas,
+		      uint32_t *retry, uint32_t *nretry)
+{
+	int      ret = 0;
+	uint32_t mid;
+	mpz_t    e, x;
+
+	mpz_init(e);
+	mpz_init(x);
+
+	if (cnt == 1) {
+		if (lucas) {				// x = V^2 - 4
+			mpz_mul(x, w, w);
+			mpz_sub_ui(x, x, 4);
+			mpz_mod(x, x, N);
+		}
+		else {					// x = a^((N-1)/q) - 1
+			mpz_sub_ui(x, w, 1);
+		}
+		if (mpz_sgn(x) == 0) {			// base is a q-th power
+			retry[(*nretry)++] = q[0];
+		}
+		else {
+			mpz_gcd(x, x, N);
+			if (mpz_cmp_ui(x, 1) != 0) ret = -1;	// factor found
+		}
+	}
+	else {
+		mid = cnt / 2;
+		prime_product(e, q + mid, cnt - mid);		// left:  w^(q[mid]*...)
+		if (lucas) lucas_v(x, w, e, N); else mpz_powm(x, w, e, N);
+		ret = prove_tree(x, q, mid, N, lucas, retry, nretry);
+
+		if (ret == 0) {
+			prime_product(e, q, mid);		// right: w^(q[0]*...)
+			if (lucas) lucas_v(x, w, e, N); else mpz_powm(x, w, e, N);
+			ret = prove_tree(x, q + mid, cnt - mid, N, lucas, retry, nretry);
+		}
+	}
+
+	mpz_clear(e);
+	mpz_clear(x);
+
+	return ret;
+}
+
+/**
+ * @brief Prove N = d<n>*k+1 with the factorization of N-1
+ *
+ * @param[in] pv Prover of d<n> (d<n> must divide N-1)
+ * @param[in] N  Candidate
+ *
+ * @return OASIS_PRIME, OASIS_COMPOSITE, or the result of
+ *         mpz_probab_prime_p(N, 25) when the proof is not possible
+ *
+ * @details Pocklington: if F | N-1 and for every prime q | F some a has
+ *          a^(N-1) = 1 and gcd(a^((N-1)/q) - 1, N) = 1, every prime factor
+ *          of N is 1 mod F.  With F^2 >= N, N is prime.
+ *          With F^3 >= N > F^2, N is prime unless N = (aF+1)(bF+1), which
+ *          is the case iff c1^2 - 4c2 is a square for
+ *          N = c2*F^2 + c1*F + 1, 0 <= c1 < F (Brillhart-Lehmer-Selfridge).
+ */
+int oasis_prove_p1(const OASIS_PROVE *pv, mpz_t N)
+{
+	int       ret = OASIS_PRIME;
+	uint32_t  cnt, nretry = 0;
+	uint32_t *retry = NULL;
+	uint32_t  i;
+	unsigned long a;
+	mpz_t     N1, F, R, y, z, c1, c2;
+
+	if (mpz_cmp_ui(N, PROVE_SMALL) < 0) return mpz_probab_prime_p(N, 25);
+
+	mpz_init(N1);
+	mpz_init(F);
+	mpz_init(R);
+	mpz_init(y);
+	mpz_init(z);
+	mpz_init(c1);
+	mpz_init(c2);
+
+	mpz_sub_ui(N1, N, 1);
+	cnt = factored_part(pv, N, 3, 0, F, R);
+	if ((cnt == 0) || !mpz_divisible_p(N1, F)
+	||  ((retry = malloc(cnt * sizeof(uint32_t))) == NULL)) {
+		ret = mpz_probab_prime_p(N, 25);
+		goto out;
+	}
+
+	/*--- base: quadratic non-residue, a^((N-1)/2) = -1 ---*/
+	for (a = 2; a < (unsigned long)pv->n + 2 + PROVE_BASES; a++) {
+		if (mpz_ui_kronecker(a, N) == -1) break;
+	}
+	if (a == (unsigned long)pv->n + 2 + PROVE_BASES) {	// N may be a square
+		ret = mpz_probab_prime_p(N, 25);
+		goto out;
+	}
+
+	/*--- Fermat: a^(N-1) = (a^((N-1)/R))^R ---*/
+	mpz_divexact(c1, N1, R);
+	mpz_set_ui(y, a);
+	mpz_powm(y, y, c1, N);				// y = a^((N-1)/R)
+	mpz_powm(z, y, R, N);				// z = a^(N-1)
+	if (mpz_cmp_ui(z, 1) != 0) {
+		ret = OASIS_COMPOSITE;
+		goto out;
+	}
+
+	/*--- Pocklington condition for every q | F ---*/
+	if (prove_tree(y, pv->prm, cnt, N, 0, retry, &nretry) != 0) {
+		ret = OASIS_COMPOSITE;
+		goto out;
+	}
+	for (i = 0; i < nretry && ret == OASIS_PRIME; i++) {
+		mpz_divexact_ui(c1, N1, retry[i]);
+		for (a++; a < (unsigned long)pv->n + 2 + 2 * PROVE_BASES; a++) {
+			mpz_set_ui(y, a);
+			mpz_powm(y, y, c1, N);		// y = a^((N-1)/q)
+			if (mpz_cmp_ui(y, 1) == 0) continue;
+			mpz_powm_ui(z, y, retry[i], N);	// z = a^(N-1)
+			mpz_sub_ui(y, y, 1);
+			mpz_gcd(y, y, N);
+			if ((mpz_cmp_ui(z, 1) != 0) || (mpz_cmp_ui(y, 1) != 0)) {
+				ret = OASIS_COMPOSITE;
+			}
+			break;
+		}
+		if (a >= (unsigned long)pv->n + 2 + 2 * PROVE_BASES) {	// no base found
+			ret = mpz_probab_prime_p(N, 25);
+		}
+	}
+
+	/*--- Brillhart-Lehmer-Selfridge for F^2 < N ---*/
+	mpz_mul(z, F, F);
+	if ((ret == OASIS_PRIME) && (mpz_cmp(z, N) < 0)) {
+		mpz_divexact(z, N1, F);
+		mpz_fdiv_qr(c2, c1, z, F);		// N = c2*F^2 + c1*F + 1
+		mpz_mul(z, c1, c1);
+		mpz_submul_ui(z, c2, 4);
+		if ((mpz_sgn(z) >= 0) && mpz_perfect_square_p(z)) {
+			ret = mpz_probab_prime_p(N, 25);
+		}
+	}
+
+out:
+	free(retry);
+	mpz_clear(N1);
+	mpz_clear(F);
+	mpz_clear(R);
+	mpz_clear(y);
+	mpz_clear(z);
+	mpz_clear(c1);
+	mpz_clear(c2);
+
+	return ret;
+}
+
+/**
+ * @brief Prove N = d<n>*k-1 with the factorization of N+1
+ *
+ * @param[in] pv Prover of d<n> (d<n> must divide N+1)
+ * @param[in] N  Candidate
+ *
+ * @return OASIS_PRIME, OASIS_COMPOSITE, or the result of
+ *         mpz_probab_prime_p(N, 25) when the proof is not possible
+ *
+ * @details Morrison: let D be one discriminant with (D/N) = -1.  If F | N+1
+ *          and for every prime q | F a Lucas sequence of discriminant D
+ *          (up to a square factor) has U_(N+1) = 0 and
+ *          gcd(U_((N+1)/q), N) = 1, every prime factor p of N is
+ *          (D/p) mod F, so +-1 mod F.  With (F-1)^2 > N, N is prime.
+ *          D must be common to all q: with a D_q per q the signs (D_q/p)
+ *          may differ, and p mod F is no longer +-1.
+ *          Q = 1 is used, so D*U^2 = V^2 - 4 and only V is computed.
+ *          A q that fails for P is retried with P' = sqrt(D*k^2 + 4) mod N,
+ *          whose discriminant P'^2 - 4 = D*k^2 (mod N) keeps the square class
+ *          of D (V_j(P) would not do: U_((N+1)/q) divides U_(j(N+1)/q)).
+ *          A base-2 Fermat test runs first, because the Lucas terms cost
+ *          about twice as much as a power.
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the retry of a q keeps the
+ *       discriminant D; before, a new P (a new D) could mark a composite
+ *       as proven.  Without such a P', the result is mpz_probab_prime_p().
+ */
+int oasis_prove_m1(const OASIS_PROVE *pv, mpz_t N)
+{
+	int       ret = OASIS_PRIME;
+	uint32_t  cnt, nretry = 0;
+	uint32_t *retry = NULL;
+	uint32_t  i;
+	long      P;
+	unsigned long k;
+	mpz_t     N1, F, R, y, z, e, Pz, x;
+
+	if (mpz_cmp_ui(N, PROVE_SMALL) < 0) return mpz_probab_prime_p(N, 25);
+
+	mpz_init(x);
+	mpz_init(N1);
+	mpz_init(F);
+	mpz_init(R);
+	mpz_init(y);
+	mpz_init(z);
+	mpz_init(e);
+	mpz_init(Pz);
+
+	/*--- Fermat screen ---*/
+	mpz_sub_ui(e, N, 1);
+	mpz_set_ui(z, 2);
+	mpz_powm(z, z, e, N);
+	if (mpz_cmp_ui(z, 1) != 0) {
+		ret = OASIS_COMPOSITE;
+		goto out;
+	}
+
+	mpz_add_ui(N1, N, 1);
+	cnt = factored_part(pv, N, 2, 1, F, R);
+	if ((cnt == 0) || !mpz_divisible_p(N1, F)
+	||  ((retry = malloc(cnt * sizeof(uint32_t))) == NULL)) {
+		ret = mpz_probab_prime_p(N, 25);
+		goto out;
+	}
+
+	/*--- Lucas parameter with (P^2-4 / N) = -1 ---*/
+	for (P = 3; P < pv->n + 3 + PROVE_BASES; P++) {
+		if (mpz_si_kronecker(P * P - 4, N) == -1) break;
+	}
+	if (P == pv->n + 3 + PROVE_BASES) {		// N may be a square
+		ret = mpz_probab_prime_p(N, 25);
+		goto out;
+	}
+
+	/*--- V_(N+1) = V_R(V_((N+1)/R)) = 2 ---*/
+	mpz_set_si(Pz, P);
+	mpz_divexact(e, N1, R);
+	lucas_v(y, Pz, e, N);				// y = V_((N+1)/R)
+	lucas_v(z, y, R, N);				// z = V_(N+1)
+	if (mpz_cmp_ui(z, 2) != 0) {
+		ret = OASIS_COMPOSITE;
+		goto out;
+	}
+
+	/*--- Morrison condition for every q | F ---*/
+	if (prove_tree(y, pv->prm + 1, cnt - 1, N, 1, retry, &nretry) != 0) {
+		ret = OASIS_COMPOSITE;
+		goto out;
+	}
+	if (nretry > 0 && mpz_fdiv_ui(N, 4) != 3) {	// sqrt() below needs N = 3 mod 4
+		ret = mpz_probab_prime_p(N, 25);
+		goto out;
+	}
+	for (i = 0; i < nretry && ret == OASIS_PRIME; i++) {
+		for (k = 2; k < 2 + PROVE_BASES; k++) {	// P' = sqrt(D*k^2 + 4): same D
+			mpz_set_si(x, P * P - 4);
+			mpz_mul_ui(x, x, k * k);
+			mpz_add_ui(x, x, 4);
+			mpz_mod(x, x, N);
+			mpz_divexact_ui(e, N1, 4);
+			mpz_powm(Pz, x, e, N);		// a root if x is a square mod N
+			mpz_mul(z, Pz, Pz);
+			mpz_mod(z, z, N);
+			if (mpz_cmp(z, x) != 0) continue;
+
+			mpz_divexact_ui(e, N1, retry[i]);
+			lucas_v(y, Pz, e, N);		// y = V_((N+1)/q)
+			mpz_mul(z, y, y);
+			mpz_sub_ui(z, z, 4);
+			mpz_mod(z, z, N);
+			if (mpz_sgn(z) == 0) continue;
+			mpz_gcd(z, z, N);
+			if (mpz_cmp_ui(z, 1) != 0) {
+				ret = OASIS_COMPOSITE;
+				break;
+			}
+			mpz_set_ui(e, retry[i]);
+			lucas_v(z, y, e, N);		// z = V_(N+1)
+			if (mpz_cmp_ui(z, 2) != 0) ret = OASIS_COMPOSITE;
+			break;
+		}
+		if (k == 2 + PROVE_BASES) {		// no P' found: not proven
+			ret = mpz_probab_prime_p(N, 25);
+		}
+	}
+
+out:
+	free(retry);
+	mpz_clear(N1);
+	mpz_clear(F);
+	mpz_clear(R);
+	mpz_clear(y);
+	mpz_clear(z);
+	mpz_clear(e);
+	mpz_clear(Pz);
+	mpz_clear(x);
+
+	return ret;
+}
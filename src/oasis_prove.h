@@ -0,0 +1,38 @@
+/**
+ * @file oasis_prove.h
+ * @brief Primality proof of d<n>*k+-1 from the factorization of d<n>.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * d<n> = LCM(1,2,3,...n) is the product of p^floor(log_p n) over the primes
+ * p <= n, so the oasis candidates are numbers with a known factored part:
+ *   - d<n>*k+1: N-1 is a multiple of d<n> (Pocklington / Brillhart-Lehmer-Selfridge)
+ *   - d<n>*k-1: N+1 is a multiple of d<n> (Morrison, Lucas sequences)
+ *
+ * @note v1.10.0 (2026-10-16): Add N-1 / N+1 primality proof
+ */
+
+#ifndef _OASIS_PROVE_H
+#define _OASIS_PROVE_H
+
+#include <stdint.h>
+#include <gmp.h>
+
+/* Results, same values as mpz_probab_prime_p() */
+#define OASIS_COMPOSITE	(0)
+#define OASIS_PROBABLE	(1)	// probable prime, the proof was not possible
+#define OASIS_PRIME	(2)	// proven prime
+
+typedef struct {
+	int		 n;		// d<n> = LCM(1,2,3,...n)
+	uint32_t	 nfac;		// number of prime factors of d<n>
+	uint32_t	*prm;		// prime factors p, in order of use
+	uint32_t	*pwr;		// p^e, the largest power of p <= n
+} OASIS_PROVE;
+
+int  oasis_prove_init(OASIS_PROVE *pv, int n);
+int  oasis_prove_p1(const OASIS_PROVE *pv, mpz_t N);
+int  oasis_prove_m1(const OASIS_PROVE *pv, mpz_t N);
+void oasis_prove_clear(OASIS_PROVE *pv);
+
+#endif  // _OASIS_PROVE_H
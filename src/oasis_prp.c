@@ -0,0 +1,297 @@
+/**
+ * @file oasis_prp.c
+ * @brief Batched base-2 Fermat screen of the oasis candidates.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * IFMA kernel: limb k of the 8 candidates is one __m512i, 52 bits per
+ * limb, L = ceil((bits + 4) / 52) limbs, R = 2^(52L) >= 16N.
+ * The Montgomery squaring keeps 64-bit accumulators and propagates the
+ * carries once at the end, and with R >= 16N no conditional subtraction
+ * is needed: a square of x < 4N is < 2N, and its double is < 4N again.
+ * The doubling of the lanes whose exponent bit is 1 is a masked shift.
+ * Lanes are only reduced modulo N at the end, with mpz.
+ *
+ * @note v1.12.0 (2026-10-16): Add batched PRP screen (AVX-512 IFMA)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_prp.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PRP_HAVE_IFMA
+#include <immintrin.h>
+#endif
+
+#define R52_BITS	(52)
+#define R52_MASK	((UINT64_C(1) << R52_BITS) - 1)
+
+/**
+ * @brief Initialize the scratch
+ *
+ * @param[out] pp     Scratch
+ * @param[in]  kernel OASIS_PRP_AUTO, OASIS_PRP_SCALAR or OASIS_PRP_IFMA
+ *
+ * @note OASIS_PRP_IFMA falls back to OASIS_PRP_SCALAR on a CPU without it.
+ */
+void oasis_prp_init(OASIS_PRP *pp, int kernel)
+{
+	int j;
+
+	memset(pp, 0, sizeof(*pp));
+	oasis_fermat_init(pp->fm);
+	for (j = 0; j < OASIS_PRP_LANES; j++) {
+		mpz_init(pp->one[j]);
+	}
+	mpz_init(pp->t);
+
+	pp->kernel = OASIS_PRP_SCALAR;
+#ifdef PRP_HAVE_IFMA
+	if ((kernel != OASIS_PRP_SCALAR)
+	&&  __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma")) {
+		pp->kernel = OASIS_PRP_IFMA;
+	}
+#else
+	(void)kernel;
+#endif
+}
+
+/**
+ * @brief Release the scratch
+ *
+ * @param[in,out] pp Scratch
+ */
+void oasis_prp_clear(OASIS_PRP *pp)
+{
+	int j;
+
+	for (j = 0; j < OASIS_PRP_LANES; j++) {
+		mpz_clear(pp->one[j]);
+	}
+	mpz_clear(pp->t);
+}
+
+/**
+ * @brief Name of the kernel in use
+ */
+const char *oasis_prp_name(const OASIS_PRP *pp)
+{
+	return (pp->kernel == OASIS_PRP_IFMA)? "avx512ifma": "scalar";
+}
+
+#ifdef PRP_HAVE_IFMA
+
+/**
+ * @brief Bits [52k, 52k+52) of x
+ */
+static uint64_t get_r52(mpz_t x, int k)
+{
+	size_t   off = (size_t)k * R52_BITS;
+	size_t   w   = off / GMP_NUMB_BITS;
+	unsigned s   = off % GMP_NUMB_BITS;
+	uint64_t v;
+
+	v = mpz_getlimbn(x, w) >> s;
+	if (s + R52_BITS > GMP_NUMB_BITS) {
+		v |= mpz_getlimbn(x, w + 1) << (GMP_NUMB_BITS - s);
+	}
+
+	return v & R52_MASK;
+}
+
+/**
+ * @brief x = x^2 / R mod N for 8 candidates
+ *
+ * @param[in,out] x  Operands (< 4N), results (< 2N), L limbs of 52 bits
+ * @param[in]     n  N
+ * @param[in]     k0 -N^-1 mod 2^52
+ * @param[out]    t  Scratch of 2L+1 vectors
+ * @param[in]     L  Number of limbs
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static void mont_sqr_ifma(__m512i *x, const __m512i *n, __m512i k0, __m512i *t, int L)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i mask = _mm512_set1_epi64(R52_MASK);
+	__m512i ai, m;
+	int     i, j;
+
+	for (i = 0; i <= 2 * L; i++) {
+		t[i] = zero;
+	}
+	for (i = 0; i < L; i++) {
+		ai = x[i];
+		for (j = 0; j < L; j++) {			// t += x[i] * x << 52i
+			t[i + j]     = _mm512_madd52lo_epu64(t[i + j],     ai, x[j]);
+			t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], ai, x[j]);
+		}
+		m = _mm512_madd52lo_epu64(zero, t[i], k0);	// t[i] + m*n[0] = 0 (mod 2^52)
+		for (j = 0; j < L; j++) {			// t += m * n << 52i
+			t[i + j]     = _mm512_madd52lo_epu64(t[i + j],     m, n[j]);
+			t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], m, n[j]);
+		}
+		t[i + 1] = _mm512_add_epi64(t[i + 1], _mm512_srli_epi64(t[i], R52_BITS));
+	}
+	for (i = L; i < 2 * L; i++) {				// normalize t / 2^(52L)
+		x[i - L] = _mm512_and_si512(t[i], mask);
+		t[i + 1] = _mm512_add_epi64(t[i + 1], _mm512_srli_epi64(t[i], R52_BITS));
+	}
+}
+
+/**
+ * @brief x = 2x for the lanes of dbl
+ *
+ * @param[in,out] x   Operands (< 2N), results (< 4N)
+ * @param[in]     dbl Lanes to double
+ * @param[in]     L   Number of limbs
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static void mont_dbl_ifma(__m512i *x, __mmask8 dbl, int L)
+{
+	const __m512i mask = _mm512_set1_epi64(R52_MASK);
+	__m512i cy = _mm512_setzero_si512();
+	__m512i y;
+	int     k;
+
+	for (k = 0; k < L; k++) {
+		y    = _mm512_add_epi64(_mm512_slli_epi64(x[k], 1), cy);
+		cy   = _mm512_srli_epi64(y, R52_BITS);
+		x[k] = _mm512_mask_and_epi64(x[k], dbl, y, mask);
+	}
+}
+
+/**
+ * @brief Screen 8 candidates with the IFMA kernel
+ *
+ * @param[in,out] pp   Scratch
+ * @param[in]     cand 8 candidates, odd, > 3
+ * @param[out]    res  1: 2^(N-1) = 1 (mod N), 0: composite
+ * @param[in]     L    Number of limbs, 16N <= 2^(52L)
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static void screen_ifma(OASIS_PRP *pp, mpz_ptr cand[OASIS_PRP_LANES], int res[OASIS_PRP_LANES], int L)
+{
+	__m512i        n[OASIS_PRP_MAX_LIMBS];
+	__m512i        x[OASIS_PRP_MAX_LIMBS];
+	__m512i        t[2 * OASIS_PRP_MAX_LIMBS + 1];
+	__m512i        k0;
+	uint64_t       ninv[OASIS_PRP_LANES];
+	const mp_limb_t *lp[OASIS_PRP_LANES];
+	long           nb = 0, bits, b;
+	__mmask8       dbl;
+	int            j, k;
+
+	for (j = 0; j < OASIS_PRP_LANES; j++) {
+		mpz_ptr N = cand[j];
+		uint64_t inv = mpz_getlimbn(N, 0);	// 3 bits: n0 * n0 = 1 (mod 8)
+
+		for (k = 0; k < 5; k++) {			// Newton: 96 bits
+			inv *= 2 - mpz_getlimbn(N, 0) * inv;
+		}
+		ninv[j] = (-inv) & R52_MASK;
+
+		mpz_set_ui(pp->one[j], 1);			// one = R mod N
+		mpz_mul_2exp(pp->one[j], pp->one[j], (mp_bitcnt_t)L * R52_BITS);
+		mpz_mod(pp->one[j], pp->one[j], N);
+
+		for (k = 0; k < L; k++) {
+			((uint64_t *)&n[k])[j] = get_r52(N, k);
+			((uint64_t *)&x[k])[j] = get_r52(pp->one[j], k);
+		}
+		lp[j] = mpz_limbs_read(N);
+		bits  = (long)mpz_sizeinbase(N, 2);
+		if (bits > nb) nb = bits;
+	}
+	k0 = _mm512_loadu_si512(ninv);
+
+	/*--- left to right over the bits of N-1 (= N except bit 0) ---*/
+	for (b = nb - 1; b >= 1; b--) {
+		mont_sqr_ifma(x, n, k0, t, L);
+		dbl = 0;
+		for (j = 0; j < OASIS_PRP_LANES; j++) {
+			if ((size_t)(b / GMP_NUMB_BITS) < mpz_size(cand[j])
+			&&  (lp[j][b / GMP_NUMB_BITS] >> (b % GMP_NUMB_BITS) & 1)) {
+				dbl |= (__mmask8)(1 << j);
+			}
+		}
+		if (dbl) mont_dbl_ifma(x, dbl, L);
+	}
+	mont_sqr_ifma(x, n, k0, t, L);			// bit 0 of N-1
+
+	/*--- 2^(N-1)*R = R (mod N)? ---*/
+	for (j = 0; j < OASIS_PRP_LANES; j++) {
+		mpz_set_ui(pp->t, 0);
+		for (k = L - 1; k >= 0; k--) {
+			mpz_mul_2exp(pp->t, pp->t, R52_BITS);
+			mpz_add_ui(pp->t, pp->t, ((uint64_t *)&x[k])[j]);
+		}
+		mpz_mod(pp->t, pp->t, cand[j]);
+		res[j] = (mpz_cmp(pp->t, pp->one[j]) == 0);
+	}
+}
+
+#endif  // PRP_HAVE_IFMA
+
+/**
+ * @brief Base-2 Fermat screen of a batch of candidates
+ *
+ * @param[in,out] pp   Scratch of the calling thread
+ * @param[in]     cand Candidates
+ * @param[in]     n    Number of candidates
+ * @param[out]    res  1 if cand[i] is a base-2 Fermat probable prime, 0 if composite
+ *
+ * @details Candidates are taken OASIS_PRP_LANES at a time; a short group
+ *          is padded with its first candidate.  Candidates the IFMA kernel
+ *          does not take (even, <= 3, too large) go to oasis_fermat().
+ */
+void oasis_prp_screen(OASIS_PRP *pp, mpz_t cand[], int n, int res[])
+{
+	int i = 0;
+
+#ifdef PRP_HAVE_IFMA
+	mpz_ptr grp[OASIS_PRP_LANES];
+	int     gres[OASIS_PRP_LANES];
+	int     idx[OASIS_PRP_LANES];
+	int     cnt, j, L;
+	long    bits, nb;
+
+	while (pp->kernel == OASIS_PRP_IFMA && i < n) {
+		for (cnt = 0, nb = 0; i < n && cnt < OASIS_PRP_LANES; i++) {
+			bits = (long)mpz_sizeinbase(cand[i], 2);
+			if (mpz_even_p(cand[i]) || mpz_cmp_ui(cand[i], 3) <= 0
+			||  (bits + 4 + R52_BITS - 1) / R52_BITS > OASIS_PRP_MAX_LIMBS) {
+				res[i] = oasis_fermat(pp->fm, cand[i]);
+				pp->cnt++;
+				pp->pass += res[i];
+				continue;
+			}
+			if (bits > nb) nb = bits;
+			idx[cnt]   = i;
+			grp[cnt++] = cand[i];
+		}
+		if (cnt == 0) break;
+		for (j = cnt; j < OASIS_PRP_LANES; j++) {	// pad
+			grp[j] = grp[0];
+		}
+
+		L = (int)((nb + 4 + R52_BITS - 1) / R52_BITS);
+		screen_ifma(pp, grp, gres, L);
+		for (j = 0; j < cnt; j++) {
+			res[idx[j]] = gres[j];
+			pp->cnt++;
+			pp->pass += gres[j];
+		}
+	}
+#endif
+
+	for (; i < n; i++) {
+		res[i] = oasis_fermat(pp->fm, cand[i]);
+		pp->cnt++;
+		pp->pass += res[i];
+	}
+}
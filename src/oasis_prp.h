@@ -0,0 +1,49 @@
+/**
+ * @file oasis_prp.h
+ * @brief Batched base-2 Fermat screen of the oasis candidates.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The candidates of a scan come in long runs of the same size, so they are
+ * screened OASIS_PRP_LANES at a time: one candidate per 64-bit lane of an
+ * AVX-512 register, 52-bit limbs multiplied with IFMA (vpmadd52luq/huq).
+ * Without AVX-512 IFMA each candidate is screened by oasis_fermat().
+ * The results are exactly those of oasis_fermat().
+ *
+ * @note v1.32.1 (2026-10-16): No AVX2 kernel.  AVX2 multiplies 32x32 bits
+ *       (vpmuludq), 4 lanes at a time, which is 1/4 of the limb product of
+ *       one mulx, so the scalar mpn kernel is the fallback without IFMA.
+ * @note v1.12.0 (2026-10-16): Add batched PRP screen (AVX-512 IFMA)
+ */
+
+#ifndef _OASIS_PRP_H
+#define _OASIS_PRP_H
+
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_fermat.h"
+
+#define OASIS_PRP_LANES		(8)		// candidates per vector
+#define OASIS_PRP_MAX_LIMBS	(80)		// 52-bit limbs: 4160 bits
+
+#define OASIS_PRP_AUTO		(0)		// choose from the CPU features
+#define OASIS_PRP_SCALAR	(1)		// oasis_fermat() per candidate
+#define OASIS_PRP_IFMA		(2)		// AVX-512 IFMA, 8 candidates
+
+/* Scratch of a thread */
+typedef struct {
+	int		kernel;				// OASIS_PRP_SCALAR/IFMA
+	OASIS_FERMAT	fm[1];				// scalar kernel
+	mpz_t		one[OASIS_PRP_LANES];		// R mod N of the lanes
+	mpz_t		t;
+	uint64_t	cnt;				// number of candidates
+	uint64_t	pass;				// number of probable primes
+} OASIS_PRP;
+
+void        oasis_prp_init(OASIS_PRP *pp, int kernel);
+void        oasis_prp_clear(OASIS_PRP *pp);
+void        oasis_prp_screen(OASIS_PRP *pp, mpz_t cand[], int n, int res[]);
+const char *oasis_prp_name(const OASIS_PRP *pp);
+
+#endif  // _OASIS_PRP_H
@@ -0,0 +1,123 @@
+/**
+ * @file oasis_queue.c
+ * @brief Bounded lock-free MPMC queue of the pipelined scan.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * See oasis_queue.h.
+ *
+ * @note v1.29.0 (2026-10-16): Add lock-free queue (oasis_queue)
+ */
+
+#include <stdlib.h>
+
+#include "oasis_queue.h"
+
+/**
+ * @brief Initialize a queue
+ *
+ * @param[out] q   Queue
+ * @param[in]  cap Capacity, rounded up to a power of two (>= 2)
+ *
+ * @return 0 on success, -1 on memory allocation failure
+ */
+int oasis_queue_init(OASIS_QUEUE *q, size_t cap)
+{
+	size_t n = 2;
+	size_t i;
+
+	while (n < cap) n <<= 1;
+	q->cell = malloc(n * sizeof(OASIS_QCELL));
+	if (q->cell == NULL) return -1;
+	for (i = 0; i < n; i++) {
+		atomic_init(&q->cell[i].seq, i);
+		q->cell[i].data = NULL;
+	}
+	q->mask = n - 1;
+	atomic_init(&q->head, 0);
+	atomic_init(&q->tail, 0);
+
+	return 0;
+}
+
+/**
+ * @brief Release a queue
+ */
+void oasis_queue_clear(OASIS_QUEUE *q)
+{
+	free(q->cell);
+	q->cell = NULL;
+}
+
+/**
+ * @brief Push an element
+ *
+ * @return 0 on success, -1 if the queue is full
+ */
+int oasis_queue_push(OASIS_QUEUE *q, void *data)
+{
+	OASIS_QCELL *c;
+	uint64_t     pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+	int64_t      d;
+
+	for (;;) {
+		c = &q->cell[pos & q->mask];
+		d = (int64_t)(atomic_load_explicit(&c->seq, memory_order_acquire) - pos);
+		if (d == 0) {				// free: claim it
+			if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed)) break;
+		}
+		else if (d < 0) {			// a lap behind: full
+			return -1;
+		}
+		else {					// taken by another producer
+			pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+		}
+	}
+	c->data = data;
+	atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Pop an element
+ *
+ * @return 0 on success, -1 if the queue is empty
+ */
+int oasis_queue_pop(OASIS_QUEUE *q, void **data)
+{
+	OASIS_QCELL *c;
+	uint64_t     pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	int64_t      d;
+
+	for (;;) {
+		c = &q->cell[pos & q->mask];
+		d = (int64_t)(atomic_load_explicit(&c->seq, memory_order_acquire) - (pos + 1));
+		if (d == 0) {				// published: claim it
+			if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed)) break;
+		}
+		else if (d < 0) {			// not published yet: empty
+			return -1;
+		}
+		else {					// taken by another consumer
+			pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+		}
+	}
+	*data = c->data;
+	atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Number of elements in the queue (a snapshot, for the metrics)
+ */
+size_t oasis_queue_depth(OASIS_QUEUE *q)
+{
+	uint64_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+	uint64_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+	return (h > t)? (size_t)(h - t): 0;
+}
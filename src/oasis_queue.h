@@ -0,0 +1,41 @@
+/**
+ * @file oasis_queue.h
+ * @brief Bounded lock-free MPMC queue of the pipelined scan.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * A ring of cells, each with a sequence number (D. Vyukov's bounded MPMC
+ * queue): a producer claims a position with a CAS on head and publishes
+ * the cell with a release store of its sequence, a consumer does the same
+ * on tail.  Neither side takes a lock or makes a system call; a full or an
+ * empty queue is returned to the caller, who decides how to wait.
+ *
+ * @note v1.29.0 (2026-10-16): Add lock-free queue (oasis_queue)
+ */
+
+#ifndef _OASIS_QUEUE_H
+#define _OASIS_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+typedef struct {
+	_Atomic uint64_t seq;			// position the cell is ready for
+	void		*data;
+} OASIS_QCELL;
+
+typedef struct {
+	OASIS_QCELL	*cell;
+	uint64_t	 mask;			// capacity - 1 (power of two)
+	_Alignas(64) _Atomic uint64_t head;	// next position to push
+	_Alignas(64) _Atomic uint64_t tail;	// next position to pop
+} OASIS_QUEUE;
+
+int    oasis_queue_init(OASIS_QUEUE *q, size_t cap);
+void   oasis_queue_clear(OASIS_QUEUE *q);
+int    oasis_queue_push(OASIS_QUEUE *q, void *data);
+int    oasis_queue_pop(OASIS_QUEUE *q, void **data);
+size_t oasis_queue_depth(OASIS_QUEUE *q);
+
+#endif  // _OASIS_QUEUE_H
@@ -0,0 +1,149 @@
+/**
+ * @file oasis_rec.c
+ * @brief Binary result stream of prime_oases (--format=bin).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * @note v1.25.0 (2026-10-16): Add oasis_rec_set_ui() (k = no + k without mpz)
+ *
+ * @note v1.14.0 (2026-10-16): Add binary result stream
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_rec.h"
+
+/**
+ * @brief Initialize the header of a stream
+ *
+ * @param[out] hdr    Header
+ * @param[in]  desert n of d<n>
+ * @param[in]  no     x<no>
+ * @param[in]  num    <num>
+ * @param[in]  flags  OASIS_REC_HDR_*
+ */
+void oasis_rec_hdr_init(OASIS_REC_HDR *hdr, int desert, uint64_t no, uint64_t num, uint32_t flags)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, OASIS_REC_MAGIC, sizeof(hdr->magic));
+	hdr->version  = OASIS_REC_VERSION;
+	hdr->rec_size = sizeof(OASIS_REC);
+	hdr->desert   = (uint32_t)desert;
+	hdr->flags    = flags;
+	hdr->no       = no;
+	hdr->num      = num;
+}
+
+/**
+ * @brief Check the header of a stream
+ *
+ * @param[in] hdr Header read from the stream
+ *
+ * @return 0 if the stream can be read, -1 otherwise
+ */
+int oasis_rec_hdr_check(const OASIS_REC_HDR *hdr)
+{
+	if (memcmp(hdr->magic, OASIS_REC_MAGIC, sizeof(hdr->magic)) != 0) return -1;
+	if (hdr->version != OASIS_REC_VERSION) return -1;
+	if (hdr->rec_size != sizeof(OASIS_REC)) return -1;
+	if (hdr->desert < 2) return -1;
+
+	return 0;
+}
+
+/**
+ * @brief Make the record of a hit
+ *
+ * @param[out] rec   Record
+ * @param[in]  k     k of d<n>*k+-1
+ * @param[in]  sign  '-' or '+'
+ * @param[in]  flags OASIS_REC_*
+ *
+ * @return 0 on success, -1 if k does not fit in 96 bits
+ */
+int oasis_rec_set(OASIS_REC *rec, mpz_t k, int sign, int flags)
+{
+	memset(rec, 0, sizeof(*rec));
+	if (mpz_sgn(k) < 0 || mpz_sizeinbase(k, 2) > 96) return -1;
+
+	rec->k     = (uint64_t)mpz_getlimbn(k, 0);
+	rec->k_hi  = (uint32_t)mpz_getlimbn(k, 1);
+	rec->sign  = (uint8_t)sign;
+	rec->flags = (uint8_t)flags;
+
+	return 0;
+}
+
+/**
+ * @brief Make the record of a hit of desert k after x<no>
+ *
+ * @param[out] rec   Record
+ * @param[in]  no    x<no>
+ * @param[in]  k     Desert relative to x<no>
+ * @param[in]  sign  '-' or '+'
+ * @param[in]  flags OASIS_REC_*
+ *
+ * @details no + k has 65 bits at most, so it always fits in the record.
+ *
+ * @note Added in v1.25.0 (2026-10-16)
+ */
+void oasis_rec_set_ui(OASIS_REC *rec, uint64_t no, uint64_t k, int sign, int flags)
+{
+	unsigned __int128 r = (unsigned __int128)no + k;
+
+	memset(rec, 0, sizeof(*rec));
+	rec->k     = (uint64_t)r;
+	rec->k_hi  = (uint32_t)(r >> 64);
+	rec->sign  = (uint8_t)sign;
+	rec->flags = (uint8_t)flags;
+}
+
+/**
+ * @brief k of a record
+ *
+ * @param[in]  rec Record
+ * @param[out] k   k of d<n>*k+-1
+ */
+void oasis_rec_get(const OASIS_REC *rec, mpz_t k)
+{
+	mpz_set_ui(k, rec->k_hi);
+	mpz_mul_2exp(k, k, 64);
+	mpz_add_ui(k, k, rec->k);
+}
+
+/**
+ * @brief Print a record as the text line of prime_oases
+ *
+ * @param[out] fp     Output stream
+ * @param[in]  hdr    Header of the stream
+ * @param[in]  desert d<n> = LCM(1,2,3,...,n)
+ * @param[in]  rec    Record
+ * @param[out] t      Scratch
+ *
+ * @return Number of characters printed, -1 on an invalid record
+ *
+ * @details "d<n>*<k><sign>1 = <d<n>*k+-1>", followed by " (probable)"
+ *          for a hit of --prove that was not proven.
+ */
+int oasis_rec_print(FILE *fp, const OASIS_REC_HDR *hdr, mpz_t desert, const OASIS_REC *rec, mpz_t t)
+{
+	mpz_t k;
+	int   len;
+
+	if (rec->sign != '-' && rec->sign != '+') return -1;
+
+	mpz_init(k);
+	oasis_rec_get(rec, k);
+	mpz_mul(t, desert, k);				// t = d<n> * k +- 1
+	if (rec->sign == '-') mpz_sub_ui(t, t, 1);
+	else                  mpz_add_ui(t, t, 1);
+	len = gmp_fprintf(fp, "d%u*%Zd%c1 = %Zd%s\n", hdr->desert, k, rec->sign, t,
+			  (rec->flags & OASIS_REC_PROBABLE)? " (probable)": "");
+	mpz_clear(k);
+
+	return len;
+}
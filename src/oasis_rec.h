@@ -0,0 +1,65 @@
+/**
+ * @file oasis_rec.h
+ * @brief Binary result stream of prime_oases (--format=bin).
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * A hit d<n>*k+-1 is fully determined by (n, k, sign), so the binary
+ * stream stores a 16-byte record per hit instead of the decimal digits:
+ *
+ *   header  OASIS_REC_HDR (40 bytes): magic, version, record size,
+ *           n of d<n>, x<no>, <num>, flags of the scan
+ *   records OASIS_REC (16 bytes) in the order of the text output
+ *
+ * Integers are in host byte order (little-endian on x86-64).
+ * oasis_decode expands the records into the text lines of prime_oases.
+ *
+ * @note v1.25.0 (2026-10-16): Add oasis_rec_set_ui() (k = no + k without mpz)
+ *
+ * @note v1.14.0 (2026-10-16): Add binary result stream
+ */
+
+#ifndef _OASIS_REC_H
+#define _OASIS_REC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#define OASIS_REC_MAGIC		"OASISRES"
+#define OASIS_REC_VERSION	(1)
+
+/* OASIS_REC_HDR.flags */
+#define OASIS_REC_HDR_PROVE	(0x01)		// --prove
+
+/* OASIS_REC.flags */
+#define OASIS_REC_TWIN		(0x01)		// d<n>*k+1 of a twin (d<n>*k-1 is a hit too)
+#define OASIS_REC_PROVEN	(0x02)		// proven prime (--prove)
+#define OASIS_REC_PROBABLE	(0x04)		// not proven (--prove), "(probable)"
+
+typedef struct {
+	char		magic[8];		// OASIS_REC_MAGIC (not terminated)
+	uint32_t	version;		// OASIS_REC_VERSION
+	uint32_t	rec_size;		// sizeof(OASIS_REC)
+	uint32_t	desert;			// n of d<n>
+	uint32_t	flags;			// OASIS_REC_HDR_*
+	uint64_t	no;			// x<no>
+	uint64_t	num;			// <num>
+} OASIS_REC_HDR;
+
+typedef struct {
+	uint64_t	k;			// bits 0..63 of k (d<n>*k+-1)
+	uint32_t	k_hi;			// bits 64..95 of k
+	uint8_t		sign;			// '-' or '+'
+	uint8_t		flags;			// OASIS_REC_*
+	uint16_t	reserved;
+} OASIS_REC;
+
+void oasis_rec_hdr_init(OASIS_REC_HDR *hdr, int desert, uint64_t no, uint64_t num, uint32_t flags);
+int  oasis_rec_hdr_check(const OASIS_REC_HDR *hdr);
+int  oasis_rec_set(OASIS_REC *rec, mpz_t k, int sign, int flags);
+void oasis_rec_set_ui(OASIS_REC *rec, uint64_t no, uint64_t k, int sign, int flags);
+void oasis_rec_get(const OASIS_REC *rec, mpz_t k);
+int  oasis_rec_print(FILE *fp, const OASIS_REC_HDR *hdr, mpz_t desert, const OASIS_REC *rec, mpz_t t);
+
+#endif  // _OASIS_REC_H
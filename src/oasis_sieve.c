@@ -0,0 +1,312 @@
+/**
+ * @file oasis_sieve.c
+ * @brief Segmented small-prime sieve over the desert index k.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * The candidates pit(k)+-1 of a desert scan are struck out by every sieve
+ * prime q that divides them.  The sieve works on a segment of
+ * OASIS_SIEVE_SEG_BITS consecutive k at a time, one bit array per sign,
+ * so the marking stays in L1 regardless of the length of the scan.
+ *
+ * @note v1.21.0 (2026-10-16): Add XPT_PRF trace point of a segment
+ *
+ * @note v1.8.1 (2026-10-16): Share the sieve primes between threads
+ *
+ * @note v1.8.0 (2026-10-16): Add segmented sieve for prime_oasis/prime_oases
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#include "oasis_sieve.h"
+
+#define XPT_ON
+#include "xpt.h"
+
+/**
+ * @brief Inverse of a modulo q
+ *
+ * @param[in] a Value to invert (0 < a < q, gcd(a, q) = 1)
+ * @param[in] q Prime modulus
+ *
+ * @return a^-1 mod q
+ */
+static uint32_t inv_mod(uint32_t a, uint32_t q)
+{
+	int64_t t0 = 0, t1 = 1;
+	int64_t r0 = q, r1 = a;
+	int64_t qt, tmp;
+
+	while (r1 != 0) {
+		qt  = r0 / r1;
+		tmp = r0 - qt * r1; r0 = r1; r1 = tmp;
+		tmp = t0 - qt * t1; t0 = t1; t1 = tmp;
+	}
+	if (t0 < 0) t0 += q;
+
+	return (uint32_t)t0;
+}
+
+/**
+ * @brief Execute Sieve of Eratosthenes for the sieve primes
+ *
+ * @param[in]  limit Upper bound of the primes (inclusive)
+ * @param[out] cnt   Number of primes in the table
+ *
+ * @return Table of primes 2..limit (free() by caller), or NULL on failure
+ *
+ * @note The sieve holds odd numbers only, one bit each.
+ */
+uint32_t *oasis_prime_table(uint32_t limit, uint32_t *cnt)
+{
+	uint64_t  half = ((uint64_t)limit + 1) / 2;	// odd numbers 1,3,5,...
+	uint64_t *comp;
+	uint32_t *prm;
+	uint32_t  n = 0;
+	uint64_t  i, j;
+
+	*cnt = 0;
+	comp = calloc(half / 64 + 1, sizeof(uint64_t));
+	if (comp == NULL) return NULL;
+
+	for (i = 1; (2 * i + 1) * (2 * i + 1) <= limit; i++) {
+		if (comp[i >> 6] >> (i & 63) & 1) continue;
+		for (j = (2 * i + 1) * (2 * i + 1) / 2; j < half; j += 2 * i + 1) {
+			comp[j >> 6] |= (uint64_t)1 << (j & 63);
+		}
+	}
+
+	for (i = 1; i < half; i++) {			// count
+		if (!(comp[i >> 6] >> (i & 63) & 1)) n++;
+	}
+	if (limit >= 2) n++;				// 2
+
+	prm = malloc(((size_t)n + 1) * sizeof(uint32_t));
+	if (prm != NULL) {
+		n = 0;
+		if (limit >= 2) prm[n++] = 2;
+		for (i = 1; i < half; i++) {
+			if (!(comp[i >> 6] >> (i & 63) & 1)) {
+				prm[n++] = (uint32_t)(2 * i + 1);
+			}
+		}
+		*cnt = n;
+	}
+	free(comp);
+
+	return prm;
+}
+
+/**
+ * @brief Choose the sieve depth for a scan
+ *
+ * @param[in] pit0 Center of the first desert of the scan
+ * @param[in] num  Number of deserts to scan
+ *
+ * @return Largest sieve prime to use (0: do not sieve)
+ *
+ * @details The depth grows with the length of the scan, because the setup
+ *          cost of a sieve prime is paid once and its benefit is
+ *          proportional to the number of candidates it can strike out.
+ *          It is kept below pit0 - 1 so that no candidate can be equal to
+ *          a sieve prime.
+ */
+uint32_t oasis_sieve_limit(mpz_t pit0, uint64_t num)
+{
+	uint64_t limit;
+
+	if (num > OASIS_SIEVE_MAX_LIMIT / OASIS_SIEVE_DEPTH) {
+		limit = OASIS_SIEVE_MAX_LIMIT;
+	}
+	else {
+		limit = num * OASIS_SIEVE_DEPTH;
+	}
+	if (limit < OASIS_SIEVE_MIN_LIMIT) limit = OASIS_SIEVE_MIN_LIMIT;
+
+	if (mpz_cmp_ui(pit0, limit + 1) <= 0) {		// tiny desert?
+		limit = (mpz_cmp_ui(pit0, 2) > 0)? mpz_get_ui(pit0) - 2: 0;
+	}
+
+	return (uint32_t)limit;
+}
+
+/**
+ * @brief Initialize the sieve for pit(k) = pit0 + k*step
+ *
+ * @param[out] sv    Sieve state
+ * @param[in]  pit0  Center of the first desert (k = 0)
+ * @param[in]  step  Distance between deserts
+ * @param[in]  limit Largest sieve prime (see oasis_sieve_limit())
+ *
+ * @return 0 on success, -1 on memory allocation failure
+ *
+ * @note The sieve is positioned at k = 0.
+ */
+int oasis_sieve_init(OASIS_SIEVE *sv, mpz_t pit0, mpz_t step, uint32_t limit)
+{
+	uint32_t *tbl;
+	uint32_t  cnt;
+	uint32_t  q, s, a, inv;
+	uint32_t  j;
+
+	memset(sv, 0, sizeof(*sv));
+
+	tbl = oasis_prime_table(limit, &cnt);
+	if (tbl == NULL) return -1;
+
+	sv->root[OASIS_SIEVE_M1] = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	sv->root[OASIS_SIEVE_P1] = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	sv->next[OASIS_SIEVE_M1] = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	sv->next[OASIS_SIEVE_P1] = malloc(((size_t)cnt + 1) * sizeof(uint32_t));
+	sv->bits[OASIS_SIEVE_M1] = malloc(OASIS_SIEVE_SEG_BITS / 8);
+	sv->bits[OASIS_SIEVE_P1] = malloc(OASIS_SIEVE_SEG_BITS / 8);
+	sv->prm = tbl;
+	if ((sv->root[OASIS_SIEVE_M1] == NULL) || (sv->root[OASIS_SIEVE_P1] == NULL)
+	||  (sv->next[OASIS_SIEVE_M1] == NULL) || (sv->next[OASIS_SIEVE_P1] == NULL)
+	||  (sv->bits[OASIS_SIEVE_M1] == NULL) || (sv->bits[OASIS_SIEVE_P1] == NULL)) {
+		oasis_sieve_clear(sv);
+		return -1;
+	}
+
+	/*--- composite classes: pit0 +- 1 + k*step = 0 (mod q) ---*/
+	for (j = 0; j < cnt; j++) {
+		q = tbl[j];
+		s = (uint32_t)mpz_fdiv_ui(step, q);		// s = step % q
+		if (s == 0) continue;				// q | d<n>: never divides
+		a = (uint32_t)mpz_fdiv_ui(pit0, q);		// a = pit0 % q
+		inv = inv_mod(s, q);
+		tbl[sv->nprm] = q;				// compact in place
+		sv->root[OASIS_SIEVE_M1][sv->nprm] =
+			(uint32_t)((uint64_t)((1 + (uint64_t)q - a) % q) * inv % q);
+		sv->root[OASIS_SIEVE_P1][sv->nprm] =
+			(uint32_t)((uint64_t)((2 * (uint64_t)q - a - 1) % q) * inv % q);
+		sv->nprm++;
+	}
+
+	oasis_sieve_seek(sv, 0);
+
+	return 0;
+}
+
+/**
+ * @brief Initialize a sieve that shares the primes of another sieve
+ *
+ * @param[out] sv  Sieve state (own segment and cursor)
+ * @param[in]  org Sieve made by oasis_sieve_init()
+ *
+ * @return 0 on success, -1 on memory allocation failure
+ *
+ * @note prm[]/root[] are read only after oasis_sieve_init(), so any number
+ *       of threads may each sieve their own part of the k range with a
+ *       shared sieve.  org must be cleared last.
+ */
+int oasis_sieve_share(OASIS_SIEVE *sv, const OASIS_SIEVE *org)
+{
+	memset(sv, 0, sizeof(*sv));
+
+	sv->shared = 1;
+	sv->nprm   = org->nprm;
+	sv->prm    = org->prm;
+	sv->root[OASIS_SIEVE_M1] = org->root[OASIS_SIEVE_M1];
+	sv->root[OASIS_SIEVE_P1] = org->root[OASIS_SIEVE_P1];
+	sv->next[OASIS_SIEVE_M1] = malloc(((size_t)sv->nprm + 1) * sizeof(uint32_t));
+	sv->next[OASIS_SIEVE_P1] = malloc(((size_t)sv->nprm + 1) * sizeof(uint32_t));
+	sv->bits[OASIS_SIEVE_M1] = malloc(OASIS_SIEVE_SEG_BITS / 8);
+	sv->bits[OASIS_SIEVE_P1] = malloc(OASIS_SIEVE_SEG_BITS / 8);
+	if ((sv->next[OASIS_SIEVE_M1] == NULL) || (sv->next[OASIS_SIEVE_P1] == NULL)
+	||  (sv->bits[OASIS_SIEVE_M1] == NULL) || (sv->bits[OASIS_SIEVE_P1] == NULL)) {
+		oasis_sieve_clear(sv);
+		return -1;
+	}
+
+	oasis_sieve_seek(sv, 0);
+
+	return 0;
+}
+
+/**
+ * @brief Strike out the composites of the current segment
+ *
+ * @param[in,out] sv Sieve state, next[] relative to seg_lo on entry and
+ *                   relative to the following segment on return
+ */
+static void sieve_segment(OASIS_SIEVE *sv)
+{
+	uint64_t len = sv->seg_len;
+	uint64_t o;
+	uint32_t q;
+	uint32_t j;
+	int      s;
+
+	XPT_PRF_B(XPT_EV_SEG, (uint32_t)len);
+	for (s = OASIS_SIEVE_M1; s <= OASIS_SIEVE_P1; s++) {
+		uint64_t *bits = sv->bits[s];
+		uint32_t *next = sv->next[s];
+
+		memset(bits, 0, OASIS_SIEVE_SEG_BITS / 8);
+		for (j = 0; j < sv->nprm; j++) {
+			q = sv->prm[j];
+			for (o = next[j]; o < len; o += q) {
+				bits[o >> 6] |= (uint64_t)1 << (o & 63);
+			}
+			next[j] = (uint32_t)(o - len);
+		}
+	}
+	XPT_PRF_E(XPT_EV_SEG, (uint32_t)len);
+}
+
+/**
+ * @brief Position the sieve on the segment starting at k
+ *
+ * @param[in,out] sv Sieve state
+ * @param[in]     k  First desert index of the segment
+ */
+void oasis_sieve_seek(OASIS_SIEVE *sv, uint64_t k)
+{
+	uint32_t q, r;
+	uint32_t j;
+
+	for (j = 0; j < sv->nprm; j++) {
+		q = sv->prm[j];
+		r = (uint32_t)(k % q);
+		sv->next[OASIS_SIEVE_M1][j] = (sv->root[OASIS_SIEVE_M1][j] + q - r) % q;
+		sv->next[OASIS_SIEVE_P1][j] = (sv->root[OASIS_SIEVE_P1][j] + q - r) % q;
+	}
+	sv->seg_lo  = k;
+	sv->seg_len = OASIS_SIEVE_SEG_BITS;
+	sieve_segment(sv);
+}
+
+/**
+ * @brief Advance the sieve to the following segment
+ *
+ * @param[in,out] sv Sieve state
+ */
+void oasis_sieve_next(OASIS_SIEVE *sv)
+{
+	sv->seg_lo += sv->seg_len;
+	sieve_segment(sv);
+}
+
+/**
+ * @brief Release the sieve
+ *
+ * @param[in,out] sv Sieve state
+ */
+void oasis_sieve_clear(OASIS_SIEVE *sv)
+{
+	if (!sv->shared) {
+		free(sv->prm);
+		free(sv->root[OASIS_SIEVE_M1]);
+		free(sv->root[OASIS_SIEVE_P1]);
+	}
+	free(sv->next[OASIS_SIEVE_M1]);
+	free(sv->next[OASIS_SIEVE_P1]);
+	free(sv->bits[OASIS_SIEVE_M1]);
+	free(sv->bits[OASIS_SIEVE_P1]);
+	memset(sv, 0, sizeof(*sv));
+}
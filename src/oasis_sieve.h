@@ -0,0 +1,83 @@
+/**
+ * @file oasis_sieve.h
+ * @brief Segmented small-prime sieve over the desert index k.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * Every candidate of a desert scan has the form pit(k) +- 1 with
+ * pit(k) = pit0 + k*step.  For a sieve prime q that does not divide step,
+ * the composite positions are exactly k = -(pit0 +- 1) * step^-1 (mod q),
+ * so whole residue classes of k can be struck out before any bignum work.
+ *
+ * @note v1.8.1 (2026-10-16): Share the sieve primes between threads
+ *
+ * @note v1.8.0 (2026-10-16): Add segmented sieve for prime_oasis/prime_oases
+ */
+
+#ifndef _OASIS_SIEVE_H
+#define _OASIS_SIEVE_H
+
+#include <stdint.h>
+#include <gmp.h>
+
+#define OASIS_SIEVE_M1		(0)		// pit - 1
+#define OASIS_SIEVE_P1		(1)		// pit + 1
+
+#define OASIS_SIEVE_SEG_BITS	(1 << 16)	// k per segment: 2 x 8KB fits in L1
+#define OASIS_SIEVE_MIN_LIMIT	(1 << 16)	// sieve depth for short scans
+#define OASIS_SIEVE_MAX_LIMIT	(1 << 24)	// sieve depth for long scans
+#define OASIS_SIEVE_DEPTH	(64)		// depth = number of k * DEPTH
+
+typedef struct {
+	uint32_t	 nprm;		// number of sieve primes
+	uint32_t	*prm;		// sieve primes q (q does not divide step)
+	uint32_t	*root[2];	// composite class k mod q for m1/p1
+	uint32_t	*next[2];	// next composite offset in the current segment
+	uint64_t	 seg_lo;	// first k of the current segment
+	uint64_t	 seg_len;	// number of k in the current segment
+	uint64_t	*bits[2];	// 1 = composite, for m1/p1
+	uint64_t	 sieved;	// number of candidates struck out
+	int		 shared;	// prm/root belong to another sieve
+} OASIS_SIEVE;
+
+uint32_t *oasis_prime_table(uint32_t limit, uint32_t *cnt);
+uint32_t  oasis_sieve_limit(mpz_t pit0, uint64_t num);
+int       oasis_sieve_init(OASIS_SIEVE *sv, mpz_t pit0, mpz_t step, uint32_t limit);
+int       oasis_sieve_share(OASIS_SIEVE *sv, const OASIS_SIEVE *org);
+void      oasis_sieve_seek(OASIS_SIEVE *sv, uint64_t k);
+void      oasis_sieve_next(OASIS_SIEVE *sv);
+void      oasis_sieve_clear(OASIS_SIEVE *sv);
+
+/**
+ * @brief Check whether candidate pit(k)+-1 survived the sieve
+ *
+ * @param[in,out] sv   Sieve state (segments are advanced on demand)
+ * @param[in]     k    Desert index relative to pit0
+ * @param[in]     sign OASIS_SIEVE_M1 or OASIS_SIEVE_P1
+ *
+ * @return 1 if the candidate still needs a primality test, 0 if composite
+ *
+ * @note k is expected to grow monotonically; a backward or far jump
+ *       re-seeks the sieve.
+ */
+static inline int oasis_sieve_pass(OASIS_SIEVE *sv, uint64_t k, int sign)
+{
+	uint64_t o;
+
+	if (k - sv->seg_lo >= sv->seg_len) {		// out of segment?
+		if (k - sv->seg_lo < 2 * sv->seg_len) {
+			oasis_sieve_next(sv);		//    sequential
+		}
+		else {
+			oasis_sieve_seek(sv, k);	//    jump
+		}
+	}
+	o = k - sv->seg_lo;
+	if ((sv->bits[sign][o >> 6] >> (o & 63)) & 1) {
+		sv->sieved++;
+		return 0;
+	}
+	return 1;
+}
+
+#endif  // _OASIS_SIEVE_H
@@ -7,6 +7,125 @@
  * This program demonstrates finding prime numbers within prime deserts
  * using the innovative LCM method - a constructive (non-sieve) approach.
  *
+ * @note v1.32.1 (2026-10-16): Review fixes
+ *       1. SIGTERM stops the scan like Ctrl+C also without --checkpoint,
+ *          so a preempted job writes every hit it found before it ends
+ *       2. --resume cuts a text output file (-o <file>, <file>.gz, stdout
+ *          redirected to a file) back to the checkpoint, so the lines that
+ *          a killed scan wrote after it are not written twice; an output
+ *          shorter than the checkpoint (stdout too) stops the scan with
+ *          -8 and the error on stderr
+ *
+ * @note v1.32.0 (2026-10-16): Add --cache <dir> (result cache, see oasis_cache.h)
+ *       1. --cache <dir>: the deserts scanned and their hits are kept in
+ *          <dir>/d<n>.cache; the deserts found there are printed from it,
+ *          the engine scans the gaps only (the output is the same)
+ *       2. The caches of the smaller d<m> are read too: d701 * k is
+ *          d691 * 701k, served by a scan of d691
+ *
+ * @note v1.31.0 (2026-10-16): Add --no-decimal (k-form text lines)
+ *       1. --no-decimal: print "d<n>*<k>+-1" without " = <decimal>", the
+ *          scan never converts the ~310-digit values to base 10
+ *       2. oasis_decode renders the lines (from a file or a pipe) into the
+ *          text output, off the scan (nice oasis_decode, later, elsewhere)
+ *
+ * @note v1.30.0 (2026-10-16): The hits are written through an output stream (see oasis_out.h)
+ *       1. The lines and records go to large buffers written by a thread of
+ *          their own with one write() each, so a terminal, a slow pipe or a
+ *          slow disk no longer stalls the scan
+ *       2. -o <file>.gz writes a gzip stream (text only; zcat, zgrep read it,
+ *          also after a kill -9 up to the last checkpoint)
+ *       3. The stream is flushed before a checkpoint and closed before the
+ *          interrupt is released, so no hit is lost on Ctrl+C or SIGTERM
+ *
+ * @note v1.29.0 (2026-10-16): Add --pipeline (staged scan of the engine)
+ *       1. --pipeline: a sieve thread, -j <threads> PRP workers and the
+ *          writer pass batches of survivors through lock-free queues, so
+ *          a slow output stalls neither the sieve nor the tests
+ *       2. --progress and --status show the queue depths and the waits of
+ *          the stages
+ *
+ * @note v1.27.0 (2026-10-16): Add --shard i/n for array jobs
+ *       1. --shard i/n: scan the i-th (0..n-1) of n slices of the deserts,
+ *          as "d<n> x<no + lo> <hi - lo>" of its own (checkpoint, binary
+ *          header and statistics line included), no coordinator needed
+ *       2. oasis_merge of the n outputs is the output of the whole scan
+ *
+ * @note v1.26.0 (2026-10-16): Add --worker of the work-unit coordinator
+ *       1. --worker <addr>: scan the units handed out by oasis_coord (see
+ *          oasis_coord.c) and send their hits back, renew the lease with
+ *          the stat callback while scanning
+ *       2. --worker-crash <n>: die before the result of the <n>-th unit, to
+ *          test that the coordinator hands it out again
+ *
+ * @note v1.25.0 (2026-10-16): 64-bit k of the hits
+ *       1. The k of a hit (x<no> + desert) is computed in 64 bits, the
+ *          mpz only when x<no> + desert overflows
+ *       2. x<no> and <num> are no longer truncated: <num> >= 2^64 is an
+ *          error, x<no> >= 2^64 is printed from the mpz
+ *
+ * @note v1.24.0 (2026-10-16): Take the interrupt in a control thread (see oasis_ctl.h)
+ *       1. Ctrl+C, 'q', ESC and SIGTERM (--checkpoint) no longer poll the
+ *          keyboard from the scan, the threads only read a stop flag
+ *       2. SIGUSR1 prints the progress to stderr (and to --status <file>)
+ *
+ * @note v1.22.0 (2026-10-16): Add hardware performance counters
+ *       1. --perf-counters: count cycles, instructions, IPC, L1D/LLC and
+ *          branch misses of the sieve, PRP and output phases (perf_event)
+ *          and print them per million candidates to stderr
+ *
+ * @note v1.20.0 (2026-10-16): Add live progress
+ *       1. --progress <sec>: print the fraction done, candidates/s, hits/s
+ *          and the ETA to stderr every <sec> seconds
+ *       2. --status <file>: append the same as an NDJSON line to <file>
+ *       3. PO_STAT.time is the time of the scan
+ *
+ * @note v1.18.0 (2026-10-16): Scan with the engine of liboasis
+ *       1. The sieve, the screen, the test and the threads of the scan are
+ *          done by oasis_engine_run() (see oasis_engine.h); the command
+ *          prints the hits of the callback, the output is unchanged
+ *
+ * @note v1.15.0 (2026-10-16): Take d<n> from the LCM table
+ *       1. The make_lcm() macro is replaced by oasis_lcm_get(): d<n> is
+ *          copied from the mapped table, computed only beyond it
+ *
+ * @note v1.14.0 (2026-10-16): Add binary result stream
+ *       1. --format=bin -o <file>: write a 16-byte record per hit instead of
+ *          the decimal digits (see oasis_rec.h), oasis_decode prints the text
+ *       2. -o <file>: write the hits to <file> instead of stdout
+ *       3. --resume of a binary stream cuts it back to the checkpoint, so
+ *          no record is written twice even after a kill -9
+ *
+ * @note v1.13.0 (2026-10-16): Add checkpoint / resume
+ *       1. --checkpoint <file>: save the position and the counters every
+ *          OASIS_CKPT_SEC seconds and at the end (see oasis_ckpt.h)
+ *       2. --resume <file>: continue the scan of the checkpoint; the output
+ *          continues with the first line that was not written
+ *       3. SIGTERM stops the scan like Ctrl+C, so a preempted job saves
+ *          its checkpoint
+ *
+ * @note v1.12.0 (2026-10-16): Add batched PRP screen
+ *       1. Sieve survivors are collected in batches and screened 8 at a time
+ *          with AVX-512 IFMA (oasis_prp_screen()), scalar without it
+ *
+ * @note v1.11.0 (2026-10-16): Add mpn Montgomery Fermat filter
+ *       1. Candidates that survive the sieve are screened by a base-2 Fermat
+ *          test on preallocated limbs before mpz_probab_prime_p()
+ *
+ * @note v1.10.0 (2026-10-16): Add primality proof of the hits
+ *       1. --prove option: prove d<n>*k+1 by N-1 and d<n>*k-1 by N+1 with
+ *          the factorization of d<n> instead of mpz_probab_prime_p()
+ *       2. Hits that could not be proven are marked "(probable)"
+ *
+ * @note v1.9.0 (2026-10-16): Add multi-threaded search
+ *       1. -j <threads> option: scan chunks of deserts with a pool of threads
+ *       2. The output is reordered to be identical to the single thread output
+ *       3. On interrupt, display the first position that is not scanned (x<no>)
+ *
+ * @note v1.8.0 (2026-10-16): Add segmented small-prime sieve
+ *       1. Strike out d<n>*k+-1 divisible by a prime q > n before mpz_probab_prime_p()
+ *       2. Sieve depth grows with <num> (see oasis_sieve_limit())
+ *
  * @note v1.6.1 (2026-01-15): Add a feature to search from the middle
  *       1. Specify desert/no/num as arguments to the command
  *       2. Display USAGE message
@@ -45,114 +164,425 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <gmp.h>
-#include <termios.h>
 #include <unistd.h>
 #include <signal.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #define XPT_ON
 #include "xpt.h"
 int xpt_flg = 0;
 
+#include "oasis_engine.h"
+#include "oasis_ckpt.h"
+#include "oasis_rec.h"
+#include "oasis_lcm.h"
+#include "oasis_ctl.h"
+#include "oasis_out.h"
+#include "oasis_cache.h"
+#include "oasis_net.h"
+
 #define ERR_OK		(0)
 #define ERR_PNUM	(-1)
 #define ERR_NOND	(-2)
 #define ERR_NONX	(-3)
 #define ERR_TSML	(-4)
 #define ERR_INVL	(-5)	// Invalid value
+#define ERR_OPT		(-6)	// Invalid option
+#define ERR_CKPT	(-7)	// Invalid checkpoint
+#define ERR_OUT		(-8)	// Output file cannot be written
+#define ERR_NET		(-9)	// Coordinator cannot be reached (--worker)
+
+#define PO_FMT_TEXT		(0)		// --format=text
+#define PO_FMT_BIN		(1)		// --format=bin
+#define PO_FMT_KFORM		(2)		// --no-decimal (text lines without the decimal)
+
+#define PO_THREADS_MAX		(OASIS_ENG_THREADS_MAX)
+#define PO_STATUS_SEC		(10)		// --status interval without --progress
+#define PO_CONNECT_SEC		(10)		// --worker: tries to connect to the coordinator
+#define PO_CRASH_EXIT		(99)		// --worker-crash: exit status of the crash
 
-#define make_lcm(A, B) {			\
-	mpz_set_ui(A, 1);			\
-	for (int ii = 2; ii <= B; ii++) {	\
-		mpz_lcm_ui(A, A,  ii);		\
-	}					\
-}
-	
 typedef struct {
 	int		desert;
-	uint64_t	no;
+	uint64_t	no;		// x<no> (0: x<no> does not fit in 64 bits)
 	uint64_t	num;
-	uint64_t	time;
+	uint64_t	time;		// seconds of the scan
 	uint64_t	try_cnt;
 	uint64_t	hit_cnt;
 	float		hit_per;	// hit_cnt/try_cnt*100.0
+	uint64_t	prv_cnt;	// proven hits (--prove)
+	uint64_t	out_lines;	// output lines (checkpoint)
 } PO_STAT;
 
 static PO_STAT po_stat[1] = { 0 };
 
-/* Global variables: interrupt flag and terminal settings */
-static volatile sig_atomic_t interrupted = 0;
-static struct termios orig_termios;
-static int tty_configured = 0;
+typedef struct {
+	int		threads;	// -j <threads>
+	int		prove;		// --prove
+	const char     *ckpt;		// --checkpoint/--resume <file>
+	int		resume;		// --resume
+	uint64_t	k_start;	// first desert to scan (relative to x<no>)
+	int		format;		// --format=text/bin, --no-decimal (PO_FMT_*)
+	const char     *out;		// -o <file> (NULL: stdout)
+	int		progress;	// --progress <sec> (0: off)
+	const char     *status;		// --status <file> (NULL: off)
+	int		perf;		// --perf-counters
+	const char     *worker;		// --worker <addr> (NULL: off)
+	int		crash;		// --worker-crash <n> (0: off)
+	uint64_t	shard_i;	// --shard <i>/<n>: slice i (0..n-1)
+	uint64_t	shard_n;	// number of slices (0: off)
+	int		pipeline;	// --pipeline
+	const char     *cache;		// --cache <dir> (NULL: off)
+} PO_OPT;
+
+static PO_OPT po_opt[1] = { { 1, 0, NULL, 0, 0, PO_FMT_TEXT, NULL, 0, NULL, 0, NULL, 0, 0, 0, 0, NULL } };
+
+/* The connection to the coordinator (--worker) */
+typedef struct {
+	int		fd;
+	unsigned long	unit;		// unit being scanned
+} PO_WORKER;
+
+static PO_WORKER po_wk[1];
+
+static OASIS_OUT po_out[1];			// output stream of the hits
+static FILE *po_fp;				// -o <file> (NULL: stdout)
+static FILE *po_mem;				// hits of a unit (--worker, NULL: po_out)
+static FILE *po_status;				// --status <file>
+
+static OASIS_ENGINE po_eng[1];			// scan of the deserts (liboasis)
+
+static OASIS_CACHE po_cache[1];			// --cache <dir> (own->map NULL: off)
+static uint64_t    po_cache_k;			// first desert scanned, not marked tested yet
 
 /**
- * @brief Signal handler for Ctrl+C (SIGINT)
+ * @brief Write a line or a record of a hit and count it
+ *
+ * @note Modified in v1.32.1 (2026-10-16): no output hash (never read)
+ *
+ * @note Added in v1.30.0 (2026-10-16)
  */
-void signal_handler(int sig)
+static void po_put(const void *p, size_t len)
 {
-	(void)sig; // Suppress unused parameter warning
-	interrupted = 1;
+	if (po_mem) fwrite(p, 1, len, po_mem);
+	else        oasis_out_write(po_out, p, len);
+	po_stat->out_lines++;
 }
 
 /**
- * @brief Enable terminal raw mode for non-blocking input
+ * @brief Print a hit (hit callback of the engine)
+ *
+ * @param[in] arg   x<no> (mpz_ptr)
+ * @param[in] n     n of d<n>
+ * @param[in] k     Desert relative to x<no>
+ * @param[in] sign  -1 or +1
+ * @param[in] x     d<n>*(no+k)+-1
+ * @param[in] flags OASIS_HIT_*
+ *
+ * @return 0 (the scan goes on)
+ *
+ * @note Modified in v1.31.0 (2026-10-16): with --no-decimal, the line is
+ *       "d<n>*<k>+-1" only and x is not converted to base 10.
+ *
+ * @note Modified in v1.30.0 (2026-10-16): written by po_put().
+ *
+ * @note Modified in v1.25.0 (2026-10-16): no + k is computed in 64 bits
+ *       (65 bits for a record); the mpz is used only when it overflows.
+ *
+ * @note Modified in v1.18.0 (2026-10-16): called by the engine (see
+ *       oasis_engine.h) for the hits in order; the line, or the record of
+ *       --format=bin, is the same as before.
+ *
+ * @note Modified in v1.14.0 (2026-10-16): with --format=bin, a record
+ *       (see oasis_rec.h) is written instead of the text line.
  */
-void enable_raw_mode(void)
+static int po_hit(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags)
 {
-	struct termios raw;
+	OASIS_REC   rec[1];
+	const char *prob = (flags & OASIS_HIT_PROBABLE)? " (probable)": "";
+	char        kl[64];
+	char       *line;
+	int         len;
+	mpz_t       r;
 
-	if (!isatty(STDIN_FILENO)) return;
+	if (po_opt->format == PO_FMT_BIN) {
+		oasis_rec_set_ui(rec, po_stat->no, k, (sign < 0)? '-': '+', flags);	// x<no> < 2^64 (open_output())
+		po_put(rec, sizeof(rec));
+		return 0;
+	}
 
-	tcgetattr(STDIN_FILENO, &orig_termios);
-	tty_configured = 1;
+	if (po_stat->no && k <= UINT64_MAX - po_stat->no) {	// no + k in 64 bits
+		if (po_opt->format == PO_FMT_KFORM) {		// no base conversion at all
+			len = snprintf(kl, sizeof(kl), "d%d*%lu%c1%s\n", n, po_stat->no + k, (sign < 0)? '-': '+', prob);
+			po_put(kl, len);
+			return 0;
+		}
+		len = gmp_asprintf(&line, "d%d*%lu%c1 = %Zd%s\n", n, po_stat->no + k, (sign < 0)? '-': '+', x, prob);
+	}
+	else {
+		mpz_init(r);
+		mpz_add_ui(r, (mpz_ptr)arg, k);		// r = no + k;
+		if (po_opt->format == PO_FMT_KFORM) {
+			len = gmp_asprintf(&line, "d%d*%Zd%c1%s\n", n, r, (sign < 0)? '-': '+', prob);
+		}
+		else {
+			len = gmp_asprintf(&line, "d%d*%Zd%c1 = %Zd%s\n", n, r, (sign < 0)? '-': '+', x, prob);
+		}
+		mpz_clear(r);
+	}
+	po_put(line, len);
+	free(line);
+
+	return 0;
+}
+
+/**
+ * @brief Save the checkpoint of the scan
+ *
+ * @param[in] k_next First desert (relative to x<no>) that has not been written
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the size and identity of the
+ *       output file, and the state of its gzip member, are saved.
+ *
+ * @note Modified in v1.30.0 (2026-10-16): the output stream is flushed.
+ *
+ * @note Modified in v1.25.0 (2026-10-16): x<no> is printed from the mpz.
+ *
+ * @note Modified in v1.18.0 (2026-10-16): the counters come from the engine.
+ *
+ * @note Modified in v1.14.0 (2026-10-16): the output format and file are saved.
+ *
+ * @note Added in v1.13.0 (2026-10-16): stdout is flushed first, so the
+ *       output always covers the checkpoint.
+ */
+static void save_checkpoint(uint64_t k_next)
+{
+	OASIS_CKPT ck[1];
 
-	raw = orig_termios;
-	raw.c_lflag &= ~(ICANON | ECHO); // Disable canonical mode and echo
-	raw.c_cc[VMIN] = 0;  // Non-blocking
-	raw.c_cc[VTIME] = 0; // No timeout
+	memset(ck, 0, sizeof(ck));
+	snprintf(ck->prog, sizeof(ck->prog), "prime_oases");
+	gmp_snprintf(ck->args, sizeof(ck->args), "d%d x%Zd %lu",
+		 po_stat->desert, (mpz_ptr)po_eng->arg, po_stat->num);
+	ck->prove    = po_opt->prove;
+	ck->next     = k_next;
+	ck->try_cnt  = po_eng->st->try_cnt;
+	ck->hit_cnt  = po_eng->st->hit_cnt;
+	ck->prv_cnt  = po_eng->st->prv_cnt;
+	ck->lines    = po_stat->out_lines;
+	ck->format   = po_opt->format;
+	snprintf(ck->out, sizeof(ck->out), "%s", (po_opt->out)? po_opt->out: "");
 
-	tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+	fflush(stdout);
+	oasis_out_flush(po_out);
+	oasis_ckpt_mark(ck, (po_fp)? fileno(po_fp): STDOUT_FILENO);
+	ck->gz_open = oasis_out_gz_member(po_out, &ck->gz_crc, &ck->gz_len);
+	if (oasis_ckpt_save(po_opt->ckpt, ck) != 0) {
+		XPT(XPT_WRN, "WRN: checkpoint '%s' not saved\n", po_opt->ckpt);
+	}
 }
 
 /**
- * @brief Restore original terminal settings
+ * @brief Mark the deserts scanned up to k_next as tested in the cache
+ *
+ * @param[in] k_next First desert (relative to x<no>) not scanned yet
+ *
+ * @details Called when all the hits before k_next are recorded by
+ *          po_hit_cache(), so a covered desert always has its hits.
+ *
+ * @note Added in v1.32.0 (2026-10-16)
  */
-void disable_raw_mode(void)
+static void po_cache_mark(uint64_t k_next)
 {
-	if (tty_configured) {
-		tcsetattr(STDIN_FILENO, TCSAFLUSH, &orig_termios);
-		tty_configured = 0;
+	int bits = OASIS_CACHE_TESTED | ((po_eng->prove)? OASIS_CACHE_PROVED: 0);
+
+	for (; po_cache_k < k_next; po_cache_k++) {
+		if (oasis_cache_set(po_cache, po_stat->no + po_cache_k, bits) != 0) break;	// read only
+		po_cache->scanned++;
 	}
 }
 
 /**
- * @brief Check for keyboard input (non-blocking)
- * @return Character code of pressed key, or 0 if no input
+ * @brief Save the checkpoint (sync callback of the engine)
+ *
+ * @note Modified in v1.32.0 (2026-10-16): the deserts before k_next are
+ *       marked in the cache (--cache).
+ *
+ * @note Added in v1.18.0 (2026-10-16): called every OASIS_CKPT_SEC seconds
+ *       when all the hits before k_next are written.
  */
-int check_key_pressed(void)
+static void po_sync(void *arg, uint64_t k_next)
 {
-	char c;
-	int n = read(STDIN_FILENO, &c, 1);
-	if (n == 1) {
-		return (int)(unsigned char)c;
+	(void)arg;
+	if (po_cache->own->map) po_cache_mark(k_next);
+	save_checkpoint(k_next);
+}
+
+/**
+ * @brief Publish the progress (stat callback of the engine)
+ *
+ * @note Modified in v1.25.0 (2026-10-16): x<no> is taken from arg (mpz).
+ *
+ * @note Modified in v1.24.0 (2026-10-16): also to stderr on SIGUSR1.
+ *
+ * @note Added in v1.20.0 (2026-10-16): human readable to stderr (--progress),
+ *       NDJSON to the status file (--status).
+ */
+static void po_prog(void *arg, const OASIS_ENG_PROG *pg)
+{
+	char prog[128];
+
+	gmp_snprintf(prog, sizeof(prog), "prime_oases d%d x%Zd %lu", po_stat->desert, (mpz_ptr)arg, po_stat->num);
+	if (po_opt->progress || pg->req) {
+		oasis_engine_prog_print(stderr, prog, pg, 0);
+	}
+	if (po_status) {
+		oasis_engine_prog_print(po_status, prog, pg, 1);
 	}
-	return 0;
 }
 
 /**
- * @brief Check if interrupt has been requested
- * @return 1 if should interrupt, 0 to continue
+ * @brief Set up the scan of po_stat->num deserts from d<n>*x<no>
+ *
+ * @param[out] eng    Scan
+ * @param[in]  desert d<n>
+ * @param[in]  no     x<no> (kept by eng->arg)
+ *
+ * @note Added in v1.26.0 (2026-10-16): shared by find_prime_oases() and
+ *       the units of --worker.
  */
-int should_interrupt(void)
+static void po_engine_init(OASIS_ENGINE *eng, mpz_t desert, mpz_t no)
 {
-	if (interrupted) return 1;
+	oasis_engine_init(eng);
+	mpz_mul(eng->start, desert, no);		// pit = desert * no;	// Starting position to search
+	mpz_set(eng->step, desert);			// pit += desert
+	eng->num      = po_stat->num;
+	eng->n        = po_stat->desert;
+	eng->threads  = po_opt->threads;
+	eng->pipeline = po_opt->pipeline;
+	eng->prove_n  = (po_opt->prove)? po_stat->desert: 0;
+	eng->hit      = po_hit;
+	eng->arg      = no;
+}
 
-	int key = check_key_pressed();
-	if (key == 'q' || key == 'Q' || key == 27) { // 27 = ESC
-		return 1;
+/**
+ * @brief Record a hit of the engine in the cache, then print it (--cache)
+ *
+ * @note Added in v1.32.0 (2026-10-16)
+ */
+static int po_hit_cache(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags)
+{
+	int bits = (sign < 0)? OASIS_CACHE_M1: OASIS_CACHE_P1;
+
+	if (flags & OASIS_HIT_PROVEN) {
+		bits |= (sign < 0)? OASIS_CACHE_PRV_M1: OASIS_CACHE_PRV_P1;
 	}
-	return 0;
+	oasis_cache_set(po_cache, po_stat->no + k, bits);
+
+	return po_hit(arg, n, k, sign, x, flags);
+}
+
+/**
+ * @brief Print the hits of covered deserts from the cache
+ *
+ * @param[in,out] eng   Scan (counters)
+ * @param[in]     k     First desert (relative to x<no>)
+ * @param[in]     k_end End of the covered deserts
+ * @param[in]     ctl   Control of the scan (stop)
+ *
+ * @return The first desert not printed (k_end unless stopped)
+ *
+ * @details The hits, their flags and the counters are those the engine
+ *          gives for the same deserts (see deliver() of oasis_engine.c).
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the tries are counted by
+ *       oasis_engine_tries() (one per desert for d2).
+ *
+ * @note Added in v1.32.0 (2026-10-16)
+ */
+static uint64_t po_serve(OASIS_ENGINE *eng, uint64_t k, uint64_t k_end, OASIS_CTL *ctl)
+{
+	int   prove = po_opt->prove;
+	int   st, f;
+	mpz_t x;
+
+	mpz_init(x);
+	for (; k < k_end && !atomic_load(&ctl->stop); k++) {
+		st = oasis_cache_get(po_cache, po_stat->no + k, prove);
+		eng->st->try_cnt += oasis_engine_tries(eng, k, k + 1);
+		if (st & OASIS_CACHE_M1) {
+			f = (!prove)? 0: (st & OASIS_CACHE_PRV_M1)? OASIS_HIT_PROVEN: OASIS_HIT_PROBABLE;
+			mpz_mul_ui(x, eng->step, k);		// x = pit(k) - 1
+			mpz_add(x, x, eng->start);
+			mpz_sub_ui(x, x, 1);
+			po_hit(eng->arg, eng->n, k, -1, x, f);
+			eng->st->hit_cnt++;
+			eng->st->prv_cnt += ((f & OASIS_HIT_PROVEN) != 0);
+		}
+		if (st & OASIS_CACHE_P1) {
+			f = (!prove)? 0: (st & OASIS_CACHE_PRV_P1)? OASIS_HIT_PROVEN: OASIS_HIT_PROBABLE;
+			if (st & OASIS_CACHE_M1) {
+				f |= OASIS_HIT_TWIN;
+				eng->st->twin_cnt++;
+			}
+			mpz_mul_ui(x, eng->step, k);		// x = pit(k) + 1
+			mpz_add(x, x, eng->start);
+			mpz_add_ui(x, x, 1);
+			po_hit(eng->arg, eng->n, k, 1, x, f);
+			eng->st->hit_cnt++;
+			eng->st->prv_cnt += ((f & OASIS_HIT_PROVEN) != 0);
+		}
+		po_cache->served++;
+	}
+	mpz_clear(x);
+
+	return k;
+}
+
+/**
+ * @brief Scan the deserts, the covered ones from the cache (--cache)
+ *
+ * @param[in,out] eng Scan (k_start..num-1)
+ * @param[in]     ctl Control of the scan (stop)
+ *
+ * @return 0 on success (k_end and st are set), -1 on memory allocation failure
+ *
+ * @details The deserts are split into runs of covered deserts, printed by
+ *          po_serve(), and gaps, scanned by the engine with its hits
+ *          recorded; the hits come in order of k as from one scan.
+ *
+ * @note Added in v1.32.0 (2026-10-16)
+ */
+static int po_scan(OASIS_ENGINE *eng, OASIS_CTL *ctl)
+{
+	uint64_t num = eng->num;
+	uint64_t k   = eng->k_start;
+	uint64_t e;
+	int      ret = 0;
+
+	if (po_cache->own->map == NULL) return oasis_engine_run(eng);
+
+	eng->hit   = po_hit_cache;
+	eng->prove = (eng->prove_n > 0);		// as oasis_engine_run() sets it, if no gap is scanned
+	eng->dup   = (mpz_cmp_ui(eng->step, 2) == 0);
+	while (k < num && !atomic_load(&ctl->stop)) {
+		e = oasis_cache_span(po_cache, po_stat->no + k, po_stat->no + num, po_opt->prove, 1) - po_stat->no;
+		k = po_serve(eng, k, e, ctl);
+		if (k < e || k >= num) break;		// stopped, or all covered
+		e = oasis_cache_span(po_cache, po_stat->no + k, po_stat->no + num, po_opt->prove, 0) - po_stat->no;
+		eng->k_start = k;
+		eng->num     = e;
+		po_cache_k   = k;
+		ret = oasis_engine_run(eng);
+		po_cache_mark(eng->k_end);
+		k = eng->k_end;
+		if (ret != 0 || k < e) break;		// stopped
+	}
+	eng->num   = num;
+	eng->k_end = k;
+	eng->hit   = po_hit;
+
+	return ret;
 }
 
 /**
@@ -162,6 +592,56 @@ int should_interrupt(void)
  * @param[in] no     Starting position to search.
  * @param[in] num    Number of deserts to search.
  *
+ * @note Modified in v1.32.1 (2026-10-16):
+ *       - SIGTERM is taken by the control thread without --checkpoint too.
+ *
+ * @note Modified in v1.32.0 (2026-10-16):
+ *       - With --cache, the covered deserts are printed from the cache and
+ *         the gaps are scanned (po_scan()).
+ *
+ * @note Modified in v1.26.0 (2026-10-16):
+ *       - The engine is set up by po_engine_init().
+ *
+ * @note Modified in v1.25.0 (2026-10-16):
+ *       - x<no> of the statistics is printed from the mpz (no truncation).
+ *
+ * @note Modified in v1.24.0 (2026-10-16):
+ *       - Ctrl+C, 'q', ESC and, with --checkpoint, SIGTERM are taken by the
+ *         control thread (see oasis_ctl.h); SIGUSR1 prints the progress.
+ *
+ * @note Modified in v1.22.0 (2026-10-16):
+ *       - With --perf-counters, the perf_event counts of the phases are
+ *         printed to stderr per million candidates.
+ *
+ * @note Modified in v1.20.0 (2026-10-16):
+ *       - The progress is published by po_prog() (--progress, --status),
+ *         po_stat->time is set.
+ *
+ * @note Modified in v1.18.0 (2026-10-16):
+ *       - The scan (sieve, screen, test, threads) is done by the engine of
+ *         liboasis (see oasis_engine.h), the hits are printed by po_hit().
+ *
+ * @note Modified in v1.14.0 (2026-10-16):
+ *       - The hits are written to po_out (-o <file>, --format=bin).
+ *
+ * @note Modified in v1.13.0 (2026-10-16):
+ *       - The scan starts at po_opt->k_start (--resume), and the checkpoint
+ *         is saved at the end (--checkpoint).
+ *
+ * @note Modified in v1.10.0 (2026-10-16):
+ *       - With --prove, the hits are proven (see test_prime()) and the
+ *         number of proven hits is added to the statistics.
+ *
+ * @note Modified in v1.9.0 (2026-10-16):
+ *       - With -j <threads>, the deserts are scanned by a pool of threads
+ *         (see scan_parallel()). The output is the same as the serial scan.
+ *       - On interrupt, display the first position that is not scanned
+ *         (x<no>) instead of pit.
+ *
+ * @note Modified in v1.8.0 (2026-10-16):
+ *       - Candidates are checked against the segmented sieve before
+ *         mpz_probab_prime_p(). Struck out candidates still count as try.
+ *
  * @note Modified in v1.6.1 (2026-01-15):
  *       - Added 'no' parameters.
  *
@@ -186,73 +666,225 @@ int should_interrupt(void)
  */
 void find_prime_oases(mpz_t desert, mpz_t no, mpz_t num)
 {
-	mpz_t pit;
-	mpz_t p1;	// plus 1
-	mpz_t m1;	// minus 1
-	mpz_t i;
-	mpz_t r;
-
-	mpz_init(pit);
-	mpz_init(p1);
-	mpz_init(m1);
-	mpz_init(i);
+	OASIS_ENGINE *eng = po_eng;
+	OASIS_CTL     ctl[1];
+	uint64_t      k_end;
+	time_t        t0;
+	mpz_t         r;
+
+	(void)num;	// po_stat->num
+
 	mpz_init(r);
+	po_engine_init(eng, desert, no);
+	eng->k_start  = po_opt->k_start;
+	eng->sync_sec = (po_opt->ckpt)? OASIS_CKPT_SEC: 0;
+	eng->sync     = po_sync;
+	eng->stat_sec = (po_opt->progress)? po_opt->progress: (po_status)? PO_STATUS_SEC: 0;
+	eng->stat     = po_prog;				// SIGUSR1 too
+	eng->perf     = po_opt->perf;
+	eng->st->try_cnt = po_stat->try_cnt;		// 0 unless --resume
+	eng->st->hit_cnt = po_stat->hit_cnt;
+	eng->st->prv_cnt = po_stat->prv_cnt;
 
-	mpz_set_ui(p1, 0);				// p1 = 0;
-	mpz_set(pit, desert);				// pit = desert;
-	mpz_mul(pit, pit, no);				// pit *= no;	// Starting position to search
-							//
-	for (mpz_set_ui(i, 0);				// for (i = 0;
-	     mpz_cmp(i, num) < 0;			//      i < n; 
-	     mpz_add_ui(i, i, 1),			//      i++,
-	     mpz_add(pit, pit, desert)) {		//      pit += desert) {
-
-	   /* Periodically check for interrupt (every 100 iterations) */
-	   mpz_mod_ui(r, i, 100); 			// r = i % 100;
-	   if (mpz_cmp_ui(r, 0) == 0) {			// if (r == 0) {
-	      if (should_interrupt()) {
-	         printf("\n\n*** Interrupted by user ***\n");
-		 printf("Current position: ");
-		 gmp_printf("pit = %Zd\n", pit);
-		 break;
-	      }
-	   }
-
-	   /*--- m1 ---*/
-	   mpz_sub_ui(m1, pit, 1);			//    m1 = pit - 1;
-	   if (mpz_cmp(m1, p1) != 0) {			//    if (m1 != p1) {
-	      po_stat->try_cnt++;			//       try++;
-	      if (mpz_probab_prime_p(m1, 25)) {		//       if (m1 == prime) {
-		 po_stat->hit_cnt++;			//          hit++;
-		 mpz_add(r, no, i);			//          r = po_stat->no + i;
-		 gmp_printf("d%d*%Zd-1 = %Zd\n", po_stat->desert, r, m1);
-	      }
-	   }
-
-	   /*--- p1 ---*/
-	   mpz_add_ui(p1, pit, 1);			//       p1 = pit + 1;
-	   po_stat->try_cnt++;				//       try++;
-	   if (mpz_probab_prime_p(p1, 25)) {		//       prime?
-	      po_stat->hit_cnt++;			//          hit++;
-	      mpz_add(r, no, i);			//          r = po_stat->no + i;
-	      gmp_printf("d%d*%Zd+1 = %Zd\n", po_stat->desert, r, p1);
-	   }
-	}
-	printf("{ prime_oases d%d x%lu %lu: try=%lu, hit=%lu(%2.1f%%) }\n",
+	t0 = time(NULL);
+	oasis_ctl_start(ctl, eng, OASIS_CTL_KEYS);
+	if (po_scan(eng, ctl) != 0) {
+		printf("ERR: Out of memory\n");
+	}
+	oasis_out_close(po_out);			// all hits written, the interrupt still taken (error: main())
+	oasis_ctl_end(ctl);
+	po_stat->time = time(NULL) - t0;
+	if (eng->kernel && eng->sv_nprm == 0) {		// the engine ran (not all from --cache)
+		XPT(XPT_WRN, "WRN: sieve disabled (out of memory)\n");
+	}
+	if (po_opt->prove && !eng->prove) {
+		XPT(XPT_WRN, "WRN: proof disabled (out of memory)\n");
+		po_opt->prove = 0;
+	}
+	k_end = eng->k_end;
+	po_stat->try_cnt = eng->st->try_cnt;
+	po_stat->hit_cnt = eng->st->hit_cnt;
+	po_stat->prv_cnt = eng->st->prv_cnt;
+	if (po_opt->ckpt) {
+		save_checkpoint(k_end);
+	}
+
+	if (k_end < po_stat->num) {
+		mpz_add_ui(r, no, k_end);
+		printf("\n\n*** Interrupted by user ***\n");
+		printf("Current position: ");
+		gmp_printf("x%Zd (%lu deserts left)\n", r, po_stat->num - k_end);
+	}
+	gmp_printf("{ prime_oases d%d x%Zd %lu: try=%lu, hit=%lu(%2.1f%%)",
 		po_stat->desert,
-		po_stat->no,
+		no,
 		po_stat->num,
 		po_stat->try_cnt,
 		po_stat->hit_cnt, 
-		(float)po_stat->hit_cnt / (float)po_stat->try_cnt * 100.0);
+		(double)po_stat->hit_cnt / (double)po_stat->try_cnt * 100.0);
+	if (po_opt->prove) {
+		printf(", proven=%lu", po_stat->prv_cnt);
+	}
+	printf(" }\n");
+	if (po_opt->perf) {
+		fflush(stdout);
+		oasis_perf_print(stderr, eng->pf, eng->st->try_cnt - eng->try0);
+	}
+
+	XPT(XPT_SNP, "SNP: sieve %u primes\n", eng->sv_nprm);
+	XPT(XPT_SNP, "SNP: %s screen %lu/%lu passed\n", (eng->kernel)? eng->kernel: "-", eng->scr_pass, eng->scr_cnt);
+	XPT(XPT_SNP, "SNP: %lu chunks, %lu stolen\n", eng->chunks, eng->steals);
+	if (eng->pipeline) {
+		XPT(XPT_SNP, "SNP: pipeline %lu batches, %d PRP workers, queue max %u/%u, "
+			"wait sieve %.2fs prp %.2fs out %.2fs\n",
+			eng->pipe->batches, eng->pipe->prp, eng->pipe->q_prp_max, eng->pipe->q_out_max,
+			eng->pipe->sieve_stall, eng->pipe->prp_idle, eng->pipe->out_idle);
+	}
+	if (po_cache->own->map) {
+		XPT(XPT_SNP, "SNP: cache %lu deserts served, %lu scanned (%d smaller d<m>%s)\n",
+			po_cache->served, po_cache->scanned, po_cache->nsrc,
+			(po_cache->own->rw)? "": ", read only");
+	}
+	XPT(XPT_SNP, "SNP: output %lu bytes, %lu written in %lu writes, wait %.2fs\n",
+		po_out->bytes_in, po_out->bytes_out, po_out->writes, po_out->ns_stall / 1e9);
+	XPT(XPT_SNP, "SNP: %lu sec\n", po_stat->time);
 
-	mpz_clear(pit);
-	mpz_clear(p1);
-	mpz_clear(m1);
-	mpz_clear(i);
+	oasis_engine_clear(eng);
 	mpz_clear(r);
 }
 
+/**
+ * @brief Renew the lease of the unit (stat callback of the engine, --worker)
+ *
+ * @note Added in v1.26.0 (2026-10-16)
+ */
+static void po_beat(void *arg, const OASIS_ENG_PROG *pg)
+{
+	char line[64];
+	int  len;
+
+	(void)arg;
+	if (pg->done) return;
+	len = snprintf(line, sizeof(line), "BEAT %lu\n", po_wk->unit);
+	oasis_net_write(po_wk->fd, line, len);
+}
+
+/**
+ * @brief Scan a unit of the coordinator into a buffer (--worker)
+ *
+ * @param[in]  desert d<n>
+ * @param[in]  no     x<no> of the unit
+ * @param[in]  lease  Lease of the unit [sec]
+ * @param[out] out    Hits, text lines or records (free())
+ * @param[out] len    Bytes of out
+ *
+ * @return 0, or -1 if the scan failed
+ *
+ * @note Added in v1.26.0 (2026-10-16)
+ */
+static int po_unit(mpz_t desert, mpz_t no, int lease, char **out, size_t *len)
+{
+	OASIS_ENGINE *eng = po_eng;
+	int           ret;
+
+	po_mem = open_memstream(out, len);
+	if (po_mem == NULL) return -1;
+
+	po_engine_init(eng, desert, no);
+	eng->stat_sec = (lease >= 3)? lease / 3: 1;	// BEAT
+	eng->stat     = po_beat;
+	ret = oasis_engine_run(eng);
+	po_stat->try_cnt = eng->st->try_cnt;
+	po_stat->hit_cnt = eng->st->hit_cnt;
+	po_stat->prv_cnt = eng->st->prv_cnt;
+	oasis_engine_clear(eng);
+
+	if (fclose(po_mem) != 0) ret = -1;
+	po_mem = NULL;
+
+	return ret;
+}
+
+/**
+ * @brief Work for the coordinator: scan the units it hands out (--worker)
+ *
+ * @param[in] addr Address of the coordinator (see oasis_net.h)
+ *
+ * @return ERR_OK when the coordinator is done or gone, ERR_NET if it
+ *         cannot be reached
+ *
+ * @details The connection is tried for PO_CONNECT_SEC seconds, so the
+ *          workers may be started before the coordinator.  A coordinator
+ *          that is gone ends the worker too (its job is over or lost).
+ *
+ * @note Added in v1.26.0 (2026-10-16)
+ */
+static int po_worker(const char *addr)
+{
+	char          line[OASIS_NET_LINE];
+	char          x[OASIS_NET_LINE];
+	char          fmt[8];
+	char         *out;
+	size_t        len;
+	unsigned long num;
+	int           n, prove, lease, i;
+	int           units = 0;
+	mpz_t         desert;
+	mpz_t         no;
+
+	for (i = 0; (po_wk->fd = oasis_net_connect(addr)) < 0 && i < PO_CONNECT_SEC * 10; i++) {
+		usleep(100 * 1000);
+	}
+	if (po_wk->fd < 0) {
+		printf("ERR: Cannot connect to '%s'\n", addr);
+		return ERR_NET;
+	}
+	mpz_init(desert);
+	mpz_init(no);
+
+	n = snprintf(line, sizeof(line), "HELLO %ld\n", (long)getpid());
+	oasis_net_write(po_wk->fd, line, n);
+	while (oasis_net_line(po_wk->fd, line, sizeof(line)) >= 0) {
+		if (strcmp(line, "DONE") == 0) break;
+		if (sscanf(line, "WAIT %d", &n) == 1) {
+			sleep(n);
+			oasis_net_write(po_wk->fd, "NEXT\n", 5);
+			continue;
+		}
+		if (sscanf(line, "UNIT %lu d%d x%s %lu %7s %d %d", &po_wk->unit, &n, x, &num, fmt, &prove, &lease) != 7
+		||  n < 2 || mpz_set_str(no, x, 10) != 0 || mpz_cmp_ui(no, 1) < 0 || num < 1) {
+			XPT(XPT_ERR, "ERR: '%s'\n", line);
+			break;
+		}
+		oasis_lcm_get(desert, n);			// desert = lcm(1,2,3,...,n)
+		po_stat->desert = n;
+		po_stat->no     = (mpz_fits_ulong_p(no))? mpz_get_ui(no): 0;
+		po_stat->num    = num;
+		po_opt->prove   = prove;
+		po_opt->format  = (strcmp(fmt, "bin") == 0)? PO_FMT_BIN: PO_FMT_TEXT;
+		if ((po_opt->format == PO_FMT_BIN && po_stat->no == 0)
+		||  po_unit(desert, no, lease, &out, &len) != 0) {
+			XPT(XPT_ERR, "ERR: unit %lu failed\n", po_wk->unit);
+			break;
+		}
+		if (++units == po_opt->crash) {		// --worker-crash <n>
+			_exit(PO_CRASH_EXIT);
+		}
+		n = snprintf(line, sizeof(line), "RESULT %lu %lu %lu %lu %zu\n", po_wk->unit,
+			     po_stat->try_cnt, po_stat->hit_cnt, po_stat->prv_cnt, len);
+		i = oasis_net_write(po_wk->fd, line, n) | oasis_net_write(po_wk->fd, out, len);
+		free(out);
+		if (i != 0) break;
+	}
+	printf("%d units done\n", units);
+
+	close(po_wk->fd);
+	mpz_clear(desert);
+	mpz_clear(no);
+
+	return ERR_OK;
+}
+
 /**
  * @brief Validate that a string contains only digits
  * @param[in] str String to validate
@@ -271,6 +903,168 @@ static int is_valid_number_string(const char *str)
 	return 1;
 }
 
+/**
+ * @brief Parse and remove the options from the command line
+ *
+ * @param[in,out] argc Argument count (options are removed)
+ * @param[in,out] argv Argument vector (options are removed)
+ *
+ * @return 0 on success, ERR_OPT on an invalid option
+ *
+ * @details Options may be placed anywhere on the command line:
+ *          - -j <threads>, -j<threads>: number of scanning threads
+ *          - --prove: prove the hits instead of the probable prime test
+ *          - --checkpoint <file>: save the checkpoint of the scan
+ *          - --resume <file>: continue the scan of the checkpoint
+ *          - --format=text, --format=bin: format of the hits
+ *          - --no-decimal: text lines without the decimal (d<n>*<k>+-1)
+ *          - -o <file>: write the hits to <file>
+ *          - --progress <sec>: print the progress to stderr every <sec> seconds
+ *          - --status <file>: append the progress to <file> (NDJSON)
+ *          - --perf-counters: print the perf_event counts of the phases
+ *          - --worker <addr>: scan the units of the coordinator (oasis_coord)
+ *          - --worker-crash <n>: die before the result of the <n>-th unit (test)
+ *          - --shard <i>/<n>: scan the i-th of n slices of the deserts
+ *          - --pipeline: staged scan, sieve -> <threads> PRP workers -> output
+ *          - --cache <dir>: serve the deserts scanned before from <dir>
+ */
+static int check_option(int *argc, char *argv[])
+{
+	int   ret = ERR_OK;
+	int   i, n = 1;
+	int   nodec = 0;
+	char *vp;
+
+	for (i = 1; i < *argc && ret == ERR_OK; i++) {
+		if (argv[i][0] != '-') {			// not an option?
+			argv[n++] = argv[i];
+			continue;
+		}
+
+		if (strcmp(argv[i], "--prove") == 0) {		// --prove
+			po_opt->prove = 1;
+		}
+		else if ((strcmp(argv[i], "--checkpoint") == 0)	// --checkpoint <file>
+		||       (strcmp(argv[i], "--resume") == 0)) {	// --resume <file>
+			if (i + 1 >= *argc) {
+				printf("ERR: %s needs <file>\n", argv[i]);
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->resume |= (strcmp(argv[i], "--resume") == 0);
+				po_opt->ckpt    = argv[++i];
+			}
+		}
+		else if (strncmp(argv[i], "--format=", 9) == 0) {	// --format=text/bin
+			if      (strcmp(&argv[i][9], "text") == 0) po_opt->format = PO_FMT_TEXT;
+			else if (strcmp(&argv[i][9], "bin")  == 0) po_opt->format = PO_FMT_BIN;
+			else {
+				printf("ERR: --format must be text or bin\n");
+				ret = ERR_OPT;
+			}
+		}
+		else if (strcmp(argv[i], "--no-decimal") == 0) {	// --no-decimal
+			nodec = 1;
+		}
+		else if (strcmp(argv[i], "-o") == 0) {		// -o <file>
+			if (i + 1 >= *argc) {
+				printf("ERR: -o needs <file>\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->out = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--progress") == 0) {	// --progress <sec>
+			if (i + 1 >= *argc || !is_valid_number_string(argv[i + 1]) || atoi(argv[i + 1]) < 1) {
+				printf("ERR: --progress needs <sec> >= 1\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->progress = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "--status") == 0) {	// --status <file>
+			if (i + 1 >= *argc) {
+				printf("ERR: --status needs <file>\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->status = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--perf-counters") == 0) {	// --perf-counters
+			po_opt->perf = 1;
+		}
+		else if (strcmp(argv[i], "--worker") == 0) {	// --worker <addr>
+			if (i + 1 >= *argc) {
+				printf("ERR: --worker needs <addr>\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->worker = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--worker-crash") == 0) {	// --worker-crash <n>
+			if (i + 1 >= *argc || !is_valid_number_string(argv[i + 1]) || atoi(argv[i + 1]) < 1) {
+				printf("ERR: --worker-crash needs <n> >= 1\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->crash = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "--shard") == 0) {	// --shard <i>/<n>
+			if (i + 1 >= *argc
+			||  sscanf(argv[i + 1], "%lu/%lu", &po_opt->shard_i, &po_opt->shard_n) != 2
+			||  po_opt->shard_n < 1 || po_opt->shard_i >= po_opt->shard_n) {
+				printf("ERR: --shard needs <i>/<n>, 0 <= i < n\n");
+				ret = ERR_OPT;
+			}
+			i++;
+		}
+		else if (strcmp(argv[i], "--pipeline") == 0) {	// --pipeline
+			po_opt->pipeline = 1;
+		}
+		else if (strcmp(argv[i], "--cache") == 0) {	// --cache <dir>
+			if (i + 1 >= *argc) {
+				printf("ERR: --cache needs <dir>\n");
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->cache = argv[++i];
+			}
+		}
+		else if (strncmp(argv[i], "-j", 2) == 0) {	// -j <threads>
+			vp = (argv[i][2] != '\0')? &argv[i][2]:
+			     (i + 1 < *argc)?     argv[++i]:   NULL;
+			if (!is_valid_number_string(vp)
+			||  atoi(vp) < 1 || atoi(vp) > PO_THREADS_MAX) {
+				printf("ERR: -j <threads> must be 1..%d\n", PO_THREADS_MAX);
+				ret = ERR_OPT;
+			}
+			else {
+				po_opt->threads = atoi(vp);
+			}
+		}
+		else {
+			printf("ERR: Unknown option '%s'\n", argv[i]);
+			ret = ERR_OPT;
+		}
+	}
+	if (ret == ERR_OK && nodec) {
+		if (po_opt->format == PO_FMT_BIN) {
+			printf("ERR: --no-decimal is for the text format\n");
+			ret = ERR_OPT;
+		}
+		po_opt->format = PO_FMT_KFORM;
+	}
+	argv[n] = NULL;
+	*argc = n;
+
+	return ret;
+}
+
 /**
  * @brief Display usage information for the prime_oases command
  * 
@@ -285,11 +1079,45 @@ static void disp_usage()
 {
 	printf("---< USAGE:\n");
 	printf("       prime_oases d<n> [<num>]\n");
-	printf("       prime_oases d<n> x<no> [<num>]\n\n");
+	printf("       prime_oases d<n> x<no> [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] --pipeline [--prove] d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] --checkpoint <file> d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] [--format=bin] -o <file> d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] --no-decimal [-o <file>] d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] [--format=bin] [-o <file>] --shard <i>/<n> d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] [--prove] --cache <dir> d<n> [x<no>] [<num>]\n");
+	printf("       prime_oases [-j <threads>] --resume <file>\n");
+	printf("       prime_oases [-j <threads>] --worker <addr>\n\n");
 	printf("---< DESCRIPTION:\n");
 	printf("       d<n>     Central coordinates of the desert that can be calculated by LCM(1,2,3,...,n)\n");
 	printf("       x<no>    Starting position from the middle (optional, defaults to x1)\n");
 	printf("       <num>    Number of deserts to search (optional, defaults to 1)\n");
+	printf("---< OPTIONS:\n");
+	printf("       -j <threads>  Number of threads to search (1..%d, defaults to 1)\n", PO_THREADS_MAX);
+	printf("                     The output is the same as with one thread.\n");
+	printf("       --prove       Prove the primes with the factorization of d<n> (N-1 for +1, N+1 for -1)\n");
+	printf("                     Primes that could not be proven are marked '(probable)'.\n");
+	printf("       --checkpoint <file>  Save the position of the search every %d seconds and at the end\n", OASIS_CKPT_SEC);
+	printf("       --resume <file>      Continue the search of the checkpoint (and keep saving it)\n");
+	printf("                            The output continues with the first line that was not saved.\n");
+	printf("       --format=bin  Write a 16-byte record per prime to -o <file> (oasis_decode prints it)\n");
+	printf("       --no-decimal  Print d<n>*<k>+-1 only, without ' = <decimal>' (oasis_decode prints it)\n");
+	printf("       -o <file>     Write the primes to <file> instead of the screen\n");
+	printf("                     <file>.gz is written compressed (gzip, text only).\n");
+	printf("       --progress <sec>  Print the progress and the ETA to stderr every <sec> seconds\n");
+	printf("       --status <file>   Append the progress to <file> as NDJSON (every <sec>, or %d seconds)\n", PO_STATUS_SEC);
+	printf("       --perf-counters   Print cycles, instructions, IPC, cache and branch misses of the\n");
+	printf("                         sieve, PRP and output per million candidates to stderr (perf_event)\n");
+	printf("       --worker <addr>   Scan the units handed out by oasis_coord at <addr>\n");
+	printf("                         (unix:<path> or <host>:<port>) until it is done\n");
+	printf("       --worker-crash <n>  Die before sending the <n>-th unit (test of oasis_coord)\n");
+	printf("       --shard <i>/<n>   Scan the i-th (0..n-1) of n slices of the deserts only\n");
+	printf("                         oasis_merge of the n outputs is the output of the whole scan.\n");
+	printf("       --pipeline        Sieve, test (-j <threads> workers) and output in stages of their own\n");
+	printf("                         --progress shows the queue depths and the waits of the stages.\n");
+	printf("       --cache <dir>     Keep the deserts scanned and their primes in <dir>/d<n>.cache and print\n");
+	printf("                         the deserts found there from it (also d<m>.cache, m < n: d701 = d691*701)\n");
 	printf("---< CAUTION:\n");
 	printf("       1) Since d<n> is a least common multiple, it may be the same value even if n changes.\n");
 	printf("          The value refers to results/resultd.txt.\n");
@@ -297,11 +1125,28 @@ static void disp_usage()
 	printf("       3) If you omit <num>,  1 is specified as the default value.\n");
 	printf("       4) When using two arguments, second argument without 'x' prefix is treated as <num>.\n");
 	printf("          Example: 'prime_oases d691 100' means search from x1 for 100 deserts.\n");
+	printf("       5) Ctrl+C, 'q' and SIGTERM stop the scan with every prime written and save the\n");
+	printf("          checkpoint. After a kill -9, --resume cuts the output file (-o <file>, or\n");
+	printf("          stdout redirected with >>) back to the checkpoint, so no line is written twice.\n");
+	printf("          Lines to a terminal or a pipe after the last checkpoint are written again.\n");
+	printf("       6) kill -USR1 <pid> prints the progress to stderr.\n");
 	printf("---< EXAMPLES:\n");
 	printf("       prime_oases d3              # Search d3*1±1 for 1 desert\n");
 	printf("       prime_oases d691 100        # Search d691*1±1 for 100 deserts\n");
 	printf("       prime_oases d691 x701       # Search d691*701±1 for 1 desert\n");
 	printf("       prime_oases d691 x701 701   # Search d691*701±1 for 701 deserts\n");
+	printf("       prime_oases -j 4 d683 x484391 484391  # Search with 4 threads\n");
+	printf("       prime_oases --prove d691 x701 701     # Search and prove the primes\n");
+	printf("       prime_oases --checkpoint l2.ckpt d683 x484391 484391  # Save the position\n");
+	printf("       prime_oases --resume l2.ckpt          # Continue the search\n");
+	printf("       prime_oases --format=bin -o l2.bin d683 x484391 484391  # Binary output\n");
+	printf("       prime_oases -o l2.txt.gz d683 x484391 484391  # Compressed output\n");
+	printf("       prime_oases --no-decimal d683 x484391 484391 | nice oasis_decode -  # Decimal off the scan\n");
+	printf("       prime_oases --progress 60 --status l2.json d683 x484391 484391  # Progress and ETA\n");
+	printf("       prime_oases -j 4 --worker node0:7010  # Work for 'oasis_coord -l :7010 ...'\n");
+	printf("       prime_oases --shard 3/16 -o s3.txt d683 x484391 484391  # Slice 3 of an array job of 16\n");
+	printf("       prime_oases -j 3 --pipeline --progress 60 d683 x484391 484391  # Staged scan\n");
+	printf("       prime_oases --cache ~/.oasis d683 x484391 484391  # Scan once, served the next time\n");
 	printf("---\n");
 }
 
@@ -319,7 +1164,7 @@ static void disp_usage()
  *         ERR_TSML: Invalid parameter range 
  *         ERR_NOND: 'd' is not exist.
  *         ERR_NONX: 'x' is not exist.
- *         ERR_INVL: Invalid value format
+ *         ERR_INVL: Invalid value format (also <num> >= 2^64)
  * 
  * @details Supports four usage patterns:
  *          - 2 args: prime_oases d<n>              (x1, num=1)
@@ -327,6 +1172,9 @@ static void disp_usage()
  *          - 3 args: prime_oases d<n> x<no>        (num=1)
  *          - 4 args: prime_oases d<n> x<no> <num>
  *
+ * @note Modified in v1.25.0 (2026-10-16): <num> must fit in 64 bits,
+ *       po_stat->no is 0 if x<no> does not.
+ *
  * @note All mpz_t parameters must be initialized before calling
  * @note Validates that desert >= 2, no >= 1, num >= 1
  * @note Display an error message whenever possible in case of an error.
@@ -359,7 +1207,7 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 					ret = ERR_TSML;
 				}
 				else {
-					make_lcm(desert, d_val);	// desert = lcm(1,2,3,...,n)
+					oasis_lcm_get(desert, d_val);	// desert = lcm(1,2,3,...,n)
 					mpz_set_ui(no,   1);		// no  = default value
 					mpz_set_ui(num,  1);		// num = default value
 									//
@@ -390,7 +1238,7 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 					ret = ERR_TSML;
 				}
 				else {
-					make_lcm(desert,  d_val);	// desert = lcm(1,2,3,...,n)
+					oasis_lcm_get(desert,  d_val);	// desert = lcm(1,2,3,...,n)
 					po_stat->desert = d_val;
 				}
 			}
@@ -414,6 +1262,10 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 						printf("ERR: <num> must be >= 1, got %s\n", nump);
 						ret = ERR_TSML;
 					}
+					else if (!mpz_fits_ulong_p(num)) {
+						printf("ERR: <num> must be < 2^64, got %s\n", nump);
+						ret = ERR_INVL;
+					}
 					else {
 						po_stat->num = mpz_get_ui(num);
 						mpz_set_ui(no, 1);	// x<no> = default
@@ -440,7 +1292,7 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 						ret = ERR_TSML;
 					}
 					else {
-						po_stat->no  = mpz_get_ui(no);
+						po_stat->no  = (mpz_fits_ulong_p(no))? mpz_get_ui(no): 0;
 						mpz_set_ui(num, 1);	// num = default
 						po_stat->num =  1;
 					}
@@ -469,7 +1321,7 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 					ret = ERR_TSML;
 				}
 				else {
-					make_lcm(desert,  d_val);	// desert = lcm(1,2,3,...,n)
+					oasis_lcm_get(desert,  d_val);	// desert = lcm(1,2,3,...,n)
 					po_stat->desert = d_val;
 				}
 			}
@@ -498,7 +1350,7 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 							ret = ERR_TSML;
 						}
 						else {
-							po_stat->no = mpz_get_ui(no);
+							po_stat->no = (mpz_fits_ulong_p(no))? mpz_get_ui(no): 0;
 						}
 					}
 				}
@@ -522,6 +1374,10 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 						printf("ERR: <num> must be >= 1, got %s\n", nump);
 						ret = ERR_TSML;
 					}
+					else if (!mpz_fits_ulong_p(num)) {
+						printf("ERR: <num> must be < 2^64, got %s\n", nump);
+						ret = ERR_INVL;
+					}
 					else {
 						po_stat->num = mpz_get_ui(num);
 					}
@@ -539,6 +1395,169 @@ static int check_param(int argc, char *argv[], mpz_t desert, mpz_t no, mpz_t num
 	return ret;
 }
 
+/**
+ * @brief Cut the parameters down to the slice of --shard <i>/<n>
+ *
+ * @param[in,out] no  x<no> of the slice
+ * @param[in,out] num <num> of the slice
+ *
+ * @return ERR_OK on success, ERR_TSML if there are less than <n> deserts
+ *
+ * @details Slice i is the deserts [lo, hi), lo = <num>*i/<n>, of x<no>
+ *          (see oasis_engine_shard_k()).  The deserts of prime_oases are
+ *          independent, so the slice is "d<n> x<no + lo> <hi - lo>".
+ *
+ * @note Added in v1.27.0 (2026-10-16)
+ */
+static int shard_param(mpz_t no, mpz_t num)
+{
+	uint64_t lo, hi;
+
+	if (po_opt->shard_n > po_stat->num) {
+		printf("ERR: --shard %lu/%lu needs <num> >= %lu, got %lu\n",
+		       po_opt->shard_i, po_opt->shard_n, po_opt->shard_n, po_stat->num);
+		return ERR_TSML;
+	}
+	lo = oasis_engine_shard_k(po_stat->num, po_opt->shard_i,     po_opt->shard_n);
+	hi = oasis_engine_shard_k(po_stat->num, po_opt->shard_i + 1, po_opt->shard_n);
+	mpz_add_ui(no, no, lo);				// x<no> of the slice
+	mpz_set_ui(num, hi - lo);
+	po_stat->no  = (mpz_fits_ulong_p(no))? mpz_get_ui(no): 0;
+	po_stat->num = hi - lo;
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Cut the text output back to the checkpoint (--resume)
+ *
+ * @param[in] ck Checkpoint
+ * @param[in] fd The output file, or stdout
+ *
+ * @return ERR_OK, or ERR_OUT if the output (-o <file>, or stdout that is
+ *         the file of the checkpoint) is shorter than the checkpoint
+ *
+ * @details The lines written after the checkpoint by a scan that was
+ *          killed are dropped, so none is written twice.  A gzip member
+ *          cut there is closed (see oasis_out_gz_end()) before the stream
+ *          appends the next one.  The error goes to stderr: stdout may be
+ *          the file that does not match.
+ *
+ * @note Added in v1.32.1 (2026-10-16)
+ */
+static int cut_output(const OASIS_CKPT *ck, int fd)
+{
+	int ret = oasis_ckpt_cut(ck, fd);
+
+	if (ret > 0 && ck->gz_open && oasis_out_gz_end(fd, ck->gz_crc, ck->gz_len) != 0) {
+		ret = -1;
+	}
+	if (ret < 0 && po_opt->out) {
+		fprintf(stderr, "ERR: '%s' does not match the checkpoint\n", po_opt->out);
+		return ERR_OUT;
+	}
+	if (ret < 0) {				// stdout: the file of the checkpoint (>>), shorter
+		fprintf(stderr, "ERR: stdout does not match the checkpoint '%s'\n", po_opt->ckpt);
+		return ERR_OUT;
+	}
+
+	return ERR_OK;
+}
+
+/**
+ * @brief Open the output stream of the hits (po_out)
+ *
+ * @param[in] ck Checkpoint (--resume)
+ *
+ * @return ERR_OK on success, ERR_OPT, ERR_CKPT or ERR_OUT on failure
+ *
+ * @details A new binary stream starts with its header (see oasis_rec.h).
+ *          On --resume the file is continued: a binary stream is cut back
+ *          to the records of the checkpoint, a text file (or stdout) to
+ *          the bytes of the checkpoint if it is the same file (see
+ *          cut_output()), else it is appended to.
+ *          A text file named *.gz is written as a gzip stream (on --resume,
+ *          a gzip member is appended: zcat reads them as one).
+ *
+ * @note Modified in v1.32.1 (2026-10-16): a text file, and stdout, are
+ *       cut back to the checkpoint instead of appended to; an output that
+ *       does not match the checkpoint is ERR_OUT (-8, as prime_oasis).
+ *
+ * @note Modified in v1.30.0 (2026-10-16): po_out is an OASIS_OUT on the
+ *       file (po_fp) or on stdout, -o <file>.gz.
+ *
+ * @note Modified in v1.25.0 (2026-10-16): --format=bin needs x<no> < 2^64.
+ *
+ * @note Added in v1.14.0 (2026-10-16)
+ */
+static int open_output(const OASIS_CKPT *ck)
+{
+	OASIS_REC_HDR hdr[1];
+	OASIS_REC_HDR old[1];
+	long          size;
+	int           gz = oasis_out_gz(po_opt->out);
+
+	if (po_opt->out == NULL) {
+		if (po_opt->format == PO_FMT_BIN) {
+			printf("ERR: --format=bin needs -o <file>\n");
+			return ERR_OPT;
+		}
+		if (po_opt->resume && cut_output(ck, STDOUT_FILENO) != 0) {	// before stdout is flushed
+			return ERR_OUT;
+		}
+	}
+	else if (po_opt->format != PO_FMT_BIN) {	// text, --no-decimal
+		po_fp = fopen(po_opt->out, (po_opt->resume)? "a": "w");
+		if (po_fp && po_opt->resume && cut_output(ck, fileno(po_fp)) != 0) {
+			fclose(po_fp);
+			po_fp = NULL;
+			return ERR_OUT;
+		}
+	}
+	else if (gz) {
+		printf("ERR: --format=bin cannot be written to '%s' (.gz)\n", po_opt->out);
+		return ERR_OPT;
+	}
+	else if (po_stat->no == 0) {			// k of a record has 96 bits
+		printf("ERR: --format=bin needs x<no> < 2^64\n");
+		return ERR_OPT;
+	}
+	else {
+		oasis_rec_hdr_init(hdr, po_stat->desert, po_stat->no, po_stat->num,
+				   (po_opt->prove)? OASIS_REC_HDR_PROVE: 0);
+		size = (long)(sizeof(hdr) + ck->lines * sizeof(OASIS_REC));
+		po_fp = fopen(po_opt->out, (po_opt->resume)? "r+b": "wb");
+		if (po_fp && po_opt->resume) {		// the records of the checkpoint
+			if ((fread(old, sizeof(old), 1, po_fp) != 1)
+			||  (memcmp(old, hdr, sizeof(hdr)) != 0)
+			||  (fseek(po_fp, 0, SEEK_END) != 0) || (ftell(po_fp) < size)
+			||  (ftruncate(fileno(po_fp), size) != 0)
+			||  (fseek(po_fp, size, SEEK_SET) != 0)) {
+				fprintf(stderr, "ERR: '%s' does not match the checkpoint\n", po_opt->out);
+				fclose(po_fp);
+				po_fp = NULL;
+				return ERR_OUT;
+			}
+		}
+		else if (po_fp) {
+			fwrite(hdr, sizeof(hdr), 1, po_fp);
+		}
+	}
+	if (po_opt->out && po_fp == NULL) {
+		printf("ERR: Cannot open '%s'\n", po_opt->out);
+		return ERR_OUT;
+	}
+
+	fflush(stdout);					// the stream writes the fd itself
+	if (po_fp) fflush(po_fp);
+	if (oasis_out_open(po_out, (po_fp)? fileno(po_fp): STDOUT_FILENO, gz) != 0) {
+		printf("ERR: %s\n", (gz)? "Cannot write gzip (built without zlib?)": "Out of memory");
+		return ERR_OUT;
+	}
+
+	return ERR_OK;
+}
+
 /**
  * @brief Main entry point
  */
@@ -548,11 +1567,10 @@ int main(int argc, char *argv[])
 	mpz_t desert;
 	mpz_t num;
 	mpz_t no;
+	OASIS_CKPT ck[1];
+	char *ck_argv[8];
 
-	/* Setup signal handler and raw mode */
-	signal(SIGINT, signal_handler);
-	enable_raw_mode();
-	atexit(disable_raw_mode); // Restore terminal on exit
+	memset(ck, 0, sizeof(ck));
 
 	XPT_INIT();
 
@@ -563,13 +1581,99 @@ int main(int argc, char *argv[])
 	mpz_init(no);
 	mpz_init(num);
 
-	ret = check_param(argc, argv, desert, no, num);
+	ret = check_option(&argc, argv);
+	if (ret == ERR_OK && po_opt->worker		// the units come from the coordinator
+	&&  (argc > 1 || po_opt->resume || po_opt->out)) {
+		printf("ERR: --worker takes no parameters, --resume or -o\n");
+		ret = ERR_PNUM;
+	}
+	if (ret == ERR_OK && po_opt->shard_n		// the checkpoint keeps the slice
+	&&  (po_opt->resume || po_opt->worker)) {
+		printf("ERR: --shard takes no --resume or --worker\n");
+		ret = ERR_PNUM;
+	}
+	if (ret == ERR_OK && po_opt->resume) {		// parameters of the checkpoint
+		if (argc > 1) {
+			printf("ERR: --resume takes no other parameters\n");
+			ret = ERR_PNUM;
+		}
+		else if ((oasis_ckpt_load(po_opt->ckpt, ck) != 0)
+		     ||  (strcmp(ck->prog, "prime_oases") != 0)) {
+			printf("ERR: '%s' is not a checkpoint of prime_oases\n", po_opt->ckpt);
+			ret = ERR_CKPT;
+		}
+		else {
+			argc = oasis_ckpt_argv(ck, ck_argv, 8);
+			argv = ck_argv;
+		}
+	}
+	if (ret == ERR_OK && !po_opt->worker) {
+		ret = check_param(argc, argv, desert, no, num);
+	}
+	if (ret == ERR_OK && po_opt->shard_n) {
+		ret = shard_param(no, num);
+	}
+	if (ret == ERR_OK && po_opt->resume) {
+		if (ck->next > po_stat->num) {
+			printf("ERR: '%s' is not a checkpoint of prime_oases\n", po_opt->ckpt);
+			ret = ERR_CKPT;
+		}
+		else {
+			po_opt->prove      = ck->prove;
+			po_opt->format     = ck->format;
+			po_opt->out        = (ck->out[0])? ck->out: NULL;
+			po_opt->k_start    = ck->next;
+			po_stat->try_cnt   = ck->try_cnt;
+			po_stat->hit_cnt   = ck->hit_cnt;
+			po_stat->prv_cnt   = ck->prv_cnt;
+			po_stat->out_lines = ck->lines;
+			mpz_add_ui(num, no, po_opt->k_start);	// x<no> of the first desert left
+			gmp_printf("Resume: d%d x%Zd (%lu deserts left)\n\n", po_stat->desert,
+				num, po_stat->num - po_opt->k_start);
+			mpz_set_ui(num, po_stat->num);
+		}
+	}
+	if (ret == ERR_OK) {
+		ret = open_output(ck);
+	}
+	if (ret == ERR_OK && po_opt->status) {
+		po_status = fopen(po_opt->status, "a");
+		if (po_status == NULL) {
+			printf("ERR: Cannot open '%s'\n", po_opt->status);
+			ret = ERR_OUT;
+		}
+	}
+	if (ret == ERR_OK && po_opt->cache) {
+		if (po_opt->worker) {
+			printf("ERR: --cache is not for --worker\n");
+			ret = ERR_OPT;
+		}
+		else if (po_stat->no == 0 || po_stat->num > UINT64_MAX - po_stat->no) {
+			printf("ERR: --cache needs x<no> + <num> < 2^64\n");
+			ret = ERR_OPT;
+		}
+		else if (oasis_cache_open(po_cache, po_opt->cache, po_stat->desert) != 0) {
+			printf("ERR: Cannot open '%s/d%d.cache'\n", po_opt->cache, po_stat->desert);
+			ret = ERR_OUT;
+		}
+	}
 	if (ret) {	// err?
-		disp_usage();
+		if (ret != ERR_OUT) disp_usage();	// stdout may be the file that does not match
+	}
+	else if (po_opt->worker) {
+		ret = po_worker(po_opt->worker);
 	}
 	else {
 		find_prime_oases(desert, no, num);
 	}
+	if ((oasis_out_close(po_out) != 0) | (po_fp && fclose(po_fp) != 0)) {
+		printf("ERR: Cannot write '%s'\n", (po_opt->out)? po_opt->out: "stdout");
+		ret = ERR_OUT;
+	}
+	if (po_status) {
+		fclose(po_status);
+	}
+	oasis_cache_close(po_cache);
 
 	mpz_clear(desert);
 	mpz_clear(num);
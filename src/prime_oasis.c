@@ -7,6 +7,61 @@
  * This program demonstrates finding prime numbers within prime deserts
  * using the innovative LCM method - a constructive (non-sieve) approach.
  *
+ * @note v1.32.1 (2026-10-16): Review fixes
+ *       1. SIGTERM stops the search like Ctrl+C also without --checkpoint,
+ *          so a preempted job writes every hit it found before it ends
+ *       2. --resume cuts stdout back to the checkpoint when it is the file
+ *          of the checkpoint (>>), so the lines that a killed search wrote
+ *          after it are not written twice; a stdout that is the file of the
+ *          checkpoint but shorter than it stops the search (-8)
+ *
+ * @note v1.30.0 (2026-10-16): The hits are written through an output stream (see oasis_out.h)
+ *       1. The lines go to large buffers written to stdout by a thread of
+ *          their own, so a terminal or a slow pipe no longer stalls the search
+ *       2. The stream is flushed before a checkpoint and closed before the
+ *          interrupt is released, so no hit is lost on Ctrl+C or SIGTERM
+ *
+ * @note v1.27.0 (2026-10-16): Add --shard i/n for array jobs
+ *       1. --shard i/n: search the i-th (0..n-1) of n slices of the deserts
+ *          (see oasis_engine_shard()); start - 1, end + 1 and the shared
+ *          pit - 1 / pit + 1 of step = 2 are tested by one slice only, so
+ *          oasis_merge of the n outputs is the output of the whole search
+ *       2. The checkpoint keeps the slice, --resume continues it
+ *
+ * @note v1.24.0 (2026-10-16): Take the interrupt in a control thread (see oasis_ctl.h)
+ *       1. Ctrl+C, 'q', ESC and SIGTERM (--checkpoint) no longer poll the
+ *          keyboard from the search, the search only reads a stop flag
+ *       2. SIGUSR1 prints the progress to stderr
+ *
+ * @note v1.18.0 (2026-10-16): Search with the engine of liboasis
+ *       1. The loop over pit is done by oasis_engine_run() (see
+ *          oasis_engine.h), the command prints the hits of the callback
+ *       2. The batched screen of prime_oases is used instead of oasis_fermat()
+ *
+ * @note v1.15.0 (2026-10-16): Take LCM(1,2,3,...,n) from the LCM table
+ *       1. The make_lcm() macro is replaced by oasis_lcm_get(): d<n> is
+ *          copied from the mapped table, computed only beyond it
+ *
+ * @note v1.13.0 (2026-10-16): Add checkpoint / resume
+ *       1. --checkpoint <file>: save the position and the counters every
+ *          OASIS_CKPT_SEC seconds and at the end (see oasis_ckpt.h)
+ *       2. --resume <file>: continue the search of the checkpoint
+ *       3. SIGTERM stops the search like Ctrl+C, so a preempted job saves
+ *          its checkpoint
+ *
+ * @note v1.11.0 (2026-10-16): Add mpn Montgomery Fermat filter
+ *       1. Candidates that survive the sieve are screened by a base-2 Fermat
+ *          test on preallocated limbs before mpz_probab_prime_p()
+ *
+ * @note v1.10.0 (2026-10-16): Add primality proof of the hits
+ *       1. --prove option: prove pit+1 by N-1 and pit-1 by N+1 with the
+ *          factorization of d<n>, n = min(<start>, <step>), which divides every pit
+ *       2. Hits that could not be proven are marked "(probable)"
+ *
+ * @note v1.8.0 (2026-10-16): Add segmented small-prime sieve
+ *       1. Strike out start+k*step+-1 divisible by a small prime before mpz_probab_prime_p()
+ *       2. Sieve depth grows with the number of deserts (see oasis_sieve_limit())
+ *
  * @note v1.5.0 (2026-01-03): Add prime_oasis command
  *       1. Specify start/end/step as arguments to the command
  *       2. Display USAGE message
@@ -30,94 +85,130 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <gmp.h>
-#include <termios.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
 
 #define XPT_ON
 #include "xpt.h"
 int xpt_flg = 0;
 
-#define make_lcm(A, B) {		\
-	mpz_set_ui(A, 1);		\
-	for (int i = 2; i <= B; i++) {	\
-		mpz_lcm_ui(A, A, i);	\
-	}				\
-}
-	
-/* Global variables: interrupt flag and terminal settings */
-static volatile sig_atomic_t interrupted = 0;
-static struct termios orig_termios;
-static int tty_configured = 0;
+#include "oasis_engine.h"
+#include "oasis_ckpt.h"
+#include "oasis_lcm.h"
+#include "oasis_ctl.h"
+#include "oasis_out.h"
 
-/**
- * @brief Signal handler for Ctrl+C (SIGINT)
- */
-void signal_handler(int sig)
-{
-	(void)sig; // Suppress unused parameter warning
-	interrupted = 1;
-}
+/* Global variables: --prove option */
+static int prove_n = 0;				// --prove: d<n> divides every pit (0: off)
 
-/**
- * @brief Enable terminal raw mode for non-blocking input
- */
-void enable_raw_mode(void)
-{
-	struct termios raw;
+/* Global variables: scan of the deserts (liboasis) */
+static OASIS_ENGINE eng[1];
 
-	if (!isatty(STDIN_FILENO)) return;
+/* Global variables: stdout of the hits */
+static OASIS_OUT out[1];
 
-	tcgetattr(STDIN_FILENO, &orig_termios);
-	tty_configured = 1;
+/* Global variables: --checkpoint/--resume option */
+static const char *ckpt_file = NULL;		// checkpoint file (NULL: off)
+static int         resume    = 0;		// --resume
+static OASIS_CKPT  ckpt[1];			// position and counters
 
-	raw = orig_termios;
-	raw.c_lflag &= ~(ICANON | ECHO); // Disable canonical mode and echo
-	raw.c_cc[VMIN] = 0;  // Non-blocking
-	raw.c_cc[VTIME] = 0; // No timeout
+/* Global variables: --shard option */
+static uint64_t shard_i = 0;			// --shard i/n: slice i (0..n-1)
+static uint64_t shard_n = 0;			// number of slices (0: off)
+
+/**
+ * @brief Print a hit and count it in the checkpoint
+ *
+ * @param[in] mark 's' for pit+1 of a twin, ' ' otherwise
+ * @param[in] x    The prime
+ * @param[in] note Suffix of the line ("" or " (probable)")
+ *
+ * @note Modified in v1.32.1 (2026-10-16): no output hash (never read)
+ *
+ * @note Modified in v1.30.0 (2026-10-16): formatted into the output stream
+ *
+ * @note Added in v1.13.0 (2026-10-16)
+ */
+static void put_hit(int mark, mpz_srcptr x, const char *note)
+{
+	int len;
 
-	tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+	len = oasis_out_printf(out, NULL, "oasis prime%c = %Zd%s\n", mark, x, note);
+	if (len < 0) return;
+	ckpt->lines++;
 }
 
 /**
- * @brief Restore original terminal settings
+ * @brief Save the checkpoint
+ *
+ * @param[in] next First desert (relative to start) that has not been searched
+ *
+ * @note Modified in v1.32.1 (2026-10-16): the size and identity of stdout
+ *       are saved (see oasis_ckpt_mark()).
+ *
+ * @note Modified in v1.30.0 (2026-10-16): the output stream is flushed too.
+ *
+ * @note Modified in v1.18.0 (2026-10-16): the counters come from the engine.
+ *
+ * @note Added in v1.13.0 (2026-10-16): stdout is flushed first, so the
+ *       output always covers the checkpoint.
  */
-void disable_raw_mode(void)
+static void save_checkpoint(uint64_t next)
 {
-	if (tty_configured) {
-		tcsetattr(STDIN_FILENO, TCSAFLUSH, &orig_termios);
-		tty_configured = 0;
+	ckpt->next     = next;
+	ckpt->try_cnt  = eng->st->try_cnt;
+	ckpt->hit_cnt  = eng->st->hit_cnt;
+	ckpt->prv_cnt  = eng->st->prv_cnt;
+	ckpt->twin_cnt = eng->st->twin_cnt;
+	fflush(stdout);
+	oasis_out_flush(out);
+	oasis_ckpt_mark(ckpt, STDOUT_FILENO);
+	if (oasis_ckpt_save(ckpt_file, ckpt) != 0) {
+		XPT(XPT_WRN, "WRN: checkpoint '%s' not saved\n", ckpt_file);
 	}
 }
 
 /**
- * @brief Check for keyboard input (non-blocking)
- * @return Character code of pressed key, or 0 if no input
+ * @brief Print a hit (hit callback of the engine)
+ *
+ * @return 0 (the search goes on)
+ *
+ * @note Added in v1.18.0 (2026-10-16): "oasis primes" marks pit+1 of a twin.
  */
-int check_key_pressed(void)
+static int on_hit(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags)
 {
-	char c;
-	int n = read(STDIN_FILENO, &c, 1);
-	if (n == 1) {
-		return (int)(unsigned char)c;
-	}
+	(void)arg;
+	(void)n;
+	(void)k;
+	(void)sign;
+	put_hit((flags & OASIS_HIT_TWIN)? 's': ' ', x,
+		(flags & OASIS_HIT_PROBABLE)? " (probable)": "");
 	return 0;
 }
 
 /**
- * @brief Check if interrupt has been requested
- * @return 1 if should interrupt, 0 to continue
+ * @brief Print the progress on SIGUSR1 (stat callback of the engine)
+ *
+ * @note Added in v1.24.0 (2026-10-16)
  */
-int should_interrupt(void)
+static void on_stat(void *arg, const OASIS_ENG_PROG *pg)
 {
-	if (interrupted) return 1;
+	(void)arg;
+	if (pg->req) oasis_engine_prog_print(stderr, "prime_oasis", pg, 0);
+}
 
-	int key = check_key_pressed();
-	if (key == 'q' || key == 'Q' || key == 27) { // 27 = ESC
-		return 1;
-	}
-	return 0;
+/**
+ * @brief Save the checkpoint (sync callback of the engine)
+ *
+ * @note Added in v1.18.0 (2026-10-16)
+ */
+static void on_sync(void *arg, uint64_t next)
+{
+	(void)arg;
+	save_checkpoint(next);
 }
 
 /**
@@ -127,6 +218,28 @@ int should_interrupt(void)
  * @param[in] end   Lower boundary of the prime gap (botom lcm)
  * @param[in] step  Search increment (smaller lcm)
  *
+ * @note Modified in v1.24.0 (2026-10-16):
+ *       - Ctrl+C, 'q', ESC and, with --checkpoint, SIGTERM are taken by the
+ *         control thread (see oasis_ctl.h); SIGUSR1 prints the progress.
+ *
+ * @note Modified in v1.18.0 (2026-10-16):
+ *       - The search is done by the engine of liboasis (see oasis_engine.h):
+ *         pit = start + k*step for the (end - start) / step + 1 deserts,
+ *         without start - 1 and, if pit reaches it, end + 1.
+ *
+ * @note Modified in v1.13.0 (2026-10-16):
+ *       - The search starts at ckpt->next with the counters of ckpt
+ *         (--resume), and the checkpoint is saved every OASIS_CKPT_SEC
+ *         seconds and at the end (--checkpoint).
+ *
+ * @note Modified in v1.10.0 (2026-10-16):
+ *       - With --prove, the hits are proven (see test_prime()) and the
+ *         number of proven hits is added to the statistics.
+ *
+ * @note Modified in v1.8.0 (2026-10-16):
+ *       - Candidates are checked against the segmented sieve before
+ *         mpz_probab_prime_p(). Struck out candidates still count as try.
+ *
  * @note Modified in v1.4.2 (2026-01-02):
  *       - Added keyboard interrupt checking in main loop (every 100 iterations)
  *       - Added twin prime counter and statistics display
@@ -137,72 +250,103 @@ int should_interrupt(void)
  *       - Added boundary checks to skip tests at range limits
  *       - Added duplicate detection for overlapping boundary tests
  *
+ * @return 0 on success, -6 if the deserts cannot be cut into --shard slices,
+ *         -7 on memory allocation failure, -8 if stdout does not match the
+ *         checkpoint (--resume)
+ *
+ * @note Modified in v1.32.1 (2026-10-16):
+ *       - SIGTERM is taken by the control thread without --checkpoint too.
+ *       - On --resume, stdout is cut back to the checkpoint if it is the
+ *         file of the checkpoint (-8 if it is shorter); the last checkpoint
+ *         is saved before the interrupted position is printed.
+ *
+ * @note Modified in v1.30.0 (2026-10-16):
+ *       - The hits are written by the thread of the output stream, which
+ *         is closed (all hits written) before the interrupt is released
+ *
+ * @note Modified in v1.27.0 (2026-10-16):
+ *       - With --shard i/n, only the i-th slice of the deserts is searched
+ *         (see oasis_engine_shard()); k and the position are relative to it.
+ *
  * @note All mpz_t parameters must be initialized before calling
  * @details Search for primes in the form: pit +- 1, where pit = start + k*step
  */
-void find_prime_oasis(mpz_t start, mpz_t end, mpz_t step)
+int find_prime_oasis(mpz_t start, mpz_t end, mpz_t step)
 {
-	int twin_flag;
-	int twin_cnt = 0;
-	int try_cnt  = 0;
-	int hit_cnt  = 0;
-	int loop_cnt = 0;
-
-	mpz_t pit;
-	mpz_t p1;	// plus 1
-	mpz_t m1;	// minus 1
+	OASIS_CTL ctl[1];
+	mpz_t     pit;
 
 	mpz_init(pit);
-	mpz_init(p1);
-	mpz_init(m1);
-
-	mpz_set_ui(p1, 0);				// p1 = 0;
-	for (mpz_set(pit, start);			// for (pit =  start
-	     mpz_cmp(pit, end) <= 0;			//      pit <= end
-	     mpz_add(pit, pit, step)) {			//      pit += step) {
-
-	   /* Periodically check for interrupt (every 100 iterations) */
-	   if (++loop_cnt % 100 == 0) {
-	      loop_cnt = 0;
-	      if (should_interrupt()) {
-	         printf("\n\n*** Interrupted by user ***\n");
-		 printf("Current position: ");
-		 gmp_printf("pit = %Zd\n", pit);
-		 break;
-	      }
-	   }
-
-           twin_flag = 0;				//
-	   if (mpz_cmp(pit, start) != 0) {		//    if (pit != start) {
-	      mpz_sub_ui(m1, pit, 1);			//       m1 = pit - 1;
-	      if (mpz_cmp(m1, p1) == 0) {		//       if (m1 == p1) {
-	         ;					//          nothing to do.
-	      }						//       }
-              else {					//       else  {
-		 try_cnt++;				//
-	         if (mpz_probab_prime_p(m1, 25)) {	//          prime?
-		    hit_cnt++;				//
-		    gmp_printf("oasis prime  = %Zd\n", m1);
-		    twin_flag = 1;			//
-	         }
-	      }
-	   }
-
-	   if (mpz_cmp(pit, end) != 0) {		//    if (pit != end) {
-	      mpz_add_ui(p1, pit, 1);			//       p1 = pit + 1;
-	      try_cnt++;				//
-	      if (mpz_probab_prime_p(p1, 25)) {		//          prime?
-		 hit_cnt++;				//
-		 gmp_printf("oasis prime%c = %Zd\n", (twin_flag)? 's':' ', p1);
-		 if (twin_flag) twin_cnt++;		//
-	      }
-           }
+	oasis_engine_init(eng);
+
+	oasis_engine_range(eng, start, end, step);	// pit = start + k * step <= end
+	if (shard_n && oasis_engine_shard(eng, shard_i, shard_n) != 0) {
+		printf("ERR: --shard %lu/%lu needs %lu <= %lu deserts\n", shard_i, shard_n, shard_n, eng->num);
+		oasis_engine_clear(eng);
+		mpz_clear(pit);
+		return -6;
+	}
+	eng->k_start  = ckpt->next;			// 0 unless --resume
+	eng->prove_n  = prove_n;
+	eng->sync_sec = (ckpt_file)? OASIS_CKPT_SEC: 0;
+	eng->hit      = on_hit;
+	eng->sync     = on_sync;
+	eng->stat     = on_stat;
+	eng->st->try_cnt  = ckpt->try_cnt;
+	eng->st->hit_cnt  = ckpt->hit_cnt;
+	eng->st->prv_cnt  = ckpt->prv_cnt;
+	eng->st->twin_cnt = ckpt->twin_cnt;
+
+	if (resume && oasis_ckpt_cut(ckpt, STDOUT_FILENO) < 0) {	// before stdout is flushed
+		fprintf(stderr, "ERR: stdout does not match the checkpoint '%s'\n", ckpt_file);
+		oasis_engine_clear(eng);
+		mpz_clear(pit);
+		return -8;
+	}
+	fflush(stdout);
+	if (oasis_out_open(out, STDOUT_FILENO, 0) != 0) {
+		printf("ERR: Out of memory\n");
+		oasis_engine_clear(eng);
+		mpz_clear(pit);
+		return -7;
+	}
+	oasis_ctl_start(ctl, eng, OASIS_CTL_KEYS);
+	oasis_engine_run(eng);
+	if (oasis_out_close(out) != 0) {		// all hits written, the interrupt still taken
+		XPT(XPT_WRN, "WRN: output not written\n");
+	}
+	oasis_ctl_end(ctl);
+	if (eng->num && eng->sv_nprm == 0) {
+		XPT(XPT_WRN, "WRN: sieve disabled (out of memory)\n");
+	}
+	if (prove_n && eng->num && !eng->prove) {
+		XPT(XPT_WRN, "WRN: proof disabled (out of memory)\n");
+		prove_n = 0;
+	}
+
+	if (ckpt_file) {				// stdout is cut back to here by --resume
+		save_checkpoint(eng->k_end);
+	}
+	if (eng->k_end < eng->num) {
+		mpz_mul_ui(pit, step, eng->k_end);
+		mpz_add(pit, pit, eng->start);		// start of the slice (--shard)
+		printf("\n\n*** Interrupted by user ***\n");
+		printf("Current position: ");
+		gmp_printf("pit = %Zd\n", pit);
 	}
-	printf("(try=%d, hit=%d, twin=%d)\n", try_cnt, hit_cnt, twin_cnt); 
+	printf("(try=%lu, hit=%lu, twin=%lu", eng->st->try_cnt, eng->st->hit_cnt, eng->st->twin_cnt); 
+	if (prove_n) {
+		printf(", proven=%lu", eng->st->prv_cnt);
+	}
+	printf(")\n");
+
+	XPT(XPT_SNP, "SNP: sieve %u primes\n", eng->sv_nprm);
+	XPT(XPT_SNP, "SNP: %s screen %lu/%lu passed\n", eng->kernel, eng->scr_pass, eng->scr_cnt);
 
+	oasis_engine_clear(eng);
 	mpz_clear(pit);
-	mpz_clear(p1);
-	mpz_clear(m1);
+
+	return 0;
 }
 
 /**
@@ -217,18 +361,92 @@ void find_prime_oasis(mpz_t start, mpz_t end, mpz_t step)
 static void disp_usage()
 {
 	printf("---< USAGE:\n");
-	printf("       prime_oasis <start> [<end>] <step>\n\n");
+	printf("       prime_oasis [--prove] [--checkpoint <file>] [--shard <i>/<n>] <start> [<end>] <step>\n");
+	printf("       prime_oasis --resume <file>\n\n");
 	printf("---< DESCRIPTION:\n");
 	printf("       <start>  Start position: n for LCM(1,2,3,...,n)\n");
 	printf("       <end>    End position: n for LCM(1,2,3,...,n) (optional, defaults to start*2)\n");
 	printf("       <step>   Search step: n for LCM(1,2,3,...,n)\n");
+	printf("---< OPTIONS:\n");
+	printf("       --prove  Prove the primes with the factorization of LCM(1,2,3,...,n), n = min(<start>, <step>)\n");
+	printf("                Primes that could not be proven are marked '(probable)'.\n");
+	printf("       --checkpoint <file>  Save the position of the search every %d seconds and at the end\n", OASIS_CKPT_SEC);
+	printf("       --resume <file>      Continue the search of the checkpoint (and keep saving it)\n");
+	printf("       --shard <i>/<n>      Search the i-th (0..n-1) of n slices of the deserts only\n");
+	printf("                            oasis_merge of the n outputs is the output of the whole search.\n");
 	printf("---< CAUTION:\n");
 	printf("       1) The value specified in the parameter is the value of n in lcm(1,2,3,...n).\n");
 	printf("          The value refers to results/resultd.txt.\n");
 	printf("       2) If you omit <end>, it will be set to <start>*2 (search from <start> to <start>*2).\n");
+	printf("       3) Ctrl+C, 'q' and SIGTERM stop the search with every prime written and save the\n");
+	printf("          checkpoint. After a kill -9, --resume cuts stdout redirected with >> back to\n");
+	printf("          the checkpoint, so no line is written twice. Lines to a terminal or a pipe\n");
+	printf("          after the last checkpoint ('lines=' in <file>) are written again.\n");
+	printf("       4) kill -USR1 <pid> prints the progress to stderr.\n");
 	printf("---\n");
 }
 
+/**
+ * @brief Parse and remove the options from the command line
+ *
+ * @param[in,out] argc Argument count (options are removed)
+ * @param[in,out] argv Argument vector (options are removed)
+ * @param[out]    prove Set to 1 by --prove
+ *
+ * @return 0 on success, -4 on an invalid option
+ *
+ * @details Options may be placed anywhere on the command line:
+ *          - --prove: prove the hits instead of the probable prime test
+ *          - --checkpoint <file>: save the checkpoint of the search
+ *          - --resume <file>: continue the search of the checkpoint
+ *          - --shard <i>/<n>: search the i-th of n slices of the deserts
+ *
+ * @note Modified in v1.27.0 (2026-10-16): --shard, also read from the
+ *       arguments of a checkpoint.
+ */
+static int check_option(int *argc, char *argv[], int *prove)
+{
+	int ret = 0;
+	int i, n = 1;
+
+	for (i = 1; i < *argc; i++) {
+		if (argv[i][0] != '-') {			// not an option?
+			argv[n++] = argv[i];
+		}
+		else if (strcmp(argv[i], "--prove") == 0) {	// --prove
+			*prove = 1;
+		}
+		else if ((strcmp(argv[i], "--checkpoint") == 0)	// --checkpoint <file>
+		||       (strcmp(argv[i], "--resume") == 0)) {	// --resume <file>
+			if (i + 1 >= *argc) {
+				printf("ERR: %s needs <file>\n", argv[i]);
+				ret = -4;
+			}
+			else {
+				resume   |= (strcmp(argv[i], "--resume") == 0);
+				ckpt_file = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--shard") == 0) {	// --shard <i>/<n>
+			if (i + 1 >= *argc
+			||  sscanf(argv[i + 1], "%lu/%lu", &shard_i, &shard_n) != 2
+			||  shard_n < 1 || shard_i >= shard_n) {
+				printf("ERR: --shard needs <i>/<n>, 0 <= i < n\n");
+				ret = -4;
+			}
+			i++;
+		}
+		else {
+			printf("ERR: Unknown option '%s'\n", argv[i]);
+			ret = -4;
+		}
+	}
+	argv[n] = NULL;
+	*argc = n;
+
+	return ret;
+}
+
 /**
  * @brief Parse and validate command line parameters
  * 
@@ -257,9 +475,9 @@ static int check_param(int argc, char *argv[], mpz_t start, mpz_t end, mpz_t ste
 
 	switch(argc) {
 	case 3:
-		make_lcm(start, atoi(argv[1]));
+		oasis_lcm_get(start, atoi(argv[1]));
 		mpz_add (end,   start, start);
-		make_lcm(step,  atoi(argv[2]));
+		oasis_lcm_get(step,  atoi(argv[2]));
 		if ((mpz_cmp_ui(start, 2) >= 0)
 		&&  (mpz_cmp_ui(step,  2) >= 0)) {
 			;	// ok.
@@ -269,9 +487,9 @@ static int check_param(int argc, char *argv[], mpz_t start, mpz_t end, mpz_t ste
 		}
 		break;
 	case 4:
-		make_lcm(start, atoi(argv[1]));
-		make_lcm(end,   atoi(argv[2]));
-		make_lcm(step,  atoi(argv[3]));
+		oasis_lcm_get(start, atoi(argv[1]));
+		oasis_lcm_get(end,   atoi(argv[2]));
+		oasis_lcm_get(step,  atoi(argv[3]));
 		if ((mpz_cmp_ui(start, 2) >= 0)
 		&&  (mpz_cmp_ui(end,   3) >= 0)
 		&&  (mpz_cmp_ui(step,  2) >= 0)) {
@@ -295,16 +513,15 @@ static int check_param(int argc, char *argv[], mpz_t start, mpz_t end, mpz_t ste
 int main(int argc, char *argv[])
 {
 	int ret;
+	int prove = 0;
+	int i;
+	char *ck_argv[8];
+	char  args[OASIS_CKPT_ARGS];
 
 	mpz_t start;
 	mpz_t end;
 	mpz_t step;
 
-	/* Setup signal handler and raw mode */
-	signal(SIGINT, signal_handler);
-	enable_raw_mode();
-	atexit(disable_raw_mode); // プログラム終了時に自動復元
-
 	XPT_INIT();
 
 	printf("Prime Oasis - Press 'q', ESC, or Ctrl+C to interrupt\n");
@@ -314,12 +531,48 @@ int main(int argc, char *argv[])
 	mpz_init(end);
 	mpz_init(step);
 
-	ret = check_param(argc, argv, start, end, step);
+	ret = check_option(&argc, argv, &prove);
+	if (ret == 0 && resume) {			// parameters of the checkpoint
+		if ((argc > 1) || (oasis_ckpt_load(ckpt_file, ckpt) != 0)
+		||  (strcmp(ckpt->prog, "prime_oasis") != 0)) {
+			printf("ERR: '%s' is not a checkpoint of prime_oasis\n", ckpt_file);
+			ret = -5;
+		}
+		else {
+			prove = ckpt->prove;
+			argc  = oasis_ckpt_argv(ckpt, ck_argv, 8);
+			argv  = ck_argv;
+			ret   = check_option(&argc, argv, &prove);	// --shard of the checkpoint
+		}
+	}
+	if (ret == 0) {
+		ret = check_param(argc, argv, start, end, step);
+	}
+	if ((ret == 0) && ckpt_file) {
+		snprintf(ckpt->prog, sizeof(ckpt->prog), "prime_oasis");
+		ckpt->prove = prove;
+		for (i = 1, args[0] = '\0'; i < argc; i++) {	// argv of --resume points into ckpt->args
+			snprintf(args + strlen(args), sizeof(args) - strlen(args),
+				 "%s%s", (i > 1)? " ": "", argv[i]);
+		}
+		if (shard_n) {
+			snprintf(args + strlen(args), sizeof(args) - strlen(args),
+				 " --shard %lu/%lu", shard_i, shard_n);
+		}
+		snprintf(ckpt->args, sizeof(ckpt->args), "%s", args);
+		if (resume) {
+			printf("Resume: %lu deserts done\n\n", ckpt->next);
+		}
+	}
+	if ((ret == 0) && prove) {			// d<min(start, step)> divides pit
+		prove_n = atoi(argv[1]);
+		if (atoi(argv[argc - 1]) < prove_n) prove_n = atoi(argv[argc - 1]);
+	}
 	if (ret) {	// err?
 		disp_usage();
 	}
 	else {
-		find_prime_oasis(start, end, step);		// display prime oasis.
+		ret = find_prime_oasis(start, end, step);	// display prime oasis.
 	}
 
 	mpz_clear(start);
@@ -2,14 +2,31 @@
 #ifndef _XPT_H
 #define _XPT_H
 
+#include <stdint.h>
+
+/* XPT_PRF events (see xpt_prf.c) */
+#define XPT_EV_CHUNK	0	// chunk of deserts of a thread
+#define XPT_EV_SEG	1	// sieve segment
+#define XPT_EV_SCREEN	2	// batched PRP screen, arg = candidates
+#define XPT_EV_TEST	3	// primality test of a candidate, arg = k (B), result (E)
+#define XPT_EV_OUT	4	// output of the hits
+#define XPT_EV_NUM	5
+
 #ifdef XPT_ON
 
 extern int xpt_flg;
 
+extern volatile int xpt_prf_on;
+
+void xpt_prf_start(void);
+void xpt_prf_put(int ev, int ph, uint32_t arg);
+void xpt_prf_dump(void);
+
 #define XPT_ERR 0x0001
 #define XPT_WRN 0x0002
 #define XPT_SNP 0x0004
 #define XPT_TST 0x0008
+#define XPT_PRF 0x0010	// trace ring, dumped to $XPT_PRF_FILE at exit
 
 #define XPT(A, ...) {		\
     if (xpt_flg & A) {		\
@@ -24,13 +41,25 @@ extern int xpt_flg;
     if (xpt_env) {					\
         xpt_flg = (int)strtol(xpt_env, NULL, 16);	\
     }							\
-} 
+    if (xpt_flg & XPT_PRF) {				\
+        xpt_prf_start();				\
+    }							\
+}
+
+#define XPT_PRF_B(ev, arg) { if (xpt_prf_on) xpt_prf_put(ev, 'B', arg); }	// begin
+#define XPT_PRF_E(ev, arg) { if (xpt_prf_on) xpt_prf_put(ev, 'E', arg); }	// end
+#define XPT_PRF_I(ev, arg) { if (xpt_prf_on) xpt_prf_put(ev, 'i', arg); }	// instant
+#define XPT_PRF_DUMP()     { if (xpt_prf_on) xpt_prf_dump(); }			// snapshot
 
 #else  // XPT_OFF
 
-#define XPT(A, B)
+#define XPT(A, ...)
 #define XPT_VER(version)
 #define XPT_INIT()
+#define XPT_PRF_B(ev, arg)
+#define XPT_PRF_E(ev, arg)
+#define XPT_PRF_I(ev, arg)
+#define XPT_PRF_DUMP()
 
 #endif  // XPT_ON
 
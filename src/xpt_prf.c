@@ -0,0 +1,299 @@
+/**
+ * @file xpt_prf.c
+ * @brief XPT_PRF: trace ring of the scan, dumped as Chrome trace JSON.
+ * @author N.Arai
+ * @date 2026-10-16
+ *
+ * XPT_FLG=0x10 turns it on (see xpt.h).  Every thread writes fixed-size,
+ * TSC-stamped events into its own ring; the ring keeps the last
+ * $XPT_PRF_EVENTS events (65536 by default) of the thread.  Writing an
+ * event is a few stores and no lock, so the trace points can sit in the
+ * candidate loop.
+ *
+ * The rings are dumped to $XPT_PRF_FILE (xpt_prf.<pid>.json by default) at
+ * exit, on SIGUSR1 (a snapshot, the run goes on), and on SIGINT/SIGTERM
+ * when the program has no handler of its own.  Open it with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * @note v1.21.0 (2026-10-16): Add XPT_PRF trace ring
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define XPT_ON
+#include "xpt.h"
+
+#define PRF_EVENTS	(1 << 16)	// default events per thread
+#define PRF_RINGS	(1024)		// threads traced
+#define PRF_BUF		(1 << 16)	// write buffer of the dump
+
+/* An event, 16 bytes */
+typedef struct {
+	uint64_t	tsc;
+	uint32_t	arg;
+	uint8_t		ev;		// XPT_EV_*
+	uint8_t		ph;		// 'B', 'E' or 'i'
+	uint16_t	pad;
+} PRF_EV;
+
+/* Ring of a thread, written by it only */
+typedef struct {
+	_Atomic uint64_t head;		// events written
+	uint64_t	 mask;		// events - 1
+	uint32_t	 tid;
+	PRF_EV		 ev[];
+} PRF_RING;
+
+static const char *prf_name[XPT_EV_NUM] = { "chunk", "segment", "screen", "test", "output" };
+
+volatile int xpt_prf_on = 0;
+
+static PRF_RING	*prf_ring[PRF_RINGS];
+static _Atomic int prf_nring;
+static uint64_t	 prf_events = PRF_EVENTS;
+static uint64_t	 prf_tsc0;			// TSC and ns at xpt_prf_start()
+static uint64_t	 prf_ns0;
+static char	 prf_file[256];
+static char	 prf_buf[PRF_BUF];
+static int	 prf_len;
+static volatile sig_atomic_t prf_busy;		// a dump is being written
+
+static __thread PRF_RING *prf_mine;		// ring of the calling thread
+
+/**
+ * @brief Monotonic time in ns
+ */
+static uint64_t prf_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Time stamp of an event (TSC, or ns without it)
+ */
+static inline uint64_t prf_tick(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return prf_ns();
+#endif
+}
+
+/**
+ * @brief Make the ring of the calling thread
+ *
+ * @return Ring, or NULL if out of memory or PRF_RINGS threads are traced
+ */
+static PRF_RING *ring_new(void)
+{
+	PRF_RING *r;
+	int       i;
+
+	i = atomic_fetch_add(&prf_nring, 1);
+	if (i >= PRF_RINGS) return NULL;
+	r = calloc(1, sizeof(PRF_RING) + prf_events * sizeof(PRF_EV));
+	if (r == NULL) return NULL;
+	r->mask = prf_events - 1;
+	r->tid  = i + 1;
+	prf_ring[i] = r;			// seen by the dump from now on
+	prf_mine = r;
+
+	return r;
+}
+
+/**
+ * @brief Record an event (XPT_PRF_B/E/I)
+ *
+ * @param[in] ev  XPT_EV_*
+ * @param[in] ph  'B' begin, 'E' end, 'i' instant
+ * @param[in] arg Argument of the event
+ */
+void xpt_prf_put(int ev, int ph, uint32_t arg)
+{
+	PRF_RING *r = prf_mine;
+	PRF_EV   *e;
+	uint64_t  h;
+
+	if (r == NULL && (r = ring_new()) == NULL) return;
+
+	h = atomic_load_explicit(&r->head, memory_order_relaxed);
+	e = &r->ev[h & r->mask];
+	e->tsc = prf_tick();
+	e->arg = arg;
+	e->ev  = (uint8_t)ev;
+	e->ph  = (uint8_t)ph;
+	atomic_store_explicit(&r->head, h + 1, memory_order_release);
+}
+
+/**
+ * @brief Append a string to the dump buffer (async-signal-safe)
+ */
+static void put_str(int fd, const char *s)
+{
+	while (*s) {
+		if (prf_len == PRF_BUF) {
+			if (write(fd, prf_buf, prf_len) < 0) return;
+			prf_len = 0;
+		}
+		prf_buf[prf_len++] = *s++;
+	}
+}
+
+/**
+ * @brief Append a number to the dump buffer (async-signal-safe)
+ */
+static void put_num(int fd, uint64_t v)
+{
+	char d[24];
+	int  i = sizeof(d) - 1;
+
+	d[i] = '\0';
+	do {
+		d[--i] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	put_str(fd, &d[i]);
+}
+
+/**
+ * @brief Write the rings to $XPT_PRF_FILE
+ *
+ * @details Only open/write/close are used, so it may be called from a
+ *          signal handler.  The threads go on writing: the last events of
+ *          a ring that is written meanwhile may be torn.
+ */
+void xpt_prf_dump(void)
+{
+	PRF_RING *r;
+	PRF_EV   *e;
+	uint64_t  h, i, ns, ns_tick1000;	// ns per 1000 ticks
+	uint64_t  tsc1 = prf_tick();
+	uint64_t  ns1  = prf_ns();
+	char      ph[2] = { 0, 0 };
+	int       fd, n, t, first = 1;
+
+	if (!xpt_prf_on || prf_busy) return;
+	prf_busy = 1;
+
+	ns_tick1000 = (tsc1 > prf_tsc0)? (ns1 - prf_ns0) * 1000 / (tsc1 - prf_tsc0): 1000;
+	fd = open(prf_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		prf_busy = 0;
+		return;
+	}
+	prf_len = 0;
+	put_str(fd, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+	n = atomic_load(&prf_nring);
+	for (t = 0; t < n && t < PRF_RINGS; t++) {
+		r = prf_ring[t];
+		if (r == NULL) continue;
+		h = atomic_load_explicit(&r->head, memory_order_acquire);
+		for (i = (h > r->mask + 1)? h - (r->mask + 1): 0; i < h; i++) {
+			e = &r->ev[i & r->mask];
+			if (e->ev >= XPT_EV_NUM) continue;
+			ns = (e->tsc > prf_tsc0)? (e->tsc - prf_tsc0) * ns_tick1000 / 1000: 0;
+			ph[0] = (char)e->ph;
+			put_str(fd, (first)? "{\"name\": \"": ",\n{\"name\": \"");
+			put_str(fd, prf_name[e->ev]);
+			put_str(fd, "\", \"cat\": \"oasis\", \"ph\": \"");
+			put_str(fd, ph);
+			put_str(fd, "\", \"ts\": ");
+			put_num(fd, ns / 1000);			// us with 3 decimals
+			put_str(fd, ".");
+			put_str(fd, (ns % 1000 < 100)? ((ns % 1000 < 10)? "00": "0"): "");
+			put_num(fd, ns % 1000);
+			put_str(fd, (e->ph == 'i')? ", \"s\": \"t\", \"pid\": ": ", \"pid\": ");
+			put_num(fd, (uint64_t)getpid());
+			put_str(fd, ", \"tid\": ");
+			put_num(fd, r->tid);
+			put_str(fd, ", \"args\": {\"arg\": ");
+			put_num(fd, e->arg);
+			put_str(fd, "}}");
+			first = 0;
+		}
+	}
+	put_str(fd, "\n]}\n");
+	if (prf_len && write(fd, prf_buf, prf_len) < 0) {
+		;					// nothing more to do in a handler
+	}
+	close(fd);
+	prf_busy = 0;
+}
+
+/**
+ * @brief Dump at exit
+ */
+static void prf_atexit(void)
+{
+	xpt_prf_dump();
+}
+
+/**
+ * @brief SIGUSR1: snapshot; SIGINT/SIGTERM (no handler of the program): dump and die
+ */
+static void prf_signal(int sig)
+{
+	xpt_prf_dump();
+	if (sig != SIGUSR1) {
+		signal(sig, SIG_DFL);
+		raise(sig);
+	}
+}
+
+/**
+ * @brief Start tracing (XPT_INIT() with XPT_PRF)
+ *
+ * @details $XPT_PRF_EVENTS sets the events kept per thread (rounded up to
+ *          a power of 2), $XPT_PRF_FILE the file of the dump.
+ */
+void xpt_prf_start(void)
+{
+	struct sigaction sa;
+	const char *env;
+	uint64_t    n;
+	int         sig[2] = { SIGINT, SIGTERM };
+	int         i;
+
+	if (xpt_prf_on) return;
+
+	env = getenv("XPT_PRF_EVENTS");
+	if (env && strtoull(env, NULL, 10) >= 16) {
+		for (n = 16; n < strtoull(env, NULL, 10); n <<= 1);
+		prf_events = n;
+	}
+	env = getenv("XPT_PRF_FILE");
+	if (env && env[0]) snprintf(prf_file, sizeof(prf_file), "%s", env);
+	else               snprintf(prf_file, sizeof(prf_file), "xpt_prf.%d.json", (int)getpid());
+
+	prf_ns0  = prf_ns();
+	prf_tsc0 = prf_tick();
+	atexit(prf_atexit);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = prf_signal;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGUSR1, &sa, NULL);
+	for (i = 0; i < 2; i++) {			// keep the handlers of the program
+		struct sigaction old;
+
+		if (sigaction(sig[i], NULL, &old) == 0 && old.sa_handler == SIG_DFL) {
+			sigaction(sig[i], &sa, NULL);
+		}
+	}
+	xpt_prf_on = 1;
+}
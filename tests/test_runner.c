@@ -3,8 +3,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <unistd.h>
 #define XPT_ON
 #include "xpt.h"
+#include "oasis_engine.h"
+#include "oasis_lcm.h"
+#include "oasis_fermat.h"
+#include "oasis_prp.h"
+#include "oasis_prove.h"
 
 static volatile int interrupted = 0;
 
@@ -438,6 +444,827 @@ static const char *expected_output[] = {
     return ret;
 }
 
+// コマンド列を実行し, 出力の先頭の行を expected の各行と前方一致で比較する.
+static int run_golden(const char *name, const char *command, const char *const expected[], int lines) {
+    int ret = 0;
+    FILE *fp;
+    char output[1024];
+    char cmd[1024];
+
+    XPT(XPT_SNP, "SNP:%s: Start.\n", name);
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:%s: interrupted.\n", name);
+        ret = -1;
+    }
+    else {
+
+        snprintf(cmd, sizeof(cmd), "(%s) </dev/null 2>&1", command);
+
+        fp = popen(cmd, "r");
+        if (fp == NULL) {
+            XPT(XPT_ERR, "ERR:%s: %s\n", name, command);
+            ret = 1;
+        }
+        else {
+            for (int i = 0; i < lines; i++) {
+                if (!fgets(output, sizeof(output), fp)) {
+                    XPT(XPT_ERR, "ERR:%s: 0 = fgets(fp)\n", name);
+                    ret = 2;
+                }
+                else if (strncmp(output, expected[i], strlen(expected[i])) != 0) {
+                    XPT(XPT_ERR, "ERR:%s:line=%d: %s", name, i+1, output);
+                    ret = 3;
+                }
+                if (ret) break;
+            }
+            pclose(fp);
+        }
+    }
+
+    XPT(XPT_SNP, "SNP:%s: ret = %d\n", name, ret);
+    return ret;
+}
+
+// liboasis: oasis_layer1 の探索をプロセス内で実行する.
+typedef struct {
+    int   hits;
+    char  first[1024];
+} HITS_0007;
+
+static int hit_0007(void *arg, int n, uint64_t k, int sign, mpz_srcptr x, int flags) {
+    HITS_0007 *h = (HITS_0007 *)arg;
+
+    (void)n;
+    (void)k;
+    (void)sign;
+    (void)flags;
+    if (h->hits++ == 0) {
+        gmp_snprintf(h->first, sizeof(h->first), "%Zd", x);
+    }
+    return 0;
+}
+
+int test_0007(void) {
+    int ret = 0;
+static const char *expected_output = "2825316306925682433915768672179340796128917213519487069241249529171862110997815815759607546544691213214701362889014226079377908856929026235806002962070710365662543644390862362492580972116364262478035480289616321859707554022310668332270492441122793125806189337411281492496035721393388592871507609346222719999";
+    OASIS_ENGINE eng[1];
+    HITS_0007 h[1] = {{0}};
+    mpz_t start, end, step;
+
+    XPT(XPT_SNP, "SNP:test_0007: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0007: interrupted.\n");
+        return -1;
+    }
+
+    mpz_init(start);
+    mpz_init(end);
+    mpz_init(step);
+    oasis_lcm_get(start, 701);
+    mpz_mul_ui(end, start, 2);
+    oasis_lcm_get(step,  691);
+
+    oasis_engine_init(eng);
+    oasis_engine_range(eng, start, end, step);
+    eng->hit = hit_0007;
+    eng->arg = h;
+
+    if (oasis_engine_run(eng) != 0) {
+        XPT(XPT_ERR, "ERR:test_0007: oasis_engine_run()\n");
+        ret = 1;
+    }
+    else if (strcmp(h->first, expected_output) != 0) {
+        XPT(XPT_ERR, "ERR:test_0007: first = %s\n", h->first);
+        ret = 3;
+    }
+    else if (eng->st->try_cnt != 1402 || eng->st->hit_cnt != 20 || eng->st->twin_cnt != 0 || h->hits != 20) {
+        XPT(XPT_ERR, "ERR:test_0007: (try=%lu, hit=%lu, twin=%lu) hits=%d\n",
+            eng->st->try_cnt, eng->st->hit_cnt, eng->st->twin_cnt, h->hits);
+        ret = 3;
+    }
+
+    oasis_engine_clear(eng);
+    mpz_clear(start);
+    mpz_clear(end);
+    mpz_clear(step);
+
+    XPT(XPT_SNP, "SNP:test_0007: ret = %d\n", ret);
+    return ret;
+}
+
+int test_0008(void) {
+    const char *command =
+        "rm -f test_0008.sock; "
+        "prime_oases -o test_0008.ref d691 x1 2000 >/dev/null; "
+        "oasis_coord -l unix:test_0008.sock -u 150 -o test_0008.txt d691 x1 2000 2>/dev/null & "
+        "prime_oases --worker unix:test_0008.sock >/dev/null & "
+        "prime_oases --worker unix:test_0008.sock --worker-crash 2 >/dev/null; "
+        "wait; cmp test_0008.ref test_0008.txt && echo SAME; rm -f test_0008.ref test_0008.txt";
+static const char *const expected_output[] = {      // the statistics of oasis_coord, then the cmp
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME" };
+
+    return run_golden("test_0008", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0009(void) {
+    const char *command =
+        "for i in 0 1 2; do prime_oases --shard $i/3 -o test_0009.s$i d691 x1 2000 >test_0009.l$i; done; "
+        "prime_oases -o test_0009.ref d691 x1 2000 >/dev/null; "
+        "oasis_merge -o test_0009.txt test_0009.s2 test_0009.l1 test_0009.s0 test_0009.l2 test_0009.s1 test_0009.l0; "
+        "cmp test_0009.ref test_0009.txt && echo SAME; "
+        "for i in 0 1 2; do prime_oasis --shard $i/3 8 9 2 >test_0009.o$i; done; "
+        "prime_oasis 8 9 2 | grep '^oasis' >test_0009.ref; "
+        "oasis_merge test_0009.o1 test_0009.o0 test_0009.o2 >test_0009.txt; "
+        "tail -1 test_0009.txt; head -n -1 test_0009.txt | cmp test_0009.ref - && echo SAME; "
+        "rm -f test_0009.*";
+static const char *const expected_output[] = {      // prime_oases, then prime_oasis: the summed statistics, the cmp
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "(try=840, hit=222, twin=0)",
+     "SAME" };
+
+    return run_golden("test_0009", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0010(void) {
+    const char *command =
+        "prime_oases -o test_0010.ref d691 x1 2000 >/dev/null; "
+        "prime_oases -j 3 --pipeline -o test_0010.txt d691 x1 2000 | tail -1; "
+        "cmp test_0010.ref test_0010.txt && echo SAME; rm -f test_0010.ref test_0010.txt";
+static const char *const expected_output[] = {      // the statistics of the pipelined scan, then the cmp
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME" };
+
+    return run_golden("test_0010", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0011(void) {
+    const char *command =
+        "prime_oases -o test_0011.ref d691 x1 2000 >/dev/null; "
+        "prime_oases -o test_0011.txt.gz d691 x1 2000 | tail -1; "
+        "gzip -dc test_0011.txt.gz | cmp test_0011.ref - && echo SAME; "
+        "prime_oases d691 x1 2000 | grep '^d691' | cmp test_0011.ref - && echo SAME; "
+        "rm -f test_0011.ref test_0011.txt.gz";
+static const char *const expected_output[] = {      // the statistics, the gzip file, then the stdout
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "SAME" };
+
+    return run_golden("test_0011", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0012(void) {
+    const char *command =
+        "prime_oases -o test_0012.ref d691 x1 2000 >/dev/null; "
+        "prime_oases --no-decimal -o test_0012.k d691 x1 2000 | tail -1; "
+        "oasis_decode test_0012.k | cmp test_0012.ref - && echo SAME; "
+        "prime_oases --no-decimal d691 x1 2000 | oasis_decode - | grep '^d691' | cmp test_0012.ref - && echo SAME; "
+        "rm -f test_0012.ref test_0012.k";
+static const char *const expected_output[] = {      // the statistics, the rendered file, then the pipe
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "SAME" };
+
+    return run_golden("test_0012", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0013(void) {
+    const char *command =
+        "rm -rf test_0013.d; prime_oases -o test_0013.ref d691 x1 3000 >/dev/null; "
+        "prime_oases --cache test_0013.d d691 x1001 1000 >/dev/null; "
+        "prime_oases --cache test_0013.d -o test_0013.txt d691 x1 3000 | tail -1; "
+        "cmp test_0013.ref test_0013.txt && echo SAME; "
+        "prime_oases --cache test_0013.d -o test_0013.txt d691 x1 3000 >/dev/null; "
+        "cmp test_0013.ref test_0013.txt && echo SAME; "
+        "prime_oases d701 x1 4 >test_0013.ref; "
+        "prime_oases --cache test_0013.d d701 x1 4 | cmp test_0013.ref - && echo SAME; "
+        "prime_oases --cache test_0013.d d2 x1 400 >/dev/null; "
+        "prime_oases d3 x1 100 >test_0013.ref; "
+        "prime_oases --cache test_0013.d d3 x1 100 | cmp test_0013.ref - && echo SAME; "
+        "prime_oases d2 x1 400 >test_0013.ref; "
+        "prime_oases --cache test_0013.d d2 x1 400 | cmp test_0013.ref - && echo SAME; "
+        "rm -rf test_0013.d test_0013.ref test_0013.txt";
+static const char *const expected_output[] = {      // the statistics, a scan with gaps, all served, d701 from d691, d3 not from d2, d2 served
+     "{ prime_oases d691 x1 3000: try=6000, hit=99(1.7%) }",
+     "SAME",
+     "SAME",
+     "SAME",
+     "SAME",
+     "SAME" };
+
+    return run_golden("test_0013", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0014(void) {
+    const char *command =
+        "prime_oases -j 2 -o test_0014.txt d683 x484391 484391 | tail -1; cksum <test_0014.txt; "
+        "prime_oases -j 4 -o test_0014.txt d683 x484391 484391 | tail -1; cksum <test_0014.txt; "
+        "rm -f test_0014.txt";
+static const char *const expected_output[] = {      // -j 2, then -j 4 (work stealing): the statistics and the hits of test_0006
+     "{ prime_oases d683 x484391 484391: try=968782, hit=16093(1.7%) }",
+     "3862577402 5214132",
+     "{ prime_oases d683 x484391 484391: try=968782, hit=16093(1.7%) }",
+     "3862577402 5214132" };
+
+    return run_golden("test_0014", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0015(void) {
+    const char *command =
+        "prime_oases -o test_0015.ref d691 x1 2000 >/dev/null; "
+        "prime_oases --prove -o test_0015.txt d691 x1 2000 | tail -1; "
+        "cmp test_0015.ref test_0015.txt && echo SAME; "
+        "prime_oases d23 x1000000000000000 100 | grep '^d23' >test_0015.ref; "
+        "prime_oases --prove d23 x1000000000000000 100 >test_0015.txt; tail -1 test_0015.txt; "
+        "grep -c ' (probable)$' test_0015.txt; "
+        "grep '^d23' test_0015.txt | sed 's/ (probable)$//' | cmp test_0015.ref - && echo SAME; "
+        "rm -f test_0015.ref test_0015.txt";
+static const char *const expected_output[] = {      // d691: all proven; d23 beyond 2^64: d23 too small for half of them
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%), proven=63 }",
+     "SAME",
+     "{ prime_oases d23 x1000000000000000 100: try=200, hit=22(11.0%), proven=11 }",
+     "11",
+     "SAME" };
+
+    return run_golden("test_0015", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0016(void) {
+    const char *command =
+        "prime_oases -o test_0016.ref d691 x1 2000 >/dev/null; "
+        "prime_oases --format=bin -o test_0016.bin d691 x1 2000 | tail -1; "
+        "oasis_decode test_0016.bin | cmp test_0016.ref - && echo SAME; "
+        "prime_oases --prove d23 x1000000000000000 100 | grep '^d23' >test_0016.ref; "
+        "prime_oases --prove --format=bin -o test_0016.bin d23 x1000000000000000 100 >/dev/null; "
+        "oasis_decode test_0016.bin | cmp test_0016.ref - && echo SAME; "
+        "rm -f test_0016.ref test_0016.bin";
+static const char *const expected_output[] = {      // the statistics, the decoded records, then with the (probable) flags
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "SAME" };
+
+    return run_golden("test_0016", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+// liboasis: mpn Montgomery (REDC) の Fermat テストを mpz_powm() と比較する.
+static int fermat_0017(OASIS_FERMAT *fm, mpz_t N, mpz_t e, mpz_t r) {
+    int ret = oasis_fermat(fm, N);
+
+    mpz_sub_ui(e, N, 1);
+    mpz_set_ui(r, 2);
+    mpz_powm(r, r, e, N);                               // 2^(N-1) mod N
+    if (ret != (mpz_cmp_ui(r, 1) == 0)) {
+        XPT(XPT_ERR, "ERR:test_0017: %zu limbs (%zu bits), oasis_fermat() = %d\n", mpz_size(N), mpz_sizeinbase(N, 2), ret);
+        return 1;
+    }
+    return 0;
+}
+
+int test_0017(void) {
+    int ret = 0;
+static const int limbs[] = { 1, 2, 3, 5, 16, 17, 24, 31, 32, 33, 63, 64 };   // inlined 16/24/32/64 and odd counts
+static const char *const fixed[] = {
+     "341",                                             // base-2 Fermat pseudoprime
+     "561",                                             // Carmichael number
+     "18446744073709551557",                            // 2^64-59: the top bit of the only limb
+     "170141183460469231731687303715884105727",         // 2^127-1
+     "340282366920938463463374607431768211297" };       // 2^128-159: the top bit of 2 limbs
+    OASIS_FERMAT fm[1];
+    gmp_randstate_t rs;
+    mpz_t N, q, e, r;
+
+    XPT(XPT_SNP, "SNP:test_0017: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0017: interrupted.\n");
+        return -1;
+    }
+
+    oasis_fermat_init(fm);
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 17);
+    mpz_init(N);
+    mpz_init(q);
+    mpz_init(e);
+    mpz_init(r);
+
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+        mpz_set_str(N, fixed[i], 10);
+        ret |= fermat_0017(fm, N, e, r);
+    }
+    for (size_t i = 0; i < sizeof(limbs) / sizeof(limbs[0]) && !ret; i++) {
+        mp_bitcnt_t bits = (mp_bitcnt_t)limbs[i] * GMP_NUMB_BITS;
+
+        for (int j = 0; j < 4; j++) {
+            switch (j) {
+            case 0:     // random, the top bit set: exponent N-1 starts at the top bit of the top limb
+                mpz_urandomb(N, rs, bits);
+                mpz_setbit(N, bits - 1);
+                mpz_setbit(N, 0);
+                break;
+            case 1:     // prime, the top bit set: must pass
+                mpz_urandomb(N, rs, bits - 1);
+                mpz_setbit(N, bits - 2);
+                mpz_mul_2exp(N, N, 1);
+                mpz_nextprime(N, N);
+                break;
+            case 2:     // top limb = 1
+                mpz_urandomb(N, rs, bits - GMP_NUMB_BITS + 1);
+                mpz_setbit(N, bits - GMP_NUMB_BITS);
+                mpz_setbit(N, 0);
+                break;
+            default:    // p*q: composite
+                mpz_urandomb(q, rs, bits / 2);
+                mpz_setbit(q, bits / 2 - 1);
+                mpz_nextprime(q, q);
+                mpz_nextprime(N, q);
+                mpz_mul(N, N, q);
+                break;
+            }
+            if (mpz_cmp_ui(N, 3) <= 0) continue;
+            ret |= fermat_0017(fm, N, e, r);
+            if (j == 1 && mpz_cmp_ui(r, 1) != 0) ret = 1;
+        }
+    }
+    if (ret) ret = 3;
+
+    mpz_clear(N);
+    mpz_clear(q);
+    mpz_clear(e);
+    mpz_clear(r);
+    gmp_randclear(rs);
+
+    XPT(XPT_SNP, "SNP:test_0017: ret = %d\n", ret);
+    return ret;
+}
+
+// liboasis: Fermat スクリーンの各カーネルを layer1/2/3 の候補で mpz_probab_prime_p() と比較する.
+#define CAND_0018   (61)                                // not a multiple of OASIS_PRP_LANES: padded groups
+
+int test_0018(void) {
+    int ret = 0;
+static const int kernels[] = { OASIS_PRP_SCALAR, OASIS_PRP_IFMA };
+static const struct { int n; unsigned long num; } layers[] = {
+     { 691, 701 },                                      // oasis_layer1: all deserts
+     { 683, 2048 },                                     // oasis_layer2: the first deserts
+     { 677, 2048 } };                                   // oasis_layer3: the first deserts
+    OASIS_PRP pp[1];
+    mpz_t start, step, cand[CAND_0018];
+    int res[CAND_0018];
+    int prp[CAND_0018];
+    int ifma = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+
+    XPT(XPT_SNP, "SNP:test_0018: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0018: interrupted.\n");
+        return -1;
+    }
+
+    mpz_init(start);
+    mpz_init(step);
+    for (int j = 0; j < CAND_0018; j++) {
+        mpz_init(cand[j]);
+    }
+    oasis_lcm_get(start, 701);
+
+    for (size_t l = 0; l < sizeof(layers) / sizeof(layers[0]) && !ret && !interrupted; l++) {
+        unsigned long k = 0;
+
+        oasis_lcm_get(step, layers[l].n);
+        while (k < 2 * layers[l].num && !ret && !interrupted) {
+            int n = 0;
+
+            for (; n < CAND_0018 && k < 2 * layers[l].num; n++, k++) {     // pit-1, pit+1, ...
+                mpz_mul_ui(cand[n], step, k / 2);
+                mpz_add(cand[n], cand[n], start);
+                if (k & 1) mpz_add_ui(cand[n], cand[n], 1); else mpz_sub_ui(cand[n], cand[n], 1);
+                prp[n] = (mpz_probab_prime_p(cand[n], 25) > 0);
+            }
+            for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]) && !ret; i++) {
+                oasis_prp_init(pp, kernels[i]);
+                if ((pp->kernel == OASIS_PRP_IFMA) != (kernels[i] == OASIS_PRP_IFMA && ifma)) {
+                    XPT(XPT_ERR, "ERR:test_0018: kernel %d is %s\n", kernels[i], oasis_prp_name(pp));
+                    ret = 3;
+                }
+                oasis_prp_screen(pp, cand, n, res);
+                for (int j = 0; j < n && !ret; j++) {
+                    if (res[j] != prp[j]) {
+                        XPT(XPT_ERR, "ERR:test_0018: d%d: %s: candidate %lu: %d, mpz_probab_prime_p: %d\n",
+                            layers[l].n, oasis_prp_name(pp), k - n + j, res[j], prp[j]);
+                        ret = 3;
+                    }
+                }
+                oasis_prp_clear(pp);
+            }
+        }
+    }
+    if (!ifma) {
+        XPT(XPT_WRN, "WRN:test_0018: no AVX-512 IFMA, the scalar kernel only\n");
+    }
+
+    for (int j = 0; j < CAND_0018; j++) {
+        mpz_clear(cand[j]);
+    }
+    mpz_clear(start);
+    mpz_clear(step);
+    if (interrupted && !ret) ret = -1;
+
+    XPT(XPT_SNP, "SNP:test_0018: ret = %d\n", ret);
+    return ret;
+}
+
+// liboasis: LCM テーブルの d<n> を mpz_lcm_ui() で順に計算した値と比較する.
+#define NMAX_0019   (1500)                              // beyond d1429 of oasis_divs
+
+int test_0019(void) {
+    int ret = 0;
+static const char *const path = "test_0019.lcm";
+    OASIS_LCM tab[1];
+    uint32_t p[NMAX_0019];
+    int e[NMAX_0019];
+    int cnt;
+    mpz_t lcm, d, t;
+
+    XPT(XPT_SNP, "SNP:test_0019: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0019: interrupted.\n");
+        return -1;
+    }
+
+    if (oasis_lcm_write(path, NMAX_0019) != 0 || oasis_lcm_open(tab, path) != 0) {
+        XPT(XPT_ERR, "ERR:test_0019: %s\n", path);
+        unlink(path);
+        return 1;
+    }
+    mpz_init_set_ui(lcm, 1);
+    mpz_init(d);
+    mpz_init(t);
+
+    for (int n = 1; n <= NMAX_0019 && !ret; n++) {
+        mpz_lcm_ui(lcm, lcm, n);
+        if (oasis_lcm_find(tab, d, n) != 0 || mpz_cmp(d, lcm) != 0) {
+            XPT(XPT_ERR, "ERR:test_0019: oasis_lcm_find(%d)\n", n);
+            ret = 3;
+        }
+        oasis_lcm_get(d, n);                            // $OASIS_LCM or the table of CMake, or computed
+        if (mpz_cmp(d, lcm) != 0) {
+            XPT(XPT_ERR, "ERR:test_0019: oasis_lcm_get(%d)\n", n);
+            ret = 3;
+        }
+    }
+    if (!ret && oasis_lcm_find(tab, d, NMAX_0019 + 1) == 0) {
+        XPT(XPT_ERR, "ERR:test_0019: oasis_lcm_find(%d) beyond the table\n", NMAX_0019 + 1);
+        ret = 3;
+    }
+    cnt = oasis_lcm_factor(NMAX_0019, p, e, NMAX_0019);
+    mpz_set_ui(d, 1);
+    for (int i = 0; i < cnt; i++) {                     // d1500 = product of p^e
+        mpz_ui_pow_ui(t, p[i], e[i]);
+        mpz_mul(d, d, t);
+    }
+    if (!ret && (cnt <= 0 || mpz_cmp(d, lcm) != 0)) {
+        XPT(XPT_ERR, "ERR:test_0019: oasis_lcm_factor(%d) = %d\n", NMAX_0019, cnt);
+        ret = 3;
+    }
+
+    oasis_lcm_close(tab);
+    unlink(path);
+    mpz_clear(lcm);
+    mpz_clear(d);
+    mpz_clear(t);
+
+    XPT(XPT_SNP, "SNP:test_0019: ret = %d\n", ret);
+    return ret;
+}
+
+// liboasis: product tree で作る d<n> を OASIS_LCM_N_MAX より先まで mpz_lcm_ui() と比較する.
+int test_0020(void) {
+    int ret = 0;
+static const struct { uint32_t n; int threads; } builds[] = {
+     { OASIS_LCM_N_MAX + 1,     1 },                    // just beyond the table
+     { 20000,                   1 },
+     { OASIS_LCM_PAR_MIN - 1,   4 },                    // below the threaded size
+     { 70000,                   4 },                    // > OASIS_LCM_PAR_MIN: split over threads
+     { 70000,                   0 } };                  // the number of CPUs
+    OASIS_LCM_FAC fac[1];
+    uint32_t n = 1;
+    mpz_t lcm, d, t;
+
+    XPT(XPT_SNP, "SNP:test_0020: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0020: interrupted.\n");
+        return -1;
+    }
+
+    mpz_init_set_ui(lcm, 1);
+    mpz_init(d);
+    mpz_init(t);
+
+    for (size_t i = 0; i < sizeof(builds) / sizeof(builds[0]) && !ret; i++) {
+        for (; n <= builds[i].n; n++) {
+            mpz_lcm_ui(lcm, lcm, n);
+        }
+        if (oasis_lcm_build(d, builds[i].n, builds[i].threads, fac) != 0 || mpz_cmp(d, lcm) != 0) {
+            XPT(XPT_ERR, "ERR:test_0020: oasis_lcm_build(%u, %d)\n", builds[i].n, builds[i].threads);
+            ret = 3;
+        }
+        mpz_set_ui(d, 1);
+        for (uint32_t j = 0; j < fac->cnt && !ret; j++) {   // p^e <= n < p^(e+1)
+            mpz_ui_pow_ui(t, fac->p[j], fac->e[j]);
+            if (mpz_cmp_ui(t, builds[i].n) > 0 || mpz_cmp_ui(t, builds[i].n / fac->p[j]) <= 0) {
+                XPT(XPT_ERR, "ERR:test_0020: d%u: %u^%u\n", builds[i].n, fac->p[j], fac->e[j]);
+                ret = 3;
+            }
+            mpz_mul(d, d, t);
+        }
+        if (!ret && mpz_cmp(d, lcm) != 0) {
+            XPT(XPT_ERR, "ERR:test_0020: d%u: the product of the factorization\n", builds[i].n);
+            ret = 3;
+        }
+        oasis_lcm_fac_clear(fac);
+    }
+    oasis_lcm_get(d, 20000);                            // beyond the table: built
+    mpz_set_ui(t, 1);
+    for (n = 2; n <= 20000; n++) {
+        mpz_lcm_ui(t, t, n);
+    }
+    if (!ret && mpz_cmp(d, t) != 0) {
+        XPT(XPT_ERR, "ERR:test_0020: oasis_lcm_get(20000)\n");
+        ret = 3;
+    }
+
+    mpz_clear(lcm);
+    mpz_clear(d);
+    mpz_clear(t);
+
+    XPT(XPT_SNP, "SNP:test_0020: ret = %d\n", ret);
+    return ret;
+}
+
+int test_0021(void) {
+    const char *command =
+        "oasis_divs | awk -v RS= -v ORS='\\n\\n' '/\\nlcm\\(1,2,3,\\.\\.\\.(69[0-9]|70[0-9]|710)\\)=/' >test_0021.ref; "
+        "oasis_divs 690 710 | cmp test_0021.ref - && echo SAME; "
+        "oasis_divs -j 3 690 710 | cmp test_0021.ref - && echo SAME; "
+        "oasis_divs 1429 1433 | grep -c '^1433^1=1433$'; "
+        "oasis_divs 2 1 | head -1; "
+        "rm -f test_0021.ref";
+static const char *const expected_output[] = {      // <from> <to> = the blocks of the full run, threaded, beyond 1429, bad range
+     "SAME",
+     "SAME",
+     "1",
+     "ERR: 2 <= <from> <= <to>" };
+
+    return run_golden("test_0021", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0022(void) {
+    const char *command =
+        "oasis_bench -j 1,2 -n 2000 -o test_0022.json layer1 layer2 | awk 'NR > 1 { print $1, $2, $4, $5 }'; "
+        "oasis_bench -j 1 --compare test_0022.json --tolerance 1000 layer1 >/dev/null && echo PASS; "
+        "sed 's/\"cand_per_s\": [0-9.]*/\"cand_per_s\": 99999999.0/' test_0022.json >test_0022.fast; "
+        "oasis_bench -j 1 --compare test_0022.fast layer1 >/dev/null || echo REGRESSION; "
+        "rm -f test_0022.json test_0022.fast";
+static const char *const expected_output[] = {      // the tries and hits of the workloads, then --compare
+     "layer1 1 1402 20",
+     "layer1 2 1402 20",
+     "layer2 1 3999 66",
+     "layer2 2 3999 66",
+     "PASS",
+     "REGRESSION" };
+
+    return run_golden("test_0022", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0023(void) {
+    const char *command =
+        "rm -f test_0023.json; prime_oases -o test_0023.ref d691 x1 2000 >/dev/null; "
+        "prime_oases --progress 1 --status test_0023.json -o test_0023.txt d691 x1 2000 2>test_0023.err | tail -1; "
+        "cmp test_0023.ref test_0023.txt && echo SAME; "
+        "tail -1 test_0023.json | grep -o '\"k_done\": 2000, \"num\": 2000, \"frac\": 1.000000, \"cand\": 4000, \"hit\": 63,'; "
+        "tail -1 test_0023.json | grep -o '\"done\": true'; "
+        "tail -1 test_0023.err | grep -o '100.0% 2000/2000'; "
+        "rm -f test_0023.ref test_0023.txt test_0023.json test_0023.err";
+static const char *const expected_output[] = {      // the hits unchanged, then the last NDJSON record and the last line of stderr
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "\"k_done\": 2000, \"num\": 2000, \"frac\": 1.000000, \"cand\": 4000, \"hit\": 63,",
+     "\"done\": true",
+     "100.0% 2000/2000" };
+
+    return run_golden("test_0023", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0024(void) {
+    const char *command =
+        "rm -f xpt_prf.*.json; prime_oases -o test_0024.ref d691 x1 2000 >/dev/null; "
+        "ls xpt_prf.*.json 2>/dev/null | wc -l; "
+        "XPT_FLG=0x0013 XPT_PRF_FILE=test_0024.json prime_oases -o test_0024.txt d691 x1 2000 | tail -1; "
+        "cmp test_0024.ref test_0024.txt && echo SAME; "
+        "grep -c '\"name\": \"test\", \"cat\": \"oasis\", \"ph\": \"B\"' test_0024.json; "
+        "grep -c '\"name\": \"output\", \"cat\": \"oasis\", \"ph\": \"E\"' test_0024.json; "
+        "[ $(grep -c '\"ph\": \"B\"' test_0024.json) = $(grep -c '\"ph\": \"E\"' test_0024.json) ] && tail -1 test_0024.json; "
+        "rm -f test_0024.ref test_0024.txt test_0024.json";
+static const char *const expected_output[] = {      // no dump without XPT_PRF; the hits unchanged, a test and an output per hit, closed JSON
+     "0",
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "SAME",
+     "63",
+     "63",
+     "]}" };
+
+    return run_golden("test_0024", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0025(void) {
+    const char *command =
+        "prime_oases -o test_0025.ref d691 x1 2000 >/dev/null; "
+        "prime_oases --perf-counters -o test_0025.txt d691 x1 2000 2>test_0025.err | tail -1; cat test_0025.err; "
+        "cmp test_0025.ref test_0025.txt && echo SAME; "
+        "prime_oases --perf-counters -j 2 -o test_0025.txt d691 x1 2000 >/dev/null 2>&1; "
+        "cmp test_0025.ref test_0025.txt && echo SAME; "
+        "rm -f test_0025.ref test_0025.txt test_0025.err";
+static const char *const expected_output[] = {      // the statistics, the phases to stderr ('-' without perf events), the hits unchanged
+     "{ prime_oases d691 x1 2000: try=4000, hit=63(1.6%) }",
+     "per 1M        task_ns         cycles          instr       l1d_miss       llc_miss        br_miss    IPC",
+     "sieve ",
+     "prp ",
+     "out ",
+     "SAME",
+     "SAME" };
+
+    return run_golden("test_0025", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0026(void) {
+    const char *command =
+        "oasis_microbench -w 0 -r 3 -t 1 -o test_0026.json lcm_tree add | awk '{ print $1, $2 }'; "
+        "grep -c '\"median_ns\": [0-9.]*, \"mad_ns\"' test_0026.json; "
+        "oasis_microbench nosuch | head -1; "
+        "rm -f test_0026.json";
+static const char *const expected_output[] = {      // the selected cases in order, their JSON records, an unknown case
+     "case ops/sample",
+     "lcm_tree n=100",
+     "lcm_tree n=400",
+     "lcm_tree n=691",
+     "lcm_tree n=1429",
+     "add bits=512",
+     "add bits=1024",
+     "add bits=2048",
+     "add bits=4096",
+     "8",
+     "ERR: No case 'nosuch'" };
+
+    return run_golden("test_0026", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0027(void) {
+    const char *command =
+        "prime_oases d23 x18446744073709551516 200 >test_0027.txt; tail -1 test_0027.txt; "
+        "grep '^d23' test_0027.txt >test_0027.ref; sed -n '16,17p' test_0027.ref; cksum <test_0027.ref; "
+        "prime_oases -j 2 --no-decimal -o test_0027.k d23 x18446744073709551516 200 >/dev/null; "
+        "oasis_decode test_0027.k | cmp test_0027.ref - && echo SAME; "
+        "rm -f test_0027.txt test_0027.ref test_0027.k";
+static const char *const expected_output[] = {      // k across 2^64: the statistics, the last hit below and the first above, all hits, -j 2 k-form
+     "{ prime_oases d23 x18446744073709551516 200: try=400, hit=37(9.2%) }",
+     "d23*18446744073709551600-1 = 98768089861424529908570207999",
+     "d23*18446744073709551618-1 = 98768089861424530004946327839",
+     "41692720 2183",
+     "SAME" };
+
+    return run_golden("test_0027", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+int test_0028(void) {
+    const char *command =
+        "prime_oases -o test_0028.ref d691 x1 30000 >/dev/null; "
+        "XPT_FLG=0x0007 prime_oases -j 8 -o test_0028.txt d691 x1 30000 2>&1 | grep ' stolen$' | awk '$4 > 0 { print \"STOLEN\" }'; "
+        "cmp test_0028.ref test_0028.txt && echo SAME; "
+        "prime_oases -o test_0028.ref d691 x1 5 >/dev/null; "
+        "prime_oases -j 8 -o test_0028.txt d691 x1 5 | tail -1; "
+        "cmp test_0028.ref test_0028.txt && echo SAME; "
+        "rm -f test_0028.ref test_0028.txt";
+static const char *const expected_output[] = {      // -j 8: chunks stolen, the hits unchanged; fewer deserts than threads
+     "STOLEN",
+     "SAME",
+     "{ prime_oases d691 x1 5: try=10, hit=1(10.0%) }",
+     "SAME" };
+
+    return run_golden("test_0028", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
+// liboasis: N+1 証明 (Morrison) で q=3 の再試行が起きる d691*k-1 を証明し, 全ての候補を mpz_probab_prime_p() と比較する.
+static void lucas_0029(mpz_t v, mpz_t P, mpz_t e, mpz_t N) {  // V_e(P) mod N, Q = 1
+    mpz_t v0, v1;
+
+    mpz_init_set_ui(v0, 2);
+    mpz_init_set(v1, P);
+    for (long b = (long)mpz_sizeinbase(e, 2) - 1; b >= 0; b--) {
+        if (mpz_tstbit(e, b)) {
+            mpz_mul(v0, v0, v1); mpz_sub(v0, v0, P);  mpz_mod(v0, v0, N);
+            mpz_mul(v1, v1, v1); mpz_sub_ui(v1, v1, 2); mpz_mod(v1, v1, N);
+        }
+        else {
+            mpz_mul(v1, v0, v1); mpz_sub(v1, v1, P);  mpz_mod(v1, v1, N);
+            mpz_mul(v0, v0, v0); mpz_sub_ui(v0, v0, 2); mpz_mod(v0, v0, N);
+        }
+    }
+    mpz_set(v, v0);
+    mpz_clear(v0);
+    mpz_clear(v1);
+}
+
+int test_0029(void) {
+    int ret = 0;
+    int retried = 0;
+    OASIS_PROVE pv[1];
+    mpz_t d, N, e, v, P;
+
+    XPT(XPT_SNP, "SNP:test_0029: Start.\n");
+    if (interrupted) {
+        XPT(XPT_WRN, "WRN:test_0029: interrupted.\n");
+        return -1;
+    }
+    if (oasis_prove_init(pv, 691) != 0) {
+        XPT(XPT_ERR, "ERR:test_0029: oasis_prove_init()\n");
+        return 1;
+    }
+    mpz_init(d);
+    mpz_init(N);
+    mpz_init(e);
+    mpz_init(v);
+    mpz_init(P);
+    oasis_lcm_get(d, 691);
+
+    for (unsigned long k = 1; k <= 2000 && !ret; k++) {
+        int prp, res;
+        long p;
+
+        mpz_mul_ui(N, d, k);
+        mpz_sub_ui(N, N, 1);
+        prp = mpz_probab_prime_p(N, 25);
+        res = oasis_prove_m1(pv, N);
+        if ((res > 0) != (prp > 0)) {
+            XPT(XPT_ERR, "ERR:test_0029: d691*%lu-1: oasis_prove_m1() = %d, mpz_probab_prime_p() = %d\n", k, res, prp);
+            ret = 3;
+        }
+        if (prp == 0) continue;
+
+        for (p = 3; mpz_si_kronecker(p * p - 4, N) != -1; p++);    // the first P of oasis_prove_m1()
+        mpz_set_si(P, p);
+        mpz_add_ui(e, N, 1);
+        mpz_divexact_ui(e, e, 3);
+        lucas_0029(v, P, e, N);
+        mpz_mul(v, v, v);
+        mpz_sub_ui(v, v, 4);
+        if (mpz_divisible_p(v, N)) {                    // V_((N+1)/3)^2 - 4 = 0: q = 3 is retried
+            retried++;
+            if (res != OASIS_PRIME) {
+                XPT(XPT_ERR, "ERR:test_0029: d691*%lu-1: retried q = 3, oasis_prove_m1() = %d\n", k, res);
+                ret = 3;
+            }
+        }
+    }
+    if (!ret && retried != 16) {                        // k = 75, 115, 204, ..., 1983
+        XPT(XPT_ERR, "ERR:test_0029: %d primes retried q = 3\n", retried);
+        ret = 3;
+    }
+
+    oasis_prove_clear(pv);
+    mpz_clear(d);
+    mpz_clear(N);
+    mpz_clear(e);
+    mpz_clear(v);
+    mpz_clear(P);
+
+    XPT(XPT_SNP, "SNP:test_0029: ret = %d\n", ret);
+    return ret;
+}
+
+int test_0030(void) {
+    const char *command =
+        "rm -f test_0030.txt; "
+        "oasis_layer1 --checkpoint test_0030.ck >>test_0030.txt; "
+        "oasis_layer1 --resume test_0030.ck >>test_0030.txt; echo ret=$?; "
+        "grep -c '^oasis' test_0030.txt; "
+        "head -c 50 test_0030.txt >test_0030.tmp; cat test_0030.tmp >test_0030.txt; "
+        "oasis_layer1 --resume test_0030.ck >>test_0030.txt 2>test_0030.err; echo ret=$?; cat test_0030.err; "
+        "rm -f test_0030.txt test_0030.ck; "
+        "prime_oases --checkpoint test_0030.ck d691 x1 2000 >>test_0030.txt; "
+        "head -c 300 test_0030.txt >test_0030.tmp; cat test_0030.tmp >test_0030.txt; "
+        "prime_oases --resume test_0030.ck >>test_0030.txt 2>test_0030.err; echo ret=$?; cat test_0030.err; "
+        "rm -f test_0030.txt test_0030.tmp test_0030.err test_0030.ck";
+static const char *const expected_output[] = {      // resumed at the end: the 20 hits once; a shorter stdout stops with -8, prime_oases too
+     "ret=0",
+     "20",
+     "ret=248",
+     "ERR: stdout does not match the checkpoint 'test_0030.ck'",
+     "ret=248",
+     "ERR: stdout does not match the checkpoint 'test_0030.ck'" };
+
+    return run_golden("test_0030", command, expected_output, sizeof(expected_output) / sizeof(expected_output[0]));
+}
+
 typedef struct {
     int number;
     const char *description;
@@ -457,6 +1284,30 @@ Test tests[] = {
     {4, "oasis_divs:top-mid-bot",       test_0004},
     {5, "prime_oasis:top-mid-bot-sta",  test_0005},
     {6, "prime_oases:top-mid-bot-sta",  test_0006},
+    {7, "liboasis:engine",              test_0007},
+    {8, "oasis_coord:workers-crash",    test_0008},
+    {9, "oasis_merge:shards",           test_0009},
+    {10, "prime_oases:pipeline",        test_0010},
+    {11, "prime_oases:gzip",            test_0011},
+    {12, "oasis_decode:no-decimal",     test_0012},
+    {13, "prime_oases:cache",           test_0013},
+    {14, "prime_oases:jobs-golden",     test_0014},
+    {15, "prime_oases:prove",           test_0015},
+    {16, "oasis_decode:bin",            test_0016},
+    {17, "oasis_fermat:redc",           test_0017},
+    {18, "oasis_prp:kernels",           test_0018},
+    {19, "liboasis:lcm-table",          test_0019},
+    {20, "liboasis:lcm-product-tree",   test_0020},
+    {21, "oasis_divs:from-to",          test_0021},
+    {22, "oasis_bench:workloads",       test_0022},
+    {23, "prime_oases:progress-status", test_0023},
+    {24, "xpt:prf-trace",               test_0024},
+    {25, "prime_oases:perf-counters",   test_0025},
+    {26, "oasis_microbench:cases",      test_0026},
+    {27, "prime_oases:k-beyond-2^64",   test_0027},
+    {28, "prime_oases:work-stealing",   test_0028},
+    {29, "oasis_prove:morrison-retry",  test_0029},
+    {30, "oasis_layer1:resume-mismatch", test_0030},
     {0, NULL, NULL}  // 終端マーカー
 };
 #endif